@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cctype>
+
+#include "derlBlockSizePolicy.h"
+
+
+// Class derlBlockSizePolicy
+//////////////////////////////
+
+derlBlockSizePolicy::derlBlockSizePolicy() :
+pMinBlockSize(262144),
+pMaxBlockSize(16777216),
+pTargetBlockCount(64){
+}
+
+derlBlockSizePolicy::~derlBlockSizePolicy(){
+}
+
+
+// Management
+///////////////
+
+void derlBlockSizePolicy::SetMinBlockSize(uint32_t size){
+	pMinBlockSize = std::max(size, (uint32_t)1);
+}
+
+void derlBlockSizePolicy::SetMaxBlockSize(uint32_t size){
+	pMaxBlockSize = std::max(size, (uint32_t)1);
+}
+
+void derlBlockSizePolicy::SetTargetBlockCount(int count){
+	pTargetBlockCount = std::max(count, 1);
+}
+
+uint32_t derlBlockSizePolicy::GetExtensionBlockSize(const std::string &extension) const{
+	const std::unordered_map<std::string, uint32_t>::const_iterator iter(
+		pExtensionBlockSizes.find(pLowerCase(extension)));
+	return iter != pExtensionBlockSizes.cend() ? iter->second : 0;
+}
+
+void derlBlockSizePolicy::SetExtensionBlockSize(const std::string &extension, uint32_t size){
+	if(size > 0){
+		pExtensionBlockSizes[pLowerCase(extension)] = size;
+		
+	}else{
+		pExtensionBlockSizes.erase(pLowerCase(extension));
+	}
+}
+
+uint32_t derlBlockSizePolicy::GetBlockSize(const std::string &path, uint64_t fileSize) const{
+	if(!pExtensionBlockSizes.empty()){
+		const std::unordered_map<std::string, uint32_t>::const_iterator iter(
+			pExtensionBlockSizes.find(GetExtension(path)));
+		if(iter != pExtensionBlockSizes.cend()){
+			return iter->second;
+		}
+	}
+	
+	const uint64_t target = fileSize / (uint64_t)pTargetBlockCount;
+	uint64_t size = 1;
+	while(size < target && size < pMaxBlockSize){
+		size <<= 1;
+	}
+	
+	return (uint32_t)std::min(std::max(size, (uint64_t)pMinBlockSize), (uint64_t)pMaxBlockSize);
+}
+
+std::string derlBlockSizePolicy::GetExtension(const std::string &path){
+	const std::string::size_type slash = path.find_last_of('/');
+	const std::string::size_type dot = path.find_last_of('.');
+	if(dot == std::string::npos || (slash != std::string::npos && dot < slash)){
+		return "";
+	}
+	
+	return pLowerCase(path.substr(dot));
+}
+
+
+
+// Private Functions
+//////////////////////
+
+std::string derlBlockSizePolicy::pLowerCase(const std::string &string){
+	std::string lower(string);
+	std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c){
+		return (char)std::tolower(c);
+	});
+	return lower;
+}
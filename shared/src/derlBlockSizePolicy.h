@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLBLOCKSIZEPOLICY_H_
+#define _DERLBLOCKSIZEPOLICY_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <stdint.h>
+
+
+/**
+ * \brief Block size policy selecting the block size used to hash and transfer a file.
+ * 
+ * Default implementation selects a power of two block size resulting in roughly the
+ * target block count clamped to the minimum and maximum block size. Small files use
+ * finer blocks while huge files use coarser blocks to keep the count of block hashes
+ * and block messages low. Block sizes can be overridden per file extension.
+ * 
+ * File hashes do not depend on the block size if tree hashes are used. Server and
+ * client should still use the same policy. Otherwise block hashes are requested for
+ * files with different hashes to compare them using the server block size.
+ * Policies are shared across task processors. Configure the policy before assigning it.
+ */
+class derlBlockSizePolicy{
+public:
+	/** \brief Reference type. */
+	typedef std::shared_ptr<derlBlockSizePolicy> Ref;
+	
+	
+	
+private:
+	uint32_t pMinBlockSize;
+	uint32_t pMaxBlockSize;
+	int pTargetBlockCount;
+	std::unordered_map<std::string, uint32_t> pExtensionBlockSizes;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create block size policy. */
+	derlBlockSizePolicy();
+	
+	/** \brief Clean up block size policy. */
+	virtual ~derlBlockSizePolicy();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Minimum block size. */
+	inline uint32_t GetMinBlockSize() const{ return pMinBlockSize; }
+	void SetMinBlockSize(uint32_t size);
+	
+	/** \brief Maximum block size. */
+	inline uint32_t GetMaxBlockSize() const{ return pMaxBlockSize; }
+	void SetMaxBlockSize(uint32_t size);
+	
+	/** \brief Target block count per file. */
+	inline int GetTargetBlockCount() const{ return pTargetBlockCount; }
+	void SetTargetBlockCount(int count);
+	
+	/** \brief Block size for extension or 0 if not overridden. */
+	uint32_t GetExtensionBlockSize(const std::string &extension) const;
+	
+	/**
+	 * \brief Set block size for extension or 0 to remove override.
+	 * 
+	 * Extension includes the leading dot, for example ".pak". Case is ignored.
+	 */
+	void SetExtensionBlockSize(const std::string &extension, uint32_t size);
+	
+	/** \brief Block size to use for file. */
+	virtual uint32_t GetBlockSize(const std::string &path, uint64_t fileSize) const;
+	
+	/** \brief Lower case extension of path including the leading dot or empty string. */
+	static std::string GetExtension(const std::string &path);
+	/*@}*/
+	
+	
+	
+private:
+	static std::string pLowerCase(const std::string &string);
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdexcept>
+
+#include "derlDigest.h"
+
+
+// Class derlDigest
+/////////////////////
+
+derlDigest::derlDigest(){
+	memset(pBytes, 0, Size);
+}
+
+derlDigest::derlDigest(const uint8_t *bytes){
+	memcpy(pBytes, bytes, Size);
+}
+
+derlDigest derlDigest::FromHex(const std::string &hex){
+	if(hex.size() != Size * 2){
+		throw std::invalid_argument("hex digest has wrong length");
+	}
+	
+	derlDigest digest;
+	int i;
+	
+	for(i=0; i<Size * 2; i++){
+		const char c = hex[i];
+		uint8_t value;
+		
+		if(c >= '0' && c <= '9'){
+			value = (uint8_t)(c - '0');
+			
+		}else if(c >= 'a' && c <= 'f'){
+			value = (uint8_t)(c - 'a' + 10);
+			
+		}else if(c >= 'A' && c <= 'F'){
+			value = (uint8_t)(c - 'A' + 10);
+			
+		}else{
+			throw std::invalid_argument("hex digest has invalid character");
+		}
+		
+		digest.pBytes[i / 2] |= (i % 2) == 0 ? (uint8_t)(value << 4) : value;
+	}
+	
+	return digest;
+}
+
+
+// Management
+///////////////
+
+std::string derlDigest::ToHex() const{
+	static const char * const digits = "0123456789abcdef";
+	std::string hex(Size * 2, '0');
+	int i;
+	
+	for(i=0; i<Size; i++){
+		hex[i * 2] = digits[pBytes[i] >> 4];
+		hex[i * 2 + 1] = digits[pBytes[i] & 0xf];
+	}
+	
+	return hex;
+}
+
+bool derlDigest::IsZero() const{
+	int i;
+	for(i=0; i<Size; i++){
+		if(pBytes[i] != 0){
+			return false;
+		}
+	}
+	return true;
+}
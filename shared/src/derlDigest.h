@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLDIGEST_H_
+#define _DERLDIGEST_H_
+
+#include <stdint.h>
+#include <string>
+#include <cstring>
+
+
+/**
+ * \brief Fixed size binary hash digest (SHA-256).
+ */
+class derlDigest{
+public:
+	/** \brief Size of digest in bytes. */
+	static const int Size = 32;
+	
+	
+private:
+	uint8_t pBytes[Size];
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create zero digest. */
+	derlDigest();
+	
+	/** \brief Create digest from Size bytes. */
+	explicit derlDigest(const uint8_t *bytes);
+	
+	/**
+	 * \brief Create digest from hex string.
+	 * \throws std::invalid_argument Hex string is malformed.
+	 */
+	static derlDigest FromHex(const std::string &hex);
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Digest bytes. */
+	inline const uint8_t *GetBytes() const{ return pBytes; }
+	inline uint8_t *GetBytes(){ return pBytes; }
+	
+	/** \brief Lower case hex string. */
+	std::string ToHex() const;
+	
+	/** \brief Digest is all zero. */
+	bool IsZero() const;
+	/*@}*/
+	
+	
+	
+	/** \name Operators */
+	/*@{*/
+	inline bool operator==(const derlDigest &digest) const{
+		return memcmp(pBytes, digest.pBytes, Size) == 0;
+	}
+	
+	inline bool operator!=(const derlDigest &digest) const{
+		return memcmp(pBytes, digest.pBytes, Size) != 0;
+	}
+	/*@}*/
+};
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+
+#include "derlFastCdc.h"
+
+
+// Gear table
+///////////////
+
+namespace{
+
+struct sGearTable{
+	uint64_t values[256];
+	
+	sGearTable(){
+		// splitmix64 with fixed seed. both sides have to use the same table
+		uint64_t state = 0x2545f4914f6cdd1dULL;
+		int i;
+		for(i=0; i<256; i++){
+			state += 0x9e3779b97f4a7c15ULL;
+			uint64_t z = state;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			values[i] = z ^ (z >> 31);
+		}
+	}
+};
+
+const sGearTable vGearTable;
+
+}
+
+
+// Class derlFastCdc
+//////////////////////
+
+derlFastCdc::derlFastCdc(uint32_t averageSize){
+	int bits = 8;
+	while(bits < 30 && ((uint64_t)1 << (bits + 1)) <= averageSize){
+		bits++;
+	}
+	
+	pAverageSize = (uint64_t)1 << bits;
+	pMinSize = pAverageSize / 4;
+	pMaxSize = pAverageSize * 8;
+	
+	// gear hash moves content into the high bits. more bits below the average size
+	// and less bits above normalize the chunk size distribution
+	pMaskSmall = ~(uint64_t)0 << (64 - (bits + 2));
+	pMaskLarge = ~(uint64_t)0 << (64 - (bits - 2));
+}
+
+
+// Management
+///////////////
+
+uint64_t derlFastCdc::NextChunk(const void *data, uint64_t size) const{
+	if(size <= pMinSize){
+		return size;
+	}
+	
+	const uint8_t * const bytes = (const uint8_t*)data;
+	const uint64_t end = std::min(size, pMaxSize);
+	const uint64_t normal = std::min(size, pAverageSize);
+	uint64_t hash = 0, i = pMinSize;
+	
+	for(; i<normal; i++){
+		hash = (hash << 1) + vGearTable.values[bytes[i]];
+		if((hash & pMaskSmall) == 0){
+			return i + 1;
+		}
+	}
+	
+	for(; i<end; i++){
+		hash = (hash << 1) + vGearTable.values[bytes[i]];
+		if((hash & pMaskLarge) == 0){
+			return i + 1;
+		}
+	}
+	
+	return end;
+}
@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLFASTCDC_H_
+#define _DERLFASTCDC_H_
+
+#include <stdint.h>
+
+
+/**
+ * \brief Content defined chunking using FastCDC.
+ * 
+ * Chunk boundaries are found using a gear hash over the file content. Inserting or
+ * removing data only changes the chunks touching the modification. Normalized chunking
+ * keeps chunk sizes close to the average size. Chunks are between a quarter and eight
+ * times the average size.
+ */
+class derlFastCdc{
+public:
+	/** \brief Default average chunk size in bytes. */
+	static const uint32_t DefaultAverageSize = 65536;
+	
+	
+	
+private:
+	uint64_t pMinSize;
+	uint64_t pAverageSize;
+	uint64_t pMaxSize;
+	uint64_t pMaskSmall;
+	uint64_t pMaskLarge;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create chunker. Average size is rounded down to a power of two. */
+	derlFastCdc(uint32_t averageSize);
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Minimum chunk size. */
+	inline uint64_t GetMinSize() const{ return pMinSize; }
+	
+	/** \brief Average chunk size. */
+	inline uint64_t GetAverageSize() const{ return pAverageSize; }
+	
+	/** \brief Maximum chunk size. */
+	inline uint64_t GetMaxSize() const{ return pMaxSize; }
+	
+	/**
+	 * \brief Size of chunk starting at data.
+	 * 
+	 * Size is the count of bytes available. Has to be at least the maximum chunk size
+	 * unless the end of the file is reached.
+	 */
+	uint64_t NextChunk(const void *data, uint64_t size) const;
+	/*@}*/
+};
+
+#endif
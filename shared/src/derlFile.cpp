@@ -35,7 +35,9 @@ derlFile::derlFile(const std::string &path) :
 pPath(path),
 pSize(0),
 pHasBlocks(false),
-pBlockSize(0){
+pBlockSize(0),
+pContentChunks(false),
+pHasWeakHashes(false){
 }
 
 derlFile::derlFile(const derlFile &file) :
@@ -44,7 +46,9 @@ pSize(file.pSize),
 pHash(file.pHash),
 pBlocks(file.pBlocks),
 pHasBlocks(file.pHasBlocks),
-pBlockSize(file.pBlockSize){
+pBlockSize(file.pBlockSize),
+pContentChunks(file.pContentChunks),
+pHasWeakHashes(file.pHasWeakHashes){
 }
 
 derlFile::~derlFile() noexcept{
@@ -58,7 +62,7 @@ void derlFile::SetSize(uint64_t size){
 	pSize = size;
 }
 
-void derlFile::SetHash(const std::string &hash){
+void derlFile::SetHash(const derlDigest &hash){
 	pHash = hash;
 }
 
@@ -101,10 +105,12 @@ void derlFile::RemoveBlock(const derlFileBlock::Ref &block){
 
 void derlFile::RemoveAllBlocks(){
 	pBlocks.clear();
+	pHasWeakHashes = false;
 }
 
 void derlFile::SetBlocks(const derlFileBlock::List &blocks){
 	pBlocks = blocks;
+	pHasWeakHashes = false;
 }
 
 derlFileBlock::List::const_iterator derlFile::GetBlocksBegin() const{
@@ -119,6 +125,14 @@ void derlFile::SetBlockSize(uint32_t size){
 	pBlockSize = size;
 }
 
+void derlFile::SetContentChunks(bool contentChunks){
+	pContentChunks = contentChunks;
+}
+
+void derlFile::SetHasWeakHashes(bool hasWeakHashes){
+	pHasWeakHashes = hasWeakHashes;
+}
+
 
 // Private Functions
 //////////////////////
@@ -52,11 +52,13 @@ public:
 private:
 	const std::string pPath;
 	uint64_t pSize;
-	std::string pHash;
+	derlDigest pHash;
 	
 	derlFileBlock::List pBlocks;
 	bool pHasBlocks;
 	uint32_t pBlockSize;
+	bool pContentChunks;
+	bool pHasWeakHashes;
 	
 	
 public:
@@ -84,8 +86,8 @@ public:
 	void SetSize(uint64_t size);
 	
 	/** \brief Hash (SHA-256). */
-	inline const std::string &GetHash() const{ return pHash; }
-	void SetHash(const std::string &hash);
+	inline const derlDigest &GetHash() const{ return pHash; }
+	void SetHash(const derlDigest &hash);
 	
 	
 	/** \brief Has blocks. */
@@ -122,6 +124,22 @@ public:
 	
 	/** Set size of block sin bytes. */
 	void SetBlockSize(uint32_t size);
+	
+	/**
+	 * \brief Blocks are content defined chunks.
+	 * 
+	 * Chunks have variable size and block size is the average chunk size. See derlFastCdc.
+	 */
+	inline bool GetContentChunks() const{ return pContentChunks; }
+	void SetContentChunks(bool contentChunks);
+	
+	/**
+	 * \brief Blocks carry weak rolling checksums.
+	 * 
+	 * Cleared if blocks are set or removed.
+	 */
+	inline bool GetHasWeakHashes() const{ return pHasWeakHashes; }
+	void SetHasWeakHashes(bool hasWeakHashes);
 	/*@}*/
 	
 	
@@ -30,19 +30,25 @@
 
 derlFileBlock::derlFileBlock(uint64_t offset, uint64_t size) :
 pOffset(offset),
-pSize(size){
+pSize(size),
+pWeakHash(0){
 }
 
 derlFileBlock::derlFileBlock(const derlFileBlock &block) :
 pOffset(block.pOffset),
 pSize(block.pSize),
-pHash(block.pHash){
+pHash(block.pHash),
+pWeakHash(block.pWeakHash){
 }
 
 
 // Management
 ///////////////
 
-void derlFileBlock::SetHash(const std::string &hash){
+void derlFileBlock::SetHash(const derlDigest &hash){
 	pHash = hash;
 }
+
+void derlFileBlock::SetWeakHash(uint32_t hash){
+	pWeakHash = hash;
+}
@@ -30,6 +30,8 @@
 #include <memory>
 #include <vector>
 
+#include "derlDigest.h"
+
 
 /**
  * \brief File block.
@@ -46,7 +48,8 @@ public:
 private:
 	const uint64_t pOffset;
 	const uint64_t pSize;
-	std::string pHash;
+	derlDigest pHash;
+	uint32_t pWeakHash;
 	
 	
 	
@@ -71,8 +74,12 @@ public:
 	inline uint64_t GetSize() const{ return pSize; }
 	
 	/** \brief Hash (SHA-256). */
-	inline const std::string &GetHash() const{ return pHash; }
-	void SetHash(const std::string &hash);
+	inline const derlDigest &GetHash() const{ return pHash; }
+	void SetHash(const derlDigest &hash);
+	
+	/** \brief Weak rolling checksum (see derlRollingChecksum). */
+	inline uint32_t GetWeakHash() const{ return pWeakHash; }
+	void SetWeakHash(uint32_t hash);
 	/*@}*/
 	
 	
@@ -22,6 +22,7 @@
  * SOFTWARE.
  */
 
+#include <random>
 #include <stdexcept>
 
 #include "derlFileLayout.h"
@@ -30,7 +31,16 @@
 // Class derlFileLayout
 /////////////////////////
 
-derlFileLayout::derlFileLayout(){
+derlFileLayout::derlFileLayout() :
+pIdentifier(0),
+pGeneration(0),
+pTrackChanges(false),
+pChangesGeneration(0)
+{
+	std::random_device random;
+	while(pIdentifier == 0){
+		pIdentifier = ((uint64_t)random() << 32) | (uint64_t)random();
+	}
 }
 
 derlFileLayout::~derlFileLayout() noexcept{
@@ -62,7 +72,9 @@ derlFile::Ref derlFileLayout::GetFileAtSync(const std::string &path){
 }
 
 void derlFileLayout::SetFileAt(const std::string &path, const derlFile::Ref &file){
-	pFiles[path] = file;
+	derlFile::Ref &entry = pFiles[path];
+	pFileChanged(path, entry.get(), *file);
+	entry = file;
 }
 
 void derlFileLayout::SetFileAtSync(const std::string &path, const derlFile::Ref &file){
@@ -80,7 +92,9 @@ derlFileLayout::ListPath derlFileLayout::GetAllPath() const{
 }
 
 void derlFileLayout::AddFile(const derlFile::Ref &file){
-	pFiles[file->GetPath()] = file;
+	derlFile::Ref &entry = pFiles[file->GetPath()];
+	pFileChanged(file->GetPath(), entry.get(), *file);
+	entry = file;
 }
 
 void derlFileLayout::RemoveFile(const std::string &path){
@@ -89,6 +103,7 @@ void derlFileLayout::RemoveFile(const std::string &path){
 		throw std::runtime_error("file absent");
 	}
 	pFiles.erase(iter);
+	pFileChanged(path);
 }
 
 void derlFileLayout::AddFileSync(const derlFile::Ref &file){
@@ -100,6 +115,7 @@ void derlFileLayout::RemoveFileIfPresent(const std::string &path){
 	derlFile::Map::iterator iter(pFiles.find(path));
 	if(iter != pFiles.end()){
 		pFiles.erase(iter);
+		pFileChanged(path);
 	}
 }
 
@@ -109,5 +125,89 @@ void derlFileLayout::RemoveFileIfPresentSync(const std::string &path){
 }
 
 void derlFileLayout::RemoveAllFiles(){
+	derlFile::Map::const_iterator iter;
+	for(iter = pFiles.cbegin(); iter != pFiles.cend(); iter++){
+		pFileChanged(iter->first);
+	}
 	pFiles.clear();
 }
+
+void derlFileLayout::RemoveAllFilesIn(const std::string &pathDir){
+	const std::string prefix(pathDir + "/");
+	derlFile::Map::iterator iter(pFiles.begin());
+	while(iter != pFiles.end()){
+		if(iter->first.compare(0, prefix.size(), prefix) == 0){
+			pFileChanged(iter->first);
+			iter = pFiles.erase(iter);
+			
+		}else{
+			iter++;
+		}
+	}
+}
+
+void derlFileLayout::RemoveAllFilesInSync(const std::string &pathDir){
+	const std::lock_guard guard(pMutex);
+	RemoveAllFilesIn(pathDir);
+}
+
+
+
+// Generations
+////////////////
+
+void derlFileLayout::SetIdentifier(uint64_t identifier){
+	pIdentifier = identifier;
+}
+
+void derlFileLayout::SetGeneration(uint64_t generation){
+	pGeneration = generation;
+}
+
+void derlFileLayout::StartTrackChanges(){
+	pTrackChanges = true;
+	pChangesGeneration = pGeneration;
+	pChanges.clear();
+}
+
+bool derlFileLayout::CanGetChangesSince(uint64_t generation) const{
+	return pTrackChanges && generation >= pChangesGeneration && generation <= pGeneration;
+}
+
+void derlFileLayout::GetChangesSince(uint64_t generation,
+derlFile::List &changed, ListPath &removed) const{
+	std::unordered_map<std::string, uint64_t>::const_iterator iter;
+	for(iter = pChanges.cbegin(); iter != pChanges.cend(); iter++){
+		if(iter->second <= generation){
+			continue;
+		}
+		
+		const derlFile::Ref file(GetFileAt(iter->first));
+		if(file){
+			changed.push_back(file);
+			
+		}else{
+			removed.push_back(iter->first);
+		}
+	}
+}
+
+
+// Private Functions
+//////////////////////
+
+void derlFileLayout::pFileChanged(const std::string &path){
+	pGeneration++;
+	if(pTrackChanges){
+		pChanges[path] = pGeneration;
+	}
+}
+
+void derlFileLayout::pFileChanged(const std::string &path,
+const derlFile *oldFile, const derlFile &newFile){
+	// replacing a file to update block hashes is not a change of the file layout
+	if(oldFile && oldFile->GetSize() == newFile.GetSize() && oldFile->GetHash() == newFile.GetHash()){
+		return;
+	}
+	pFileChanged(path);
+}
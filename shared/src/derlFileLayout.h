@@ -27,6 +27,7 @@
 
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 #include "derlFile.h"
 
@@ -47,6 +48,12 @@ private:
 	derlFile::Map pFiles;
 	std::mutex pMutex;
 	
+	uint64_t pIdentifier;
+	uint64_t pGeneration;
+	bool pTrackChanges;
+	uint64_t pChangesGeneration;
+	std::unordered_map<std::string, uint64_t> pChanges;
+	
 	
 public:
 	/** \name Constructors and Destructors */
@@ -104,13 +111,61 @@ public:
 	/** \brief Remove all files. */
 	void RemoveAllFiles();
 	
+	/** \brief Remove all files inside directory. */
+	void RemoveAllFilesIn(const std::string &pathDir);
+	
+	/** \brief Remove all files inside directory while locking mutex. */
+	void RemoveAllFilesInSync(const std::string &pathDir);
+	
 	/** \brief Mutex */
 	inline std::mutex &GetMutex(){ return pMutex; }
 	/*@}*/
 	
 	
 	
+	/** \name Generations */
+	/*@{*/
+	/**
+	 * \brief Identifier of file layout.
+	 * 
+	 * Randomly assigned during construction. Generations are only comparable between
+	 * file layouts with the same identifier.
+	 */
+	inline uint64_t GetIdentifier() const{ return pIdentifier; }
+	
+	/** \brief Set identifier of file layout. */
+	void SetIdentifier(uint64_t identifier);
+	
+	/** \brief Generation increased each time a file path, size or hash changes. */
+	inline uint64_t GetGeneration() const{ return pGeneration; }
+	
+	/** \brief Set generation. */
+	void SetGeneration(uint64_t generation);
+	
+	/**
+	 * \brief Start tracking changes from the current generation on.
+	 * 
+	 * Call once the file layout is build. Changes made before are not tracked.
+	 */
+	void StartTrackChanges();
+	
+	/** \brief Changes since generation are tracked. */
+	bool CanGetChangesSince(uint64_t generation) const;
+	
+	/**
+	 * \brief Get changes since generation.
+	 * 
+	 * Changed contains files added or modified since generation. Removed contains path
+	 * of files removed since generation. Call CanGetChangesSince() first.
+	 */
+	void GetChangesSince(uint64_t generation, derlFile::List &changed, ListPath &removed) const;
+	/*@}*/
+	
+	
+	
 private:
+	void pFileChanged(const std::string &path);
+	void pFileChanged(const std::string &path, const derlFile *oldFile, const derlFile &newFile);
 };
 
 #endif
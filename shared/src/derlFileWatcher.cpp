@@ -0,0 +1,183 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+#include "derlFileWatcher.h"
+#include "config.h"
+
+#ifdef OS_UNIX
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+
+#ifdef OS_UNIX
+namespace{
+
+const uint32_t vWatchMask = IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_DELETE
+	| IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+}
+#endif
+
+
+// Class derlFileWatcher
+//////////////////////////
+
+derlFileWatcher::derlFileWatcher(const std::filesystem::path &baseDir) :
+pBaseDir(baseDir),
+pFileDescriptor(-1)
+{
+#ifdef OS_UNIX
+	pFileDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(pFileDescriptor == -1){
+		throw std::runtime_error(std::strerror(errno));
+	}
+	
+	try{
+		pAddWatches("");
+		
+	}catch(...){
+		close(pFileDescriptor);
+		throw;
+	}
+#else
+	throw std::runtime_error("file watching not supported");
+#endif
+}
+
+derlFileWatcher::~derlFileWatcher() noexcept{
+#ifdef OS_UNIX
+	if(pFileDescriptor != -1){
+		close(pFileDescriptor);
+	}
+#endif
+}
+
+
+// Management
+///////////////
+
+bool derlFileWatcher::IsSupported(){
+#ifdef OS_UNIX
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool derlFileWatcher::Poll(SetPath &paths){
+	bool valid = true;
+	
+#ifdef OS_UNIX
+	alignas(inotify_event) char buffer[4096];
+	
+	while(true){
+		const ssize_t length = read(pFileDescriptor, buffer, sizeof(buffer));
+		if(length <= 0){
+			break; // no more events pending
+		}
+		
+		ssize_t offset = 0;
+		while(offset < length){
+			const inotify_event &event = *(const inotify_event*)(buffer + offset);
+			offset += sizeof(inotify_event) + event.len;
+			
+			if((event.mask & IN_Q_OVERFLOW) == IN_Q_OVERFLOW){
+				valid = false;
+				continue;
+			}
+			
+			const std::unordered_map<int, std::string>::iterator iter(pWatches.find(event.wd));
+			if(iter == pWatches.end()){
+				continue;
+			}
+			
+			if((event.mask & IN_IGNORED) == IN_IGNORED){
+				pWatches.erase(iter);
+				continue;
+			}
+			
+			// copy path since adding watches can modify the map
+			const std::string pathDir(iter->second);
+			
+			if(event.len == 0){
+				// event concerns the watched directory itself. the parent directory reports
+				// the matching change except for the base directory
+				if(pathDir.empty() && (event.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) != 0){
+					valid = false;
+				}
+				continue;
+			}
+			
+			const std::string path(pathDir.empty() ? std::string(event.name) : pathDir + "/" + event.name);
+			
+			if((event.mask & IN_ISDIR) == IN_ISDIR && (event.mask & (IN_CREATE | IN_MOVED_TO)) != 0){
+				pAddWatches(path);
+			}
+			
+			paths.insert(path);
+		}
+	}
+#endif
+	
+	return valid;
+}
+
+
+// Private Functions
+//////////////////////
+
+void derlFileWatcher::pAddWatches(const std::string &pathDir){
+#ifdef OS_UNIX
+	const std::filesystem::path fullPath(pathDir.empty() ? pBaseDir : pBaseDir / pathDir);
+	
+	const int watch = inotify_add_watch(pFileDescriptor, fullPath.c_str(), vWatchMask);
+	if(watch == -1){
+		if(pathDir.empty()){
+			throw std::runtime_error(std::strerror(errno));
+		}
+		return; // directory removed in the meantime
+	}
+	
+	pWatches[watch] = pathDir;
+	
+	std::error_code ec;
+	std::filesystem::directory_iterator iter(fullPath, ec);
+	if(ec){
+		return;
+	}
+	
+	for(const std::filesystem::directory_entry &entry : iter){
+		if(entry.is_directory(ec)){
+			const std::string filename(entry.path().filename().generic_string());
+			pAddWatches(pathDir.empty() ? filename : pathDir + "/" + filename);
+		}
+	}
+#endif
+}
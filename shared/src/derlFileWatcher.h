@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLFILEWATCHER_H_
+#define _DERLFILEWATCHER_H_
+
+#include <set>
+#include <memory>
+#include <string>
+#include <filesystem>
+#include <unordered_map>
+
+
+/**
+ * \brief Watch directory tree for file changes.
+ * 
+ * Reports paths relative to the base directory which have been created, modified, deleted
+ * or moved since the last call to Poll(). Directories created or moved into the tree are
+ * watched automatically. Events are polled without blocking.
+ * 
+ * Uses inotify on Linux and Android. On other platforms IsSupported() returns false.
+ */
+class derlFileWatcher{
+public:
+	/** \brief Reference type. */
+	typedef std::unique_ptr<derlFileWatcher> Ref;
+	
+	/** \brief Path set. */
+	typedef std::set<std::string> SetPath;
+	
+	
+private:
+	const std::filesystem::path pBaseDir;
+	int pFileDescriptor;
+	std::unordered_map<int, std::string> pWatches;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/**
+	 * \brief Create file watcher watching directory tree.
+	 * \throws std::runtime_error Watching directory tree failed or is not supported.
+	 */
+	derlFileWatcher(const std::filesystem::path &baseDir);
+	
+	/** \brief Clean up file watcher. */
+	~derlFileWatcher() noexcept;
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief File watching is supported on this platform. */
+	static bool IsSupported();
+	
+	/** \brief Base directory. */
+	inline const std::filesystem::path &GetBaseDirectory() const{ return pBaseDir; }
+	
+	/**
+	 * \brief Add changed paths since the last call.
+	 * 
+	 * Paths can refer to files or directories. Directory paths stand for all files
+	 * inside the directory.
+	 * 
+	 * \returns false if events have been lost and the entire directory tree has to be
+	 *          scanned again.
+	 */
+	bool Poll(SetPath &paths);
+	/*@}*/
+	
+	
+	
+private:
+	void pAddWatches(const std::string &pathDir);
+};
+
+#endif
@@ -0,0 +1,263 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "derlHashCache.h"
+#include "derlFileLayout.h"
+
+
+// Cache file format. All values are little endian:
+// - char[6] signature "DERLHC"
+// - uint8 version
+// - uint32 entry count
+// - entries:
+//   - uint16 path length, path bytes
+//   - uint64 size, int64 modification time, uint64 inode
+//   - uint8 algorithm, uint8 flags (0x1 hash tree), uint32 block size
+//   - uint32 block count
+//   - file hash and block hashes using the digest size of the algorithm
+
+namespace{
+
+const char vSignature[] = {'D', 'E', 'R', 'L', 'H', 'C'};
+// version 2 uses tree hashes over fixed size leaves
+const uint8_t vVersion = 2;
+
+class cWriter{
+public:
+	std::string data;
+	
+	void WriteBytes(const void *bytes, size_t size){
+		data.append((const char*)bytes, size);
+	}
+	
+	void WriteUInt(uint64_t value, int size){
+		int i;
+		for(i=0; i<size; i++){
+			data.push_back((char)(uint8_t)(value >> (8 * i)));
+		}
+	}
+};
+
+class cReader{
+public:
+	const std::string &data;
+	size_t position;
+	
+	cReader(const std::string &adata) : data(adata), position(0){
+	}
+	
+	const uint8_t *ReadBytes(size_t size){
+		if(size > data.size() - position){
+			throw std::runtime_error("unexpected end of file");
+		}
+		const uint8_t * const bytes = (const uint8_t*)data.c_str() + position;
+		position += size;
+		return bytes;
+	}
+	
+	uint64_t ReadUInt(int size){
+		const uint8_t * const bytes = ReadBytes(size);
+		uint64_t value = 0;
+		int i;
+		for(i=0; i<size; i++){
+			value |= (uint64_t)bytes[i] << (8 * i);
+		}
+		return value;
+	}
+};
+
+}
+
+
+// Class derlHashCache
+////////////////////////
+
+derlHashCache::derlHashCache(const std::filesystem::path &path) :
+pPath(path.lexically_normal()),
+pLoaded(false),
+pChanged(false){
+}
+
+
+// Management
+///////////////
+
+bool derlHashCache::Get(const std::string &path, Entry &entry){
+	const std::lock_guard guard(pMutex);
+	pLoad();
+	
+	const std::unordered_map<std::string, Entry>::const_iterator iter(pEntries.find(path));
+	if(iter == pEntries.cend()){
+		return false;
+	}
+	
+	entry = iter->second;
+	return true;
+}
+
+void derlHashCache::Set(const std::string &path, const Entry &entry){
+	const std::lock_guard guard(pMutex);
+	pLoad();
+	pEntries[path] = entry;
+	pChanged = true;
+}
+
+void derlHashCache::Retain(const derlFileLayout &layout){
+	const std::lock_guard guard(pMutex);
+	pLoad();
+	
+	std::unordered_map<std::string, Entry>::iterator iter(pEntries.begin());
+	while(iter != pEntries.end()){
+		if(layout.GetFileAt(iter->first)){
+			iter++;
+			
+		}else{
+			iter = pEntries.erase(iter);
+			pChanged = true;
+		}
+	}
+}
+
+void derlHashCache::Save(){
+	const std::lock_guard guard(pMutex);
+	if(!pChanged){
+		return;
+	}
+	
+	cWriter writer;
+	writer.WriteBytes(vSignature, sizeof(vSignature));
+	writer.WriteUInt(vVersion, 1);
+	writer.WriteUInt(pEntries.size(), 4);
+	
+	for(const std::pair<const std::string, Entry> &each : pEntries){
+		const Entry &entry = each.second;
+		const int digestSize = derlHasher::DigestSize(entry.algorithm);
+		
+		writer.WriteUInt(each.first.size(), 2);
+		writer.WriteBytes(each.first.c_str(), each.first.size());
+		writer.WriteUInt(entry.size, 8);
+		writer.WriteUInt((uint64_t)entry.modificationTime, 8);
+		writer.WriteUInt(entry.inode, 8);
+		writer.WriteUInt((uint8_t)entry.algorithm, 1);
+		writer.WriteUInt(entry.hashTree ? 0x1 : 0x0, 1);
+		writer.WriteUInt(entry.blockSize, 4);
+		writer.WriteUInt(entry.blockHashes.size(), 4);
+		writer.WriteBytes(entry.hash.GetBytes(), digestSize);
+		for(const derlDigest &hash : entry.blockHashes){
+			writer.WriteBytes(hash.GetBytes(), digestSize);
+		}
+	}
+	
+	// write to temporary file first then replace cache file. this avoids leaving behind
+	// a truncated cache file if the application is terminated while saving
+	std::filesystem::path pathTemp(pPath);
+	pathTemp += ".tmp";
+	
+	if(pPath.has_parent_path()){
+		std::filesystem::create_directories(pPath.parent_path());
+	}
+	
+	{
+	std::ofstream stream(pathTemp, std::ios_base::binary | std::ios_base::trunc);
+	stream.write(writer.data.c_str(), writer.data.size());
+	stream.close();
+	if(stream.fail()){
+		throw std::runtime_error("failed writing hash cache file");
+	}
+	}
+	
+	std::filesystem::rename(pathTemp, pPath);
+	pChanged = false;
+}
+
+
+// Private Functions
+//////////////////////
+
+void derlHashCache::pLoad(){
+	if(pLoaded){
+		return;
+	}
+	pLoaded = true;
+	
+	std::ifstream stream(pPath, std::ios_base::binary);
+	if(!stream.is_open()){
+		return;
+	}
+	
+	const std::string data{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+	stream.close();
+	
+	try{
+		cReader reader(data);
+		if(memcmp(reader.ReadBytes(sizeof(vSignature)), vSignature, sizeof(vSignature)) != 0
+		|| reader.ReadUInt(1) != vVersion){
+			return;
+		}
+		
+		const uint32_t count = (uint32_t)reader.ReadUInt(4);
+		uint32_t i, j;
+		
+		for(i=0; i<count; i++){
+			const size_t pathLength = (size_t)reader.ReadUInt(2);
+			const std::string path((const char*)reader.ReadBytes(pathLength), pathLength);
+			
+			Entry entry;
+			entry.size = reader.ReadUInt(8);
+			entry.modificationTime = (int64_t)reader.ReadUInt(8);
+			entry.inode = reader.ReadUInt(8);
+			
+			const uint8_t algorithm = (uint8_t)reader.ReadUInt(1);
+			if(algorithm > (uint8_t)derlHasher::Algorithm::xxh3){
+				throw std::runtime_error("invalid algorithm");
+			}
+			entry.algorithm = (derlHasher::Algorithm)algorithm;
+			entry.hashTree = (reader.ReadUInt(1) & 0x1) == 0x1;
+			entry.blockSize = (uint32_t)reader.ReadUInt(4);
+			
+			const uint32_t blockCount = (uint32_t)reader.ReadUInt(4);
+			const int digestSize = derlHasher::DigestSize(entry.algorithm);
+			uint8_t bytes[derlDigest::Size] = {};
+			
+			memcpy(bytes, reader.ReadBytes(digestSize), digestSize);
+			entry.hash = derlDigest(bytes);
+			
+			for(j=0; j<blockCount; j++){
+				memcpy(bytes, reader.ReadBytes(digestSize), digestSize);
+				entry.blockHashes.push_back(derlDigest(bytes));
+			}
+			
+			pEntries[path] = entry;
+		}
+		
+	}catch(const std::exception &){
+		// damaged cache file. start with empty cache
+		pEntries.clear();
+	}
+}
@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLHASHCACHE_H_
+#define _DERLHASHCACHE_H_
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <filesystem>
+#include <unordered_map>
+
+#include "derlDigest.h"
+#include "derlHasher.h"
+
+class derlFileLayout;
+
+
+/**
+ * \brief Persistent file hash cache.
+ * 
+ * Stores file and block digests calculated while building file layouts together with the
+ * file stat information present at the time. While size, modification time and inode of
+ * a file are unchanged the cached digests are reused instead of reading the file again.
+ * 
+ * The cache is loaded lazily from a compact binary file the first time it is accessed and
+ * written back by Save(). A missing, outdated or damaged cache file results in an empty
+ * cache. Instances are thread safe and can be shared across task processors.
+ */
+class derlHashCache{
+public:
+	/** \brief Reference type. */
+	typedef std::shared_ptr<derlHashCache> Ref;
+	
+	/** \brief Cache entry. */
+	struct Entry{
+		/** \brief File size in bytes. */
+		uint64_t size;
+		
+		/** \brief File modification time in nanoseconds. */
+		int64_t modificationTime;
+		
+		/** \brief File inode or 0 if not supported. */
+		uint64_t inode;
+		
+		/** \brief Hash algorithm used for digests. */
+		derlHasher::Algorithm algorithm;
+		
+		/** \brief File hash is calculated from block hashes. */
+		bool hashTree;
+		
+		/** \brief Block size. */
+		uint32_t blockSize;
+		
+		/** \brief File hash. */
+		derlDigest hash;
+		
+		/** \brief Block hashes in file order. */
+		std::vector<derlDigest> blockHashes;
+	};
+	
+	
+private:
+	const std::filesystem::path pPath;
+	std::unordered_map<std::string, Entry> pEntries;
+	bool pLoaded;
+	bool pChanged;
+	std::mutex pMutex;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create hash cache stored in file at path. */
+	derlHashCache(const std::filesystem::path &path);
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Path of cache file. */
+	inline const std::filesystem::path &GetPath() const{ return pPath; }
+	
+	/** \brief Get entry for file path if present. */
+	bool Get(const std::string &path, Entry &entry);
+	
+	/** \brief Set entry for file path. */
+	void Set(const std::string &path, const Entry &entry);
+	
+	/** \brief Remove entries of files not present in layout. */
+	void Retain(const derlFileLayout &layout);
+	
+	/**
+	 * \brief Write cache file if entries changed since loading or last saving.
+	 * \throws std::runtime_error Writing cache file failed.
+	 */
+	void Save();
+	/*@}*/
+	
+	
+	
+private:
+	void pLoad();
+};
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "derlHasher.h"
+#include "derlProtocol.h"
+
+#include <denetwork/message/denMessageReader.h>
+#include <denetwork/message/denMessageWriter.h>
+
+
+// Class derlHasher
+/////////////////////
+
+derlHasher::derlHasher(Algorithm algorithm) :
+pAlgorithm(algorithm){
+}
+
+
+// Management
+///////////////
+
+void derlHasher::Add(const void *data, uint64_t size){
+	switch(pAlgorithm){
+	case Algorithm::sha256:
+		pSha256.add(data, (size_t)size);
+		break;
+		
+	case Algorithm::xxh3:
+		pXxh3.add(data, (size_t)size);
+		break;
+	}
+}
+
+derlDigest derlHasher::GetDigest(){
+	derlDigest digest;
+	
+	switch(pAlgorithm){
+	case Algorithm::sha256:
+		pSha256.getHash(digest.GetBytes());
+		break;
+		
+	case Algorithm::xxh3:
+		pXxh3.getHash(digest.GetBytes());
+		break;
+	}
+	
+	return digest;
+}
+
+void derlHasher::Reset(){
+	switch(pAlgorithm){
+	case Algorithm::sha256:
+		pSha256.reset();
+		break;
+		
+	case Algorithm::xxh3:
+		pXxh3.reset();
+		break;
+	}
+}
+
+int derlHasher::DigestSize(Algorithm algorithm){
+	switch(algorithm){
+	case Algorithm::xxh3:
+		return XXH3_128::HashBytes;
+		
+	case Algorithm::sha256:
+	default:
+		return SHA256::HashBytes;
+	}
+}
+
+void derlHasher::WriteDigest(denMessageWriter &writer, const derlDigest &digest,
+Algorithm algorithm, uint32_t enabledFeatures){
+	if((enabledFeatures & (uint32_t)derlProtocol::Features::binaryDigest) != 0){
+		writer.Write(digest.GetBytes(), DigestSize(algorithm));
+		
+	}else{
+		writer.WriteString8(digest.ToHex());
+	}
+}
+
+derlDigest derlHasher::ReadDigest(denMessageReader &reader, Algorithm algorithm,
+uint32_t enabledFeatures){
+	if((enabledFeatures & (uint32_t)derlProtocol::Features::binaryDigest) != 0){
+		derlDigest digest;
+		reader.Read(digest.GetBytes(), DigestSize(algorithm));
+		return digest;
+		
+	}else{
+		return derlDigest::FromHex(reader.ReadString8());
+	}
+}
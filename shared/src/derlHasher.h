@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLHASHER_H_
+#define _DERLHASHER_H_
+
+#include <stdint.h>
+
+#include "derlDigest.h"
+#include "hashing/sha256.h"
+#include "hashing/xxh3.h"
+
+class denMessageReader;
+class denMessageWriter;
+
+
+/**
+ * \brief Incremental hasher producing digests using the selected algorithm.
+ */
+class derlHasher{
+public:
+	/** \brief Hash algorithm. */
+	enum class Algorithm{
+		/** \brief SHA-256, 32 byte digest. */
+		sha256,
+		
+		/** \brief XXH3 128-bit, 16 byte digest padded with zeros. */
+		xxh3
+	};
+	
+	
+	
+private:
+	const Algorithm pAlgorithm;
+	SHA256 pSha256;
+	XXH3_128 pXxh3;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create hasher. */
+	derlHasher(Algorithm algorithm);
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Algorithm. */
+	inline Algorithm GetAlgorithm() const{ return pAlgorithm; }
+	
+	/** \brief Add data. */
+	void Add(const void *data, uint64_t size);
+	
+	/** \brief Digest of all data added so far. */
+	derlDigest GetDigest();
+	
+	/** \brief Reset to start new digest. */
+	void Reset();
+	
+	/** \brief Count of significant digest bytes for algorithm. */
+	static int DigestSize(Algorithm algorithm);
+	
+	/**
+	 * \brief Write digest to message.
+	 * 
+	 * Writes the significant digest bytes if derlProtocol::Features::binaryDigest is
+	 * enabled otherwise the hex string.
+	 */
+	static void WriteDigest(denMessageWriter &writer, const derlDigest &digest,
+		Algorithm algorithm, uint32_t enabledFeatures);
+	
+	/** \brief Read digest written by WriteDigest() from message. */
+	static derlDigest ReadDigest(denMessageReader &reader, Algorithm algorithm,
+		uint32_t enabledFeatures);
+	/*@}*/
+};
+
+#endif
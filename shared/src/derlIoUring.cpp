@@ -0,0 +1,304 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+
+#include "derlIoUring.h"
+#include "config.h"
+
+#if defined(OS_UNIX) && __has_include(<linux/io_uring.h>)
+#define DERL_IO_URING 1
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+
+#ifdef DERL_IO_URING
+namespace{
+
+int ioUringSetup(unsigned int entries, io_uring_params &params){
+	return (int)syscall(__NR_io_uring_setup, entries, &params);
+}
+
+int ioUringEnter(int fd, unsigned int toSubmit, unsigned int minComplete, unsigned int flags){
+	return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+}
+
+inline unsigned int loadAcquire(const unsigned int *value){
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+inline void storeRelease(unsigned int *value, unsigned int newValue){
+	__atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+}
+
+}
+#endif
+
+
+// Class derlIoUring
+//////////////////////
+
+derlIoUring::derlIoUring(int entries) :
+pRingFd(-1),
+pEntries(0),
+pSqRing(nullptr),
+pCqRing(nullptr),
+pSqes(nullptr),
+pSqRingSize(0),
+pCqRingSize(0),
+pSqesSize(0),
+pSqHead(nullptr),
+pSqTail(nullptr),
+pSqMask(nullptr),
+pSqArray(nullptr),
+pCqHead(nullptr),
+pCqTail(nullptr),
+pCqMask(nullptr),
+pCqes(nullptr),
+pCountQueued(0),
+pCountPending(0)
+{
+#ifdef DERL_IO_URING
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	
+	pRingFd = ioUringSetup((unsigned int)entries, params);
+	if(pRingFd == -1){
+		throw std::runtime_error(std::strerror(errno));
+	}
+	
+	// IORING_OP_READ and IORING_OP_WRITE require kernel 5.6 which added this feature too
+	if((params.features & IORING_FEAT_RW_CUR_POS) == 0){
+		pCleanUp();
+		throw std::runtime_error("io_uring kernel support too old");
+	}
+	
+	pEntries = params.sq_entries;
+	pSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	pCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	pSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	
+	const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if(singleMmap){
+		pSqRingSize = pCqRingSize = std::max(pSqRingSize, pCqRingSize);
+	}
+	
+	pSqRing = mmap(nullptr, pSqRingSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, pRingFd, IORING_OFF_SQ_RING);
+	if(pSqRing == MAP_FAILED){
+		pSqRing = nullptr;
+		pCleanUp();
+		throw std::runtime_error("io_uring mapping submission queue failed");
+	}
+	
+	if(singleMmap){
+		pCqRing = pSqRing;
+		
+	}else{
+		pCqRing = mmap(nullptr, pCqRingSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, pRingFd, IORING_OFF_CQ_RING);
+		if(pCqRing == MAP_FAILED){
+			pCqRing = nullptr;
+			pCleanUp();
+			throw std::runtime_error("io_uring mapping completion queue failed");
+		}
+	}
+	
+	pSqes = mmap(nullptr, pSqesSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, pRingFd, IORING_OFF_SQES);
+	if(pSqes == MAP_FAILED){
+		pSqes = nullptr;
+		pCleanUp();
+		throw std::runtime_error("io_uring mapping submission entries failed");
+	}
+	
+	uint8_t * const sq = (uint8_t*)pSqRing;
+	pSqHead = (unsigned int*)(sq + params.sq_off.head);
+	pSqTail = (unsigned int*)(sq + params.sq_off.tail);
+	pSqMask = (unsigned int*)(sq + params.sq_off.ring_mask);
+	pSqArray = (unsigned int*)(sq + params.sq_off.array);
+	
+	uint8_t * const cq = (uint8_t*)pCqRing;
+	pCqHead = (unsigned int*)(cq + params.cq_off.head);
+	pCqTail = (unsigned int*)(cq + params.cq_off.tail);
+	pCqMask = (unsigned int*)(cq + params.cq_off.ring_mask);
+	pCqes = cq + params.cq_off.cqes;
+	
+#else
+	(void)entries;
+	throw std::runtime_error("io_uring not supported");
+#endif
+}
+
+derlIoUring::~derlIoUring() noexcept{
+	WaitAll();
+	pCleanUp();
+}
+
+
+// Management
+///////////////
+
+bool derlIoUring::IsSupported(){
+#ifdef DERL_IO_URING
+	return true;
+#else
+	return false;
+#endif
+}
+
+void derlIoUring::QueueRead(int fd, void *buffer, uint32_t size, uint64_t offset, uint64_t userData){
+#ifdef DERL_IO_URING
+	pQueue(IORING_OP_READ, fd, buffer, size, offset, userData);
+#endif
+}
+
+void derlIoUring::QueueWrite(int fd, const void *buffer, uint32_t size, uint64_t offset, uint64_t userData){
+#ifdef DERL_IO_URING
+	pQueue(IORING_OP_WRITE, fd, buffer, size, offset, userData);
+#endif
+}
+
+void derlIoUring::Submit(){
+#ifdef DERL_IO_URING
+	while(pCountQueued > 0){
+		const int result = ioUringEnter(pRingFd, (unsigned int)pCountQueued, 0, 0);
+		if(result == -1){
+			if(errno == EINTR || errno == EAGAIN){
+				continue;
+			}
+			throw std::runtime_error(std::strerror(errno));
+		}
+		
+		pCountQueued -= result;
+		pCountPending += result;
+	}
+#endif
+}
+
+void derlIoUring::WaitCompletion(uint64_t &userData, int &result){
+#ifdef DERL_IO_URING
+	Submit();
+	
+	if(pCountPending == 0){
+		throw std::runtime_error("no operation pending");
+	}
+	
+	while(true){
+		const unsigned int head = *pCqHead;
+		if(head != loadAcquire(pCqTail)){
+			const io_uring_cqe &cqe = ((const io_uring_cqe*)pCqes)[head & *pCqMask];
+			userData = cqe.user_data;
+			result = cqe.res;
+			storeRelease(pCqHead, head + 1);
+			pCountPending--;
+			return;
+		}
+		
+		if(ioUringEnter(pRingFd, 0, 1, IORING_ENTER_GETEVENTS) == -1 && errno != EINTR){
+			throw std::runtime_error(std::strerror(errno));
+		}
+	}
+#else
+	(void)userData;
+	(void)result;
+	throw std::runtime_error("io_uring not supported");
+#endif
+}
+
+void derlIoUring::WaitAll() noexcept{
+	uint64_t userData;
+	int result;
+	
+	try{
+		while(GetPendingCount() > 0){
+			WaitCompletion(userData, result);
+		}
+		
+	}catch(...){
+	}
+}
+
+
+// Private Functions
+//////////////////////
+
+void derlIoUring::pQueue(uint8_t opcode, int fd, const void *buffer, uint32_t size,
+uint64_t offset, uint64_t userData){
+#ifdef DERL_IO_URING
+	unsigned int tail = *pSqTail;
+	if(tail - loadAcquire(pSqHead) >= pEntries){
+		Submit();
+		tail = *pSqTail;
+	}
+	
+	const unsigned int index = tail & *pSqMask;
+	io_uring_sqe &sqe = ((io_uring_sqe*)pSqes)[index];
+	memset(&sqe, 0, sizeof(sqe));
+	sqe.opcode = opcode;
+	sqe.fd = fd;
+	sqe.addr = (uint64_t)(uintptr_t)buffer;
+	sqe.len = size;
+	sqe.off = offset;
+	sqe.user_data = userData;
+	
+	pSqArray[index] = index;
+	storeRelease(pSqTail, tail + 1);
+	pCountQueued++;
+#else
+	(void)opcode;
+	(void)fd;
+	(void)buffer;
+	(void)size;
+	(void)offset;
+	(void)userData;
+#endif
+}
+
+void derlIoUring::pCleanUp(){
+#ifdef DERL_IO_URING
+	if(pSqes){
+		munmap(pSqes, pSqesSize);
+		pSqes = nullptr;
+	}
+	if(pCqRing && pCqRing != pSqRing){
+		munmap(pCqRing, pCqRingSize);
+	}
+	pCqRing = nullptr;
+	if(pSqRing){
+		munmap(pSqRing, pSqRingSize);
+		pSqRing = nullptr;
+	}
+	if(pRingFd != -1){
+		close(pRingFd);
+		pRingFd = -1;
+	}
+#endif
+}
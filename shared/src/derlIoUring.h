@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLIOURING_H_
+#define _DERLIOURING_H_
+
+#include <memory>
+#include <stdint.h>
+
+
+/**
+ * \brief Linux io_uring submission and completion queue.
+ * 
+ * Minimal wrapper using the io_uring system calls directly. Reads and writes are queued,
+ * submitted in batches and completed asynchronously. Completions are identified by the
+ * user data given when queuing. Instances are not thread safe.
+ */
+class derlIoUring{
+public:
+	/** \brief Reference type. */
+	typedef std::unique_ptr<derlIoUring> Ref;
+	
+	
+private:
+	int pRingFd;
+	unsigned int pEntries;
+	void *pSqRing;
+	void *pCqRing;
+	void *pSqes;
+	size_t pSqRingSize;
+	size_t pCqRingSize;
+	size_t pSqesSize;
+	unsigned int *pSqHead;
+	unsigned int *pSqTail;
+	unsigned int *pSqMask;
+	unsigned int *pSqArray;
+	unsigned int *pCqHead;
+	unsigned int *pCqTail;
+	unsigned int *pCqMask;
+	void *pCqes;
+	int pCountQueued;
+	int pCountPending;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/**
+	 * \brief Create io_uring with entries submission queue entries.
+	 * \throws std::runtime_error io_uring is not supported or setup failed.
+	 */
+	derlIoUring(int entries);
+	
+	/** \brief Clean up io_uring. Waits for pending operations to complete. */
+	~derlIoUring() noexcept;
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief io_uring is compiled in. Creating can still fail if the kernel refuses. */
+	static bool IsSupported();
+	
+	/** \brief Count of queued or submitted operations not completed yet. */
+	inline int GetPendingCount() const{ return pCountQueued + pCountPending; }
+	
+	/** \brief Queue read of size bytes at offset of file into buffer. */
+	void QueueRead(int fd, void *buffer, uint32_t size, uint64_t offset, uint64_t userData);
+	
+	/** \brief Queue write of size bytes from buffer at offset of file. */
+	void QueueWrite(int fd, const void *buffer, uint32_t size, uint64_t offset, uint64_t userData);
+	
+	/**
+	 * \brief Submit queued operations.
+	 * \throws std::runtime_error Submitting failed.
+	 */
+	void Submit();
+	
+	/**
+	 * \brief Submit queued operations and wait for the next completion.
+	 * \param[out] userData User data of completed operation.
+	 * \param[out] result Bytes transferred or negative errno.
+	 * \throws std::runtime_error Waiting failed or no operation is pending.
+	 */
+	void WaitCompletion(uint64_t &userData, int &result);
+	
+	/** \brief Wait for all pending operations ignoring results. */
+	void WaitAll() noexcept;
+	/*@}*/
+	
+	
+	
+private:
+	void pQueue(uint8_t opcode, int fd, const void *buffer, uint32_t size,
+		uint64_t offset, uint64_t userData);
+	void pCleanUp();
+};
+
+#endif
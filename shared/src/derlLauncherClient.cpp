@@ -29,6 +29,8 @@
 #include "derlGlobal.h"
 #include "derlProtocol.h"
 #include "internal/derlLauncherClientConnection.h"
+#include "task/derlTaskFileLayoutUpdate.h"
+#include "task/derlTaskFileWrite.h"
 
 
 // Class derlLauncherClient
@@ -38,7 +40,12 @@ derlLauncherClient::derlLauncherClient() :
 pLogClassName("derlLauncherClient"),
 pConnection(std::make_unique<derlLauncherClientConnection>(*this)),
 pName("Client"),
+pEnableFastHash(true),
+pBlockSizePolicy(std::make_shared<derlBlockSizePolicy>()),
 pDirtyFileLayout(false),
+pEnableFileWatcher(false),
+pFileWatcherDelay(0.5f),
+pFileWatcherElapsed(0.0f),
 pStartTaskProcessorCount(1),
 pTaskProcessorsRunning(false),
 pKeepAliveInterval(10.0f),
@@ -62,6 +69,48 @@ void derlLauncherClient::SetPathDataDir(const std::filesystem::path &path){
 	}
 	
 	pPathDataDir = path;
+	pFileWatcher = nullptr;
+}
+
+void derlLauncherClient::SetEnableFastHash(bool enable){
+	pEnableFastHash = enable;
+}
+
+void derlLauncherClient::SetEnableFileWatcher(bool enable){
+	if(pConnection->GetConnectionState() != denConnection::ConnectionState::disconnected){
+		throw std::invalid_argument("is not disconnected");
+	}
+	
+	pEnableFileWatcher = enable;
+	if(!enable){
+		pFileWatcher = nullptr;
+	}
+}
+
+void derlLauncherClient::SetBlockSizePolicy(const derlBlockSizePolicy::Ref &policy){
+	if(pConnection->GetConnectionState() != denConnection::ConnectionState::disconnected){
+		throw std::invalid_argument("is not disconnected");
+	}
+	
+	pBlockSizePolicy = policy ? policy : std::make_shared<derlBlockSizePolicy>();
+}
+
+void derlLauncherClient::SetPathHashCache(const std::filesystem::path &path){
+	if(pConnection->GetConnectionState() != denConnection::ConnectionState::disconnected){
+		throw std::invalid_argument("is not disconnected");
+	}
+	
+	pPathHashCache = path;
+	pHashCache = path.empty() ? nullptr : std::make_shared<derlHashCache>(path);
+}
+
+void derlLauncherClient::SetPathWriteJournal(const std::filesystem::path &path){
+	if(pConnection->GetConnectionState() != denConnection::ConnectionState::disconnected){
+		throw std::invalid_argument("is not disconnected");
+	}
+	
+	pPathWriteJournal = path;
+	pWriteJournal = path.empty() ? nullptr : std::make_shared<derlWriteJournal>(path);
 }
 
 derlFileLayout::Ref derlLauncherClient::GetFileLayoutSync(){
@@ -79,6 +128,29 @@ void derlLauncherClient::SetDirtyFileLayoutSync(bool dirty){
 	pDirtyFileLayout = dirty;
 }
 
+void derlLauncherClient::BeginWriteFileSync(const std::string &path){
+	const std::lock_guard guard(pMutex);
+	pWritingFiles.insert(path);
+}
+
+void derlLauncherClient::EndWriteFileSync(const std::string &path){
+	const std::lock_guard guard(pMutex);
+	pWritingFiles.erase(path);
+	pWrittenFiles.insert(path);
+	pFileWatcherChanges.erase(path);
+}
+
+bool derlLauncherClient::IsWritingFileSync(const std::string &path){
+	const std::lock_guard guard(pMutex);
+	return pWritingFiles.find(path) != pWritingFiles.cend();
+}
+
+void derlLauncherClient::ClearWriteFilesSync(){
+	const std::lock_guard guard(pMutex);
+	pWritingFiles.clear();
+	pWrittenFiles.clear();
+}
+
 void derlLauncherClient::RemovePendingTaskWithType(derlBaseTask::Type type){
 	const std::lock_guard guard(pMutexPendingTasks);
 	derlBaseTask::Queue filtered;
@@ -206,6 +278,16 @@ void derlLauncherClient::StopTaskProcessors(){
 	}
 	
 	pTaskProcessors.clear();
+	
+	// blocks written since the last throttled saving are not stored yet
+	if(pWriteJournal){
+		try{
+			pWriteJournal->Save();
+			
+		}catch(const std::exception &e){
+			LogException("StopTaskProcessors", e, "Save write journal failed");
+		}
+	}
 }
 
 
@@ -215,6 +297,20 @@ void derlLauncherClient::ConnectTo(const std::string &address){
 		throw std::invalid_argument("data directory path is empty");
 	}
 	
+	if(pEnableFileWatcher && !pFileWatcher && derlFileWatcher::IsSupported()){
+		try{
+			pFileWatcher = std::make_unique<derlFileWatcher>(pPathDataDir);
+			
+			// changes done while not watching are unknown
+			const std::lock_guard guard(pMutex);
+			pFileWatcherChanges.clear();
+			pDirtyFileLayout = true;
+			
+		}catch(const std::exception &e){
+			LogException("ConnectTo", e, "Start file watcher failed");
+		}
+	}
+	
 	StartTaskProcessors();
 	pTaskProcessorsRunning = true;
 	
@@ -235,6 +331,7 @@ void derlLauncherClient::Disconnect(){
 }
 
 void derlLauncherClient::Update(float elapsed){
+	UpdateFileWatcher(elapsed);
 	UpdateLayoutChanged();
 	
 	pConnection->SendQueuedMessages();
@@ -259,6 +356,7 @@ void derlLauncherClient::Update(float elapsed){
 	&& pConnection->GetConnectionState() == denConnection::ConnectionState::disconnected){
 		StopTaskProcessors();
 		pTaskProcessorsRunning = false;
+		ClearWriteFilesSync();
 	}
 }
 
@@ -285,6 +383,69 @@ void derlLauncherClient::UpdateLayoutChanged(){
 	}
 }
 
+void derlLauncherClient::UpdateFileWatcher(float elapsed){
+	if(!pFileWatcher){
+		return;
+	}
+	
+	derlFileWatcher::SetPath paths;
+	derlTaskFileLayoutUpdate::Ref task;
+	{
+	// poll while holding the lock. changes caused by writes finished before polling
+	// are reported by this poll and have to be ignored
+	const std::lock_guard guard(pMutex);
+	const bool valid = pFileWatcher->Poll(paths);
+	
+	for(derlFileWatcher::SetPath::iterator iter=paths.begin(); iter!=paths.end(); ){
+		if(pWritingFiles.find(*iter) != pWritingFiles.cend()
+		|| pWrittenFiles.find(*iter) != pWrittenFiles.cend()
+		|| derlTaskFileWrite::IsDeltaPath(*iter)){
+			iter = paths.erase(iter);
+			
+		}else{
+			iter++;
+		}
+	}
+	pWrittenFiles.clear();
+	
+	if(!valid){
+		Log(denLogger::LogSeverity::warning, "UpdateFileWatcher",
+			"File watcher lost changes, file layout dirty.");
+		pFileWatcherChanges.clear();
+		pDirtyFileLayout = true;
+		return;
+	}
+	
+	if(!paths.empty()){
+		pFileWatcherChanges.insert(paths.cbegin(), paths.cend());
+		pFileWatcherElapsed = 0.0f;
+		return;
+	}
+	
+	if(pFileWatcherChanges.empty() || !pFileLayout){
+		return;
+	}
+	
+	// wait for changes to settle to not hash files while they are written
+	pFileWatcherElapsed += elapsed;
+	if(pFileWatcherElapsed < pFileWatcherDelay){
+		return;
+	}
+	
+	{
+	const std::lock_guard guardTasks(pMutexPendingTasks);
+	if(HasPendingTasksWithType(derlBaseTask::Type::fileLayoutUpdate)){
+		return;
+	}
+	}
+	
+	task = std::make_shared<derlTaskFileLayoutUpdate>(pFileWatcherChanges);
+	pFileWatcherChanges.clear();
+	}
+	
+	AddPendingTaskSync(task);
+}
+
 std::unique_ptr<std::string> derlLauncherClient::GetSystemProperty(const std::string &property){
 	return std::make_unique<std::string>();
 }
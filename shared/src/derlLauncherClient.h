@@ -34,7 +34,11 @@
 
 #include <denetwork/denConnection.h>
 
+#include "derlBlockSizePolicy.h"
 #include "derlFileLayout.h"
+#include "derlFileWatcher.h"
+#include "derlHashCache.h"
+#include "derlWriteJournal.h"
 #include "derlRunParameters.h"
 #include "processor/derlTaskProcessorLauncherClient.h"
 #include "task/derlBaseTask.h"
@@ -72,10 +76,22 @@ private:
 	
 	std::string pName;
 	std::filesystem::path pPathDataDir;
+	bool pEnableFastHash;
+	derlBlockSizePolicy::Ref pBlockSizePolicy;
+	std::filesystem::path pPathHashCache;
+	derlHashCache::Ref pHashCache;
+	std::filesystem::path pPathWriteJournal;
+	derlWriteJournal::Ref pWriteJournal;
 	
 	derlFileLayout::Ref pFileLayout, pNextFileLayout;
 	bool pDirtyFileLayout;
 	
+	bool pEnableFileWatcher;
+	derlFileWatcher::Ref pFileWatcher;
+	derlFileWatcher::SetPath pFileWatcherChanges;
+	float pFileWatcherDelay, pFileWatcherElapsed;
+	derlFileWatcher::SetPath pWritingFiles, pWrittenFiles;
+	
 	std::mutex pMutex;
 	
 	derlBaseTask::Queue pPendingTasks;
@@ -127,6 +143,85 @@ public:
 	
 	
 	
+	/** \brief Fast hash algorithm is supported. */
+	inline bool GetEnableFastHash() const{ return pEnableFastHash; }
+	
+	/**
+	 * \brief Set if fast hash algorithm is supported.
+	 * 
+	 * Fast hash (XXH3-128) is used instead of SHA-256 only if the server enables it too.
+	 * Enabled by default. Change takes effect the next time a connection is established.
+	 */
+	void SetEnableFastHash(bool enable);
+	
+	/** \brief Policy selecting the block size of files. */
+	inline const derlBlockSizePolicy::Ref &GetBlockSizePolicy() const{ return pBlockSizePolicy; }
+	
+	/**
+	 * \brief Set policy selecting the block size of files.
+	 * 
+	 * Server and client should use the same policy. Otherwise block hashes have to be
+	 * requested for all differing files. Block size used for each file is stored in the
+	 * file layout. If nullptr is set the default policy is used.
+	 * 
+	 * \throws std::invalid_argument Connected to server.
+	 */
+	void SetBlockSizePolicy(const derlBlockSizePolicy::Ref &policy);
+	
+	/** \brief Path to hash cache file or empty path if disabled. */
+	inline const std::filesystem::path &GetPathHashCache() const{ return pPathHashCache; }
+	
+	/**
+	 * \brief Set path to hash cache file or empty path to disable.
+	 * 
+	 * The hash cache stores file and block hashes across runs. Files with unchanged
+	 * size, modification time and inode are not hashed again while building the file
+	 * layout. The file can be located inside the data directory in which case it is
+	 * excluded from the file layout. Disabled by default.
+	 * 
+	 * \throws std::invalid_argument Connected to server.
+	 */
+	void SetPathHashCache(const std::filesystem::path &path);
+	
+	/** \brief Hash cache or nullptr if disabled. */
+	inline const derlHashCache::Ref &GetHashCache() const{ return pHashCache; }
+	
+	/** \brief Path to write journal file or empty path if disabled. */
+	inline const std::filesystem::path &GetPathWriteJournal() const{ return pPathWriteJournal; }
+	
+	/**
+	 * \brief Set path to write journal file or empty path to disable.
+	 * 
+	 * The write journal stores the blocks written so far of files being written. If
+	 * writing a file is interrupted the next synchronization continues with the missing
+	 * blocks instead of sending the entire file again. Locate the file outside the data
+	 * directory. Disabled by default.
+	 * 
+	 * \throws std::invalid_argument Connected to server.
+	 */
+	void SetPathWriteJournal(const std::filesystem::path &path);
+	
+	/** \brief Write journal or nullptr if disabled. */
+	inline const derlWriteJournal::Ref &GetWriteJournal() const{ return pWriteJournal; }
+	
+	/** \brief Watch data directory for changes to keep file layout up to date. */
+	inline bool GetEnableFileWatcher() const{ return pEnableFileWatcher; }
+	
+	/**
+	 * \brief Set to watch data directory for changes to keep file layout up to date.
+	 * 
+	 * If enabled changed files are hashed again and updated in the file layout instead of
+	 * building the file layout again the next time the server requests it. The watcher is
+	 * started while connecting. If file watching is not supported by the platform or
+	 * starting fails the file layout is built as if disabled. Disabled by default.
+	 * 
+	 * \throws std::invalid_argument Connected to server.
+	 */
+	void SetEnableFileWatcher(bool enable);
+	
+	/** \brief File watcher is running. */
+	inline bool IsFileWatcherRunning() const{ return pFileWatcher != nullptr; }
+	
 	/** \brief File layout or nullptr. */
 	inline const derlFileLayout::Ref &GetFileLayout() const{ return pFileLayout; }
 	
@@ -147,6 +242,32 @@ public:
 	 */
 	void SetDirtyFileLayoutSync(bool dirty);
 	
+	/**
+	 * \brief Synchronization starts writing file while locking mutex.
+	 * 
+	 * File watcher ignores changes of the file while it is written. Finishing the
+	 * write updates the file layout.
+	 */
+	void BeginWriteFileSync(const std::string &path);
+	
+	/**
+	 * \brief Synchronization finished writing file while locking mutex.
+	 * 
+	 * File watcher ignores changes caused by the write until the next poll.
+	 */
+	void EndWriteFileSync(const std::string &path);
+	
+	/** \brief Synchronization is writing file while locking mutex. */
+	bool IsWritingFileSync(const std::string &path);
+	
+	/**
+	 * \brief Drop files written by synchronization while locking mutex.
+	 * 
+	 * Called if a new synchronization starts or the connection closes. Writes of
+	 * failed synchronizations are never finished.
+	 */
+	void ClearWriteFilesSync();
+	
 	
 	
 	/** \brief Mutex for accessing client members. */
@@ -273,6 +394,15 @@ public:
 	/** \brief Apply layout change if pending. */
 	void UpdateLayoutChanged();
 	
+	/**
+	 * \brief Process file watcher changes if running.
+	 * 
+	 * Changes are collected until no new changes arrived for a short time. Then a
+	 * derlTaskFileLayoutUpdate is added if a file layout is present. If the watcher lost
+	 * events the file layout is set dirty.
+	 */
+	void UpdateFileWatcher(float elapsed);
+	
 	
 	
 	/** \brief Run status. */
@@ -0,0 +1,212 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+
+#include "derlLz4.h"
+
+
+namespace{
+
+const int vMinMatch = 4;
+const uint64_t vLastLiterals = 5;
+const uint64_t vMatchFindLimit = 12;
+const uint64_t vMaxOffset = 65535;
+const int vHashBits = 14;
+const uint32_t vEmptyEntry = 0xffffffff;
+
+inline uint32_t read32(const uint8_t *data){
+	uint32_t value;
+	memcpy(&value, data, 4);
+	return value;
+}
+
+inline uint32_t hashSequence(uint32_t sequence){
+	return (sequence * 2654435761U) >> (32 - vHashBits);
+}
+
+void writeLength(std::string &compressed, uint64_t length){
+	while(length >= 255){
+		compressed.push_back((char)255);
+		length -= 255;
+	}
+	compressed.push_back((char)length);
+}
+
+}
+
+
+// Class derlLz4
+//////////////////
+
+bool derlLz4::Compress(const void *data, uint64_t size, std::string &compressed, uint64_t maxSize){
+	const uint8_t * const src = (const uint8_t*)data;
+	uint64_t anchor = 0;
+	
+	compressed.clear();
+	compressed.reserve((size_t)std::min(maxSize, size + size / 255 + 16));
+	
+	if(size > vMatchFindLimit){
+		std::vector<uint32_t> table(1 << vHashBits, vEmptyEntry);
+		const uint64_t matchLimit = size - vLastLiterals;
+		const uint64_t findLimit = size - vMatchFindLimit;
+		uint64_t position = 0;
+		
+		while(position < findLimit){
+			const uint32_t sequence = read32(src + position);
+			uint32_t &entry = table[hashSequence(sequence)];
+			const uint64_t reference = entry;
+			entry = (uint32_t)position;
+			
+			if(reference == vEmptyEntry || position - reference > vMaxOffset
+			|| read32(src + reference) != sequence){
+				// skip faster through data not matching well
+				position += 1 + ((position - anchor) >> 6);
+				continue;
+			}
+			
+			uint64_t matchLength = vMinMatch;
+			while(position + matchLength < matchLimit
+			&& src[reference + matchLength] == src[position + matchLength]){
+				matchLength++;
+			}
+			
+			const uint64_t literalLength = position - anchor;
+			const uint64_t lengthCode = matchLength - vMinMatch;
+			compressed.push_back((char)((std::min(literalLength, (uint64_t)15) << 4)
+				| std::min(lengthCode, (uint64_t)15)));
+			if(literalLength >= 15){
+				writeLength(compressed, literalLength - 15);
+			}
+			compressed.append((const char*)src + anchor, (size_t)literalLength);
+			
+			const uint64_t offset = position - reference;
+			compressed.push_back((char)(offset & 0xff));
+			compressed.push_back((char)(offset >> 8));
+			if(lengthCode >= 15){
+				writeLength(compressed, lengthCode - 15);
+			}
+			
+			if(compressed.size() > maxSize){
+				return false;
+			}
+			
+			position += matchLength;
+			anchor = position;
+		}
+	}
+	
+	const uint64_t literalLength = size - anchor;
+	compressed.push_back((char)(std::min(literalLength, (uint64_t)15) << 4));
+	if(literalLength >= 15){
+		writeLength(compressed, literalLength - 15);
+	}
+	compressed.append((const char*)src + anchor, (size_t)literalLength);
+	
+	return compressed.size() <= maxSize;
+}
+
+void derlLz4::Decompress(const void *data, uint64_t size, void *target, uint64_t targetSize){
+	const uint8_t *src = (const uint8_t*)data;
+	const uint8_t * const srcEnd = src + size;
+	uint8_t * const dest = (uint8_t*)target;
+	uint64_t position = 0;
+	
+	while(true){
+		if(src == srcEnd){
+			throw std::runtime_error("LZ4: unexpected end of data");
+		}
+		
+		const uint8_t token = *(src++);
+		
+		uint64_t literalLength = token >> 4;
+		if(literalLength == 15){
+			uint8_t value;
+			do{
+				if(src == srcEnd){
+					throw std::runtime_error("LZ4: unexpected end of data");
+				}
+				value = *(src++);
+				literalLength += value;
+			}while(value == 255);
+		}
+		
+		if(literalLength > (uint64_t)(srcEnd - src) || literalLength > targetSize - position){
+			throw std::runtime_error("LZ4: literal length out of range");
+		}
+		memcpy(dest + position, src, (size_t)literalLength);
+		src += literalLength;
+		position += literalLength;
+		
+		if(src == srcEnd){
+			break;
+		}
+		
+		if(srcEnd - src < 2){
+			throw std::runtime_error("LZ4: unexpected end of data");
+		}
+		const uint64_t offset = (uint64_t)src[0] | ((uint64_t)src[1] << 8);
+		src += 2;
+		if(offset == 0 || offset > position){
+			throw std::runtime_error("LZ4: offset out of range");
+		}
+		
+		uint64_t matchLength = token & 15;
+		if(matchLength == 15){
+			uint8_t value;
+			do{
+				if(src == srcEnd){
+					throw std::runtime_error("LZ4: unexpected end of data");
+				}
+				value = *(src++);
+				matchLength += value;
+			}while(value == 255);
+		}
+		matchLength += vMinMatch;
+		
+		if(matchLength > targetSize - position){
+			throw std::runtime_error("LZ4: match length out of range");
+		}
+		
+		// match can overlap the output written by itself
+		const uint8_t *match = dest + position - offset;
+		uint8_t * const end = dest + position + matchLength;
+		uint8_t *out = dest + position;
+		if(offset >= matchLength){
+			memcpy(out, match, (size_t)matchLength);
+			
+		}else{
+			while(out != end){
+				*(out++) = *(match++);
+			}
+		}
+		position += matchLength;
+	}
+	
+	if(position != targetSize){
+		throw std::runtime_error("LZ4: decompressed size does not match");
+	}
+}
@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _DERLLZ4_H_
+#define _DERLLZ4_H_
+
+#include <string>
+#include <stdint.h>
+
+
+/**
+ * \brief LZ4 block format compression.
+ * 
+ * Compresses data into the LZ4 block format without frame header. Compression is greedy
+ * using a single hash table. Favors speed over compression ratio. Decompression verifies
+ * all offsets and lengths against the input and output sizes.
+ */
+class derlLz4{
+public:
+	/**
+	 * \brief Compress data.
+	 * 
+	 * Returns false if the compressed size would exceed maxSize. In this case the content
+	 * of compressed is undefined.
+	 */
+	static bool Compress(const void *data, uint64_t size, std::string &compressed, uint64_t maxSize);
+	
+	/**
+	 * \brief Decompress data.
+	 * 
+	 * Target has to hold exactly targetSize bytes. Throws exception if the data is malformed
+	 * or does not decompress to exactly targetSize bytes.
+	 */
+	static void Decompress(const void *data, uint64_t size, void *target, uint64_t targetSize);
+};
+
+#endif
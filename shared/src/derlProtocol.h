@@ -25,6 +25,8 @@
 #ifndef _DERLPROTOCOL_H_
 #define _DERLPROTOCOL_H_
 
+#include <stdint.h>
+
 namespace derlProtocol{
 	/**
 	 * \brief Connect request signatures.
@@ -32,6 +34,14 @@ namespace derlProtocol{
 	static const char * const signatureClient = "DERemLaunchCnt-0";
 	static const char * const signatureServer = "DERemLaunchSrv-0";
 	
+	/**
+	 * \brief Leaf size of tree hashes.
+	 * 
+	 * Fixed size independent of the block size used by server and client. Otherwise
+	 * peers with different block size policies would never match tree hashes.
+	 */
+	static const uint32_t treeHashLeafSize = 262144;
+	
 	/**
 	 * \brief Message codes
 	 */
@@ -55,7 +65,163 @@ namespace derlProtocol{
 		logs = 17,
 		requestSystemProperty = 18,
 		responseSystemProperty = 19,
-		keepAlive = 20
+		keepAlive = 20,
+		responseFileLayoutPage = 21,
+		responseFileLayoutFinished = 22,
+		responseFileLayoutChanges = 23,
+		sendFileBundle = 24,
+		responseFileBundle = 25
+	};
+	
+	/**
+	 * \brief Connection features negotiated during connect request.
+	 */
+	enum class Features{
+		/** \brief Hashes are send as 32 byte binary digest instead of 64 character hex string. */
+		binaryDigest = 0x1,
+		
+		/** \brief File and block hashes use XXH3-128 instead of SHA-256. */
+		fastHash = 0x2,
+		
+		/**
+		 * \brief File hash of files larger than treeHashLeafSize is the hash of the leaf hashes.
+		 * 
+		 * Leaves are consecutive treeHashLeafSize ranges of the file content.
+		 */
+		treeHash = 0x4,
+		
+		/**
+		 * \brief File layout is send as pages while being build.
+		 * 
+		 * Layout is send using responseFileLayoutPage messages followed by one
+		 * responseFileLayoutFinished message instead of one responseFileLayout message.
+		 */
+		layoutPages = 0x8,
+		
+		/**
+		 * \brief File layout files are written using compact encoding.
+		 * 
+		 * Files are sorted by path. Paths are front coded against the previous path of the
+		 * same message and sizes are variable length encoded. See derlCompactLayout.
+		 */
+		compactLayout = 0x10,
+		
+		/**
+		 * \brief File layout can be requested as changes since a previous file layout.
+		 * 
+		 * requestFileLayout carries the identifier and generation of the last file layout
+		 * received from the client or 0 for both to request the full file layout.
+		 * responseFileLayout and responseFileLayoutFinished carry the identifier and
+		 * generation of the send file layout. If the client still knows the changes since
+		 * the requested generation it answers with responseFileLayoutChanges instead.
+		 */
+		layoutChanges = 0x20,
+		
+		/**
+		 * \brief Files with changed size can be written using rolling checksum deltas.
+		 * 
+		 * requestFileBlockHashes carries a byte flag requesting weak rolling checksums
+		 * following the contentChunks flag if present.
+		 * If requested responseFileBlockHashes carries a weak rolling checksum after each
+		 * block hash. Weak checksums are only requested for files with changed size.
+		 * requestWriteFile carries a byte flag indicating a delta write if this feature or
+		 * contentChunks is enabled. For delta writes sendFileData carries delta instructions
+		 * reconstructing the block from the existing client file and literal data. The file
+		 * is written to a temporary file replacing the existing file during finishing.
+		 */
+		rollingDelta = 0x40,
+		
+		/**
+		 * \brief Files with changed size can be written using content defined chunks.
+		 * 
+		 * requestFileBlockHashes carries a byte flag requesting content defined chunks
+		 * using the block size as average chunk size (see derlFastCdc). For chunk requests
+		 * responseFileBlockHashes carries the chunk size after each chunk hash. Files are
+		 * written using delta writes as described for rollingDelta.
+		 */
+		contentChunks = 0x80,
+		
+		/**
+		 * \brief Files with changed size can be written partially.
+		 * 
+		 * Block hashes are requested for files with changed size too. Only blocks
+		 * differing from the client blocks at the same index are send. Clients resize
+		 * existing files with changed size instead of truncating them.
+		 */
+		partialResize = 0x100,
+		
+		/**
+		 * \brief File data can be compressed.
+		 * 
+		 * sendFileData carries a byte with the compression (see Compression) after the
+		 * block index. Compressed data decompresses to the block size or for delta writes
+		 * to the size of all literal data.
+		 */
+		compression = 0x200,
+		
+		/**
+		 * \brief Small files can be written using file bundles.
+		 * 
+		 * sendFileBundle carries the path, size, block size, hash and data of multiple
+		 * complete files. Data is prefixed by a byte with the compression if compression
+		 * is enabled and the data size. The client writes and verifies all files and
+		 * answers with one responseFileBundle carrying the path and result (see
+		 * FinishWriteFileResult) of each file. No other messages are used for these files.
+		 */
+		fileBundles = 0x400,
+		
+		/**
+		 * \brief Interrupted file writes can be resumed.
+		 * 
+		 * requestWriteFile carries the file hash after all other values. Successful
+		 * responseWriteFile carries a bitmap of blocks already written by an interrupted
+		 * previous write of the same file content. The bitmap is prefixed by the bitmap
+		 * size in bytes which is 0 if no blocks are present. Bit 0 of the first byte is
+		 * block 0. Present blocks are not send.
+		 */
+		resumeWrite = 0x800,
+		
+		/**
+		 * \brief Blocks containing only zero bytes are not send.
+		 * 
+		 * sendFileData carries the compression byte described in compression even if
+		 * compression is not enabled. Blocks containing only zero bytes are send using
+		 * Compression::zero without data. Clients leave the block as hole in the file.
+		 */
+		zeroBlocks = 0x1000
+	};
+	
+	/**
+	 * \brief File layout result.
+	 */
+	enum class FileLayoutResult{
+		success = 0,
+		failure = 1
+	};
+	
+	/**
+	 * \brief Delta instruction.
+	 */
+	enum class DeltaInstruction{
+		/** \brief Copy data from existing client file. */
+		copy = 0,
+		
+		/** \brief Literal data send with message. */
+		literal = 1
+	};
+	
+	/**
+	 * \brief File data compression.
+	 */
+	enum class Compression{
+		/** \brief Uncompressed data. */
+		none = 0,
+		
+		/** \brief LZ4 block format (see derlLz4). */
+		lz4 = 1,
+		
+		/** \brief Block contains only zero bytes. No data is send. */
+		zero = 2
 	};
 	
 	/**
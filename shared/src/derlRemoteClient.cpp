@@ -46,7 +46,8 @@ pNotifyRunStatusChanged(false),
 pNotifyConnectionEstablished(false),
 pNotifyConnectionClosed(false),
 pKeepAliveInterval(10.0f),
-pKeepAliveElapsed(0.0f){
+pKeepAliveElapsed(0.0f),
+pTransferOrderPolicy(std::make_shared<derlTransferOrderPolicy>()){
 }
 
 derlRemoteClient::~derlRemoteClient() noexcept{
@@ -140,6 +141,19 @@ void derlRemoteClient::SetEnableDebugLog(bool enable){
 	pConnection->SetEnableDebugLog(enable);
 }
 
+derlTransferWindow &derlRemoteClient::GetTransferWindow(){
+	return pConnection->GetTransferWindow();
+}
+
+const derlTransferWindow &derlRemoteClient::GetTransferWindow() const{
+	return pConnection->GetTransferWindow();
+}
+
+void derlRemoteClient::SetTransferOrderPolicy(const derlTransferOrderPolicy::Ref &policy){
+	const std::lock_guard guard(pMutex);
+	pTransferOrderPolicy = policy ? policy : std::make_shared<derlTransferOrderPolicy>();
+}
+
 void derlRemoteClient::SetSynchronizeStatus(SynchronizeStatus status, const std::string & details){
 	const std::lock_guard guard(pMutex);
 	pSynchronizeStatus = status;
@@ -147,6 +161,8 @@ void derlRemoteClient::SetSynchronizeStatus(SynchronizeStatus status, const std:
 }
 
 void derlRemoteClient::Synchronize(){
+	uint64_t layoutIdentifier = 0, layoutGeneration = 0;
+	
 	{
 	const std::lock_guard guard(pMutex);
 	if(pTaskSyncClient && pTaskSyncClient->GetStatus() == derlTaskSyncClient::Status::failure){
@@ -163,10 +179,29 @@ void derlRemoteClient::Synchronize(){
 	pSynchronizeStatus = SynchronizeStatus::processing;
 	pSynchronizeDetails = "Scanning file systems...";
 	
+	// the last received client file layout allows to request only the changes since then
+	if(pFileLayoutClient){
+		pFileLayoutClientBase = pFileLayoutClient;
+	}
+	
 	pFileLayoutServer = nullptr;
 	pFileLayoutClient = nullptr;
 	
+	pConnection->ResetTransferState();
+	
 	pTaskSyncClient = std::make_shared<derlTaskSyncClient>();
+	pTaskSyncClient->SetFileLayoutClientBase(pFileLayoutClientBase);
+	pTaskSyncClient->SetRollingDelta((pConnection->GetEnabledFeatures()
+		& (uint32_t)derlProtocol::Features::rollingDelta) != 0);
+	pTaskSyncClient->SetPartialResize((pConnection->GetEnabledFeatures()
+		& (uint32_t)derlProtocol::Features::partialResize) != 0);
+	pTaskSyncClient->SetContentChunkSize((pConnection->GetEnabledFeatures()
+		& (uint32_t)derlProtocol::Features::contentChunks) != 0 ? pServer.GetContentChunkSize() : 0);
+	
+	if(pFileLayoutClientBase){
+		layoutIdentifier = pFileLayoutClientBase->GetIdentifier();
+		layoutGeneration = pFileLayoutClientBase->GetGeneration();
+	}
 	
 	{
 	const std::lock_guard guardPending(pMutexPendingTasks);
@@ -174,7 +209,7 @@ void derlRemoteClient::Synchronize(){
 	}
 	}
 	
-	pConnection->SendRequestLayout();
+	pConnection->SendRequestLayout(layoutIdentifier, layoutGeneration);
 	NotifyPendingTaskAdded();
 	
 	OnSynchronizeBegin();
@@ -335,6 +370,7 @@ void derlRemoteClient::FailSynchronization(const std::string &error){
 	{
 	const std::lock_guard guard2(pTaskSyncClient->GetMutex());
 	pTaskSyncClient->SetStatus(derlTaskSyncClient::Status::failure);
+	pConnection->ResetTransferState();
 	
 	if(pTaskSyncClient->GetError().empty()){
 		pSynchronizeDetails = "Synchronize failed.";
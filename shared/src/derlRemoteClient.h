@@ -32,6 +32,7 @@
 #include <condition_variable>
 
 #include "derlFileLayout.h"
+#include "derlTransferOrderPolicy.h"
 #include "internal/derlRemoteClientConnection.h"
 #include "processor/derlTaskProcessorRemoteClient.h"
 #include "task/derlTaskFileLayout.h"
@@ -92,7 +93,7 @@ private:
 	SynchronizeStatus pSynchronizeStatus;
 	std::string pSynchronizeDetails;
 	
-	derlFileLayout::Ref pFileLayoutServer, pFileLayoutClient;
+	derlFileLayout::Ref pFileLayoutServer, pFileLayoutClient, pFileLayoutClientBase;
 	
 	derlTaskSyncClient::Ref pTaskSyncClient;
 	
@@ -113,6 +114,8 @@ private:
 	
 	float pKeepAliveInterval, pKeepAliveElapsed;
 	
+	derlTransferOrderPolicy::Ref pTransferOrderPolicy;
+	
 	
 public:
 	/** \name Constructors and Destructors */
@@ -219,6 +222,32 @@ public:
 	/** \brief Set if debug logging is enabled. */
 	void SetEnableDebugLog(bool enable);
 	
+	/**
+	 * \brief Transfer window limiting the file data in progress while synchronizing.
+	 * 
+	 * Live values like window size, round trip time and bandwidth can be read any time.
+	 * Maximum files and blocks in progress as well as the memory limit can be overridden.
+	 */
+	derlTransferWindow &GetTransferWindow();
+	const derlTransferWindow &GetTransferWindow() const;
+	
+	/**
+	 * \brief Transfer order policy.
+	 * 
+	 * Orders the files written while synchronizing. Default policy orders files by path.
+	 * 
+	 * \note Lock mutex while calling this function.
+	 */
+	inline const derlTransferOrderPolicy::Ref &GetTransferOrderPolicy() const{ return pTransferOrderPolicy; }
+	
+	/**
+	 * \brief Set transfer order policy while locking mutex.
+	 * 
+	 * Set nullptr to use the default policy. Takes effect the next time the client
+	 * is synchronized. Do not change the policy after assigning it.
+	 */
+	void SetTransferOrderPolicy(const derlTransferOrderPolicy::Ref &policy);
+	
 	
 	
 	/**
@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "derlRollingChecksum.h"
+
+
+// Class derlRollingChecksum
+//////////////////////////////
+
+derlRollingChecksum::derlRollingChecksum() :
+pA(0),
+pB(0),
+pLength(0){
+}
+
+
+// Management
+///////////////
+
+void derlRollingChecksum::Init(const void *data, uint64_t size){
+	const uint8_t * const bytes = (const uint8_t*)data;
+	uint64_t i;
+	
+	pA = 0;
+	pB = 0;
+	pLength = (uint32_t)size;
+	
+	// arithmetic wraps modulo 2^32 which keeps the lower 16 bits correct
+	for(i=0; i<size; i++){
+		pA += bytes[i];
+		pB += pA;
+	}
+}
+
+void derlRollingChecksum::Roll(uint8_t byteOut, uint8_t byteIn){
+	pA += (uint32_t)byteIn - (uint32_t)byteOut;
+	pB += pA - pLength * (uint32_t)byteOut;
+}
+
+uint32_t derlRollingChecksum::Calc(const void *data, uint64_t size){
+	derlRollingChecksum checksum;
+	checksum.Init(data, size);
+	return checksum.GetChecksum();
+}
@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLROLLINGCHECKSUM_H_
+#define _DERLROLLINGCHECKSUM_H_
+
+#include <stdint.h>
+
+
+/**
+ * \brief Weak rolling checksum.
+ * 
+ * Adler-32 like checksum as used by rsync. The checksum of a window can be moved forward
+ * by one byte in constant time. Used to find blocks of a file at any byte offset. Matches
+ * have to be verified using a strong hash.
+ */
+class derlRollingChecksum{
+private:
+	uint32_t pA;
+	uint32_t pB;
+	uint32_t pLength;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create rolling checksum. */
+	derlRollingChecksum();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Checksum of current window. */
+	inline uint32_t GetChecksum() const{ return (pA & 0xffff) | (pB << 16); }
+	
+	/** \brief Init window with data. */
+	void Init(const void *data, uint64_t size);
+	
+	/** \brief Move window forward by one byte. */
+	void Roll(uint8_t byteOut, uint8_t byteIn);
+	
+	/** \brief Checksum of data. */
+	static uint32_t Calc(const void *data, uint64_t size);
+	/*@}*/
+};
+
+#endif
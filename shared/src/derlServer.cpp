@@ -23,6 +23,7 @@
  */
 
 #include <algorithm>
+#include <sstream>
 #include <stdexcept>
 
 #include "derlServer.h"
@@ -34,7 +35,14 @@
 /////////////////////
 
 derlServer::derlServer() :
-pServer(std::make_unique<derlServerServer>(*this)){
+pServer(std::make_unique<derlServerServer>(*this)),
+pEnableFastHash(false),
+pBlockSizePolicy(std::make_shared<derlBlockSizePolicy>()),
+pEnableRollingDelta(false),
+pContentChunkSize(0),
+pEnableCompression(false),
+pMaxBundleFileSize(65536),
+pEnableFileWatcher(false){
 }
 
 derlServer::~derlServer() noexcept{
@@ -50,6 +58,57 @@ void derlServer::SetPathDataDir(const std::filesystem::path &path){
 	}
 	
 	pPathDataDir = path;
+	pFileWatcher = nullptr;
+	InvalidateFileLayouts();
+}
+
+void derlServer::SetEnableFastHash(bool enable){
+	pEnableFastHash = enable;
+}
+
+void derlServer::SetEnableRollingDelta(bool enable){
+	pEnableRollingDelta = enable;
+}
+
+void derlServer::SetContentChunkSize(uint32_t size){
+	pContentChunkSize = size;
+}
+
+void derlServer::SetEnableCompression(bool enable){
+	pEnableCompression = enable;
+}
+
+void derlServer::SetMaxBundleFileSize(uint32_t size){
+	pMaxBundleFileSize = size;
+}
+
+void derlServer::SetBlockSizePolicy(const derlBlockSizePolicy::Ref &policy){
+	if(pServer->IsListening()){
+		throw std::invalid_argument("is listening");
+	}
+	
+	pBlockSizePolicy = policy ? policy : std::make_shared<derlBlockSizePolicy>();
+	InvalidateFileLayouts();
+}
+
+void derlServer::SetPathHashCache(const std::filesystem::path &path){
+	if(pServer->IsListening()){
+		throw std::invalid_argument("is listening");
+	}
+	
+	pPathHashCache = path;
+	pHashCache = path.empty() ? nullptr : std::make_shared<derlHashCache>(path);
+}
+
+void derlServer::SetEnableFileWatcher(bool enable){
+	if(pServer->IsListening()){
+		throw std::invalid_argument("is listening");
+	}
+	
+	pEnableFileWatcher = enable;
+	if(!enable){
+		pFileWatcher = nullptr;
+	}
 }
 
 const denLogger::Ref &derlServer::GetLogger() const{
@@ -64,6 +123,67 @@ derlRemoteClient::Ref derlServer::CreateClient(const derlRemoteClientConnection:
 	return std::make_shared<derlRemoteClient>(*this, connection);
 }
 
+derlFileLayout::Ref derlServer::AcquireFileLayout(derlHasher::Algorithm algorithm, bool treeHash){
+	std::unique_lock guard(pMutexFileLayouts);
+	FileLayoutSnapshot &snapshot = pFileLayouts[pFileLayoutKey(algorithm, treeHash)];
+	
+	if(snapshot.building){
+		snapshot.waiting++;
+		pConditionFileLayouts.wait(guard, [&snapshot](){
+			return !snapshot.building;
+		});
+		snapshot.waiting--;
+		
+		const derlFileLayout::Ref layout(snapshot.layout);
+		if(snapshot.waiting == 0 && (!pFileWatcher || snapshot.outdated)){
+			// without file watcher the file layout is only shared with waiting clients
+			snapshot.layout = nullptr;
+			snapshot.outdated = false;
+		}
+		if(layout){
+			return layout;
+		}
+		
+	}else if(snapshot.layout){
+		return snapshot.layout;
+	}
+	
+	snapshot.building = true;
+	snapshot.outdated = false;
+	return nullptr;
+}
+
+void derlServer::FinishFileLayout(derlHasher::Algorithm algorithm, bool treeHash,
+const derlFileLayout::Ref &layout){
+	{
+	const std::lock_guard guard(pMutexFileLayouts);
+	FileLayoutSnapshot &snapshot = pFileLayouts[pFileLayoutKey(algorithm, treeHash)];
+	snapshot.building = false;
+	snapshot.layout = layout;
+	if(snapshot.waiting == 0 && (!pFileWatcher || snapshot.outdated)){
+		snapshot.layout = nullptr;
+		snapshot.outdated = false;
+	}
+	}
+	
+	pConditionFileLayouts.notify_all();
+}
+
+void derlServer::InvalidateFileLayouts(){
+	const std::lock_guard guard(pMutexFileLayouts);
+	std::unordered_map<int, FileLayoutSnapshot>::iterator iter;
+	for(iter=pFileLayouts.begin(); iter!=pFileLayouts.end(); iter++){
+		FileLayoutSnapshot &snapshot = iter->second;
+		if(snapshot.building || snapshot.waiting > 0){
+			// hand out to waiting clients but do not keep it
+			snapshot.outdated = true;
+			
+		}else{
+			snapshot.layout = nullptr;
+		}
+	}
+}
+
 bool derlServer::IsListening() const{
 	return pServer->IsListening();
 }
@@ -73,6 +193,22 @@ void derlServer::ListenOn(const std::string &address){
 		throw std::invalid_argument("data directory path is empty");
 	}
 	
+	if(pEnableFileWatcher && !pFileWatcher && derlFileWatcher::IsSupported()){
+		try{
+			pFileWatcher = std::make_unique<derlFileWatcher>(pPathDataDir);
+			
+			// changes done while not watching are unknown
+			InvalidateFileLayouts();
+			
+		}catch(const std::exception &e){
+			if(GetLogger()){
+				std::stringstream ss;
+				ss << "[derlServer::ListenOn] Start file watcher failed: " << e.what();
+				GetLogger()->Log(denLogger::LogSeverity::error, ss.str());
+			}
+		}
+	}
+	
 	const std::lock_guard guard(derlGlobal::mutexNetwork);
 	pServer->ListenOn(address);
 }
@@ -96,6 +232,8 @@ void derlServer::WaitAllClientsDisconnected(){
 }
 
 void derlServer::Update(float elapsed){
+	pUpdateFileWatcher();
+	
 	{
 	const std::lock_guard guard(derlGlobal::mutexNetwork);
 	pServer->Update(elapsed);
@@ -118,3 +256,36 @@ void derlServer::Update(float elapsed){
 // Events
 ///////////
 
+
+
+// Private Functions
+//////////////////////
+
+void derlServer::pUpdateFileWatcher(){
+	if(!pFileWatcher){
+		return;
+	}
+	
+	derlFileWatcher::SetPath paths;
+	if(!pFileWatcher->Poll(paths)){
+		InvalidateFileLayouts();
+		return;
+	}
+	
+	// saving the hash cache is not a change of the data directory
+	std::filesystem::path pathHashCacheTemp(pPathHashCache);
+	pathHashCacheTemp += ".tmp";
+	
+	for(const std::string &path : paths){
+		const std::filesystem::path fullPath(pPathDataDir / path);
+		if(pPathHashCache.empty() || (fullPath != pPathHashCache && fullPath != pathHashCacheTemp)){
+			InvalidateFileLayouts();
+			return;
+		}
+	}
+}
+
+int derlServer::pFileLayoutKey(derlHasher::Algorithm algorithm, bool treeHash){
+	return ((int)algorithm << 1) | (treeHash ? 1 : 0);
+}
+
@@ -31,7 +31,14 @@
 #include <thread>
 #include <filesystem>
 #include <atomic>
+#include <unordered_map>
+#include <condition_variable>
 
+#include "derlBlockSizePolicy.h"
+#include "derlHashCache.h"
+#include "derlHasher.h"
+#include "derlFileLayout.h"
+#include "derlFileWatcher.h"
 #include "derlRemoteClient.h"
 #include "internal/derlRemoteClientConnection.h"
 #include <denetwork/denConnection.h>
@@ -52,12 +59,34 @@ public:
 	
 	
 private:
+	/** \brief Shared file layout snapshot. */
+	struct FileLayoutSnapshot{
+		derlFileLayout::Ref layout;
+		bool building = false;
+		bool outdated = false;
+		int waiting = 0;
+	};
+	
 	std::unique_ptr<derlServerServer> pServer;
 	
 	std::filesystem::path pPathDataDir;
+	bool pEnableFastHash;
+	derlBlockSizePolicy::Ref pBlockSizePolicy;
+	bool pEnableRollingDelta;
+	uint32_t pContentChunkSize;
+	bool pEnableCompression;
+	uint32_t pMaxBundleFileSize;
+	std::filesystem::path pPathHashCache;
+	derlHashCache::Ref pHashCache;
+	bool pEnableFileWatcher;
+	derlFileWatcher::Ref pFileWatcher;
 	
 	derlRemoteClient::List pClients;
 	
+	std::unordered_map<int, FileLayoutSnapshot> pFileLayouts;
+	std::mutex pMutexFileLayouts;
+	std::condition_variable pConditionFileLayouts;
+	
 	std::mutex pMutex;
 	
 	
@@ -86,6 +115,127 @@ public:
 	 */
 	void SetPathDataDir(const std::filesystem::path &path);
 	
+	/** \brief Use fast hash algorithm if supported by client. */
+	inline bool GetEnableFastHash() const{ return pEnableFastHash; }
+	
+	/**
+	 * \brief Set to use fast hash algorithm if supported by client.
+	 * 
+	 * If enabled XXH3-128 is used instead of SHA-256 for file and block hashes.
+	 * This is faster but only suitable for trusted networks. Disabled by default.
+	 * Change takes effect for clients connecting afterwards.
+	 */
+	void SetEnableFastHash(bool enable);
+	
+	/** \brief Use rolling checksum deltas for files with changed size if supported by client. */
+	inline bool GetEnableRollingDelta() const{ return pEnableRollingDelta; }
+	
+	/**
+	 * \brief Set to use rolling checksum deltas for files with changed size if supported by client.
+	 * 
+	 * If enabled the client sends weak rolling checksums with block hashes of files with
+	 * changed size. The server searches client blocks at any offset in the server file
+	 * and sends only data not found in the client file. This reduces the transferred data
+	 * if content has been inserted or removed but requires the server to scan the files.
+	 * Disabled by default. Change takes effect for clients connecting afterwards.
+	 */
+	void SetEnableRollingDelta(bool enable);
+	
+	/** \brief Average content defined chunk size or 0 if disabled. */
+	inline uint32_t GetContentChunkSize() const{ return pContentChunkSize; }
+	
+	/**
+	 * \brief Set average content defined chunk size or 0 to disable.
+	 * 
+	 * If enabled files with changed size are compared using content defined chunks
+	 * calculated by server and client (see derlFastCdc). Chunks present anywhere in the
+	 * client file are copied by the client and only other chunks are send. Unlike
+	 * rolling checksum deltas no byte wise scan of the server file is required.
+	 * Takes precedence over rolling checksum deltas. Size is rounded down to a power of
+	 * two. derlFastCdc::DefaultAverageSize is a good choice. Disabled by default.
+	 * Change takes effect for clients connecting afterwards.
+	 */
+	void SetContentChunkSize(uint32_t size);
+	
+	/** \brief Compress file data if supported by client. */
+	inline bool GetEnableCompression() const{ return pEnableCompression; }
+	
+	/**
+	 * \brief Set to compress file data if supported by client.
+	 * 
+	 * If enabled file data blocks are compressed using LZ4 (see derlLz4) before sending.
+	 * Blocks not compressing well and files with an extension of an already compressed
+	 * file format are send uncompressed. Reduces the transferred data for clients with
+	 * low bandwidth connections at the cost of processing time on both sides.
+	 * Disabled by default. Change takes effect for clients connecting afterwards.
+	 */
+	void SetEnableCompression(bool enable);
+	
+	/** \brief Maximum size of files written using file bundles or 0 if disabled. */
+	inline uint32_t GetMaxBundleFileSize() const{ return pMaxBundleFileSize; }
+	
+	/**
+	 * \brief Set maximum size of files written using file bundles or 0 to disable.
+	 * 
+	 * Files up to this size are send together with other small files in one message
+	 * if supported by client. The client writes and verifies all files of the bundle
+	 * and answers with one message. This avoids the round trips of writing files
+	 * individually which dominate synchronizing many small files. Default is 64 KiB.
+	 * Change takes effect for clients connecting afterwards.
+	 */
+	void SetMaxBundleFileSize(uint32_t size);
+	
+	/** \brief Policy selecting the block size of files. */
+	inline const derlBlockSizePolicy::Ref &GetBlockSizePolicy() const{ return pBlockSizePolicy; }
+	
+	/**
+	 * \brief Set policy selecting the block size of files.
+	 * 
+	 * Server and client should use the same policy. Otherwise block hashes have to be
+	 * requested for all differing files. Block size used for each file is stored in the
+	 * file layout. If nullptr is set the default policy is used.
+	 * 
+	 * \throws std::invalid_argument Server is listening.
+	 */
+	void SetBlockSizePolicy(const derlBlockSizePolicy::Ref &policy);
+	
+	/** \brief Path to hash cache file or empty path if disabled. */
+	inline const std::filesystem::path &GetPathHashCache() const{ return pPathHashCache; }
+	
+	/**
+	 * \brief Set path to hash cache file or empty path to disable.
+	 * 
+	 * The hash cache stores file and block hashes across runs. Files with unchanged
+	 * size, modification time and inode are not hashed again while building the file
+	 * layout. The file can be located inside the data directory in which case it is
+	 * excluded from the file layout. Disabled by default.
+	 * 
+	 * \throws std::invalid_argument Server is listening.
+	 */
+	void SetPathHashCache(const std::filesystem::path &path);
+	
+	/** \brief Hash cache or nullptr if disabled. */
+	inline const derlHashCache::Ref &GetHashCache() const{ return pHashCache; }
+	
+	/** \brief Watch data directory for changes to keep shared file layouts. */
+	inline bool GetEnableFileWatcher() const{ return pEnableFileWatcher; }
+	
+	/**
+	 * \brief Set to watch data directory for changes to keep shared file layouts.
+	 * 
+	 * If enabled shared file layouts are reused by all client synchronizations until
+	 * the data directory changes. If disabled or file watching is not supported by the
+	 * platform shared file layouts are only reused by synchronizations waiting for the
+	 * same file layout to be build. The watcher is started while starting listening.
+	 * Disabled by default.
+	 * 
+	 * \throws std::invalid_argument Server is listening.
+	 */
+	void SetEnableFileWatcher(bool enable);
+	
+	/** \brief File watcher is running. */
+	inline bool IsFileWatcherRunning() const{ return pFileWatcher != nullptr; }
+	
 	/** \brief Logger or null. */
 	const denLogger::Ref &GetLogger() const;
 	
@@ -106,6 +256,36 @@ public:
 	
 	
 	
+	/**
+	 * \brief Acquire shared server file layout.
+	 * 
+	 * File layouts are shared by all clients using the same hash algorithm and tree hash
+	 * setting. If the file layout is build by another task processor waits for it to be
+	 * finished. Shared file layouts must not be modified.
+	 * 
+	 * \returns Shared file layout or nullptr if the caller has to build the file layout
+	 *          and call FinishFileLayout() afterwards, also if building failed.
+	 */
+	derlFileLayout::Ref AcquireFileLayout(derlHasher::Algorithm algorithm, bool treeHash);
+	
+	/**
+	 * \brief Finish building file layout after AcquireFileLayout() returned nullptr.
+	 * 
+	 * Set layout to nullptr if building failed.
+	 */
+	void FinishFileLayout(derlHasher::Algorithm algorithm, bool treeHash,
+		const derlFileLayout::Ref &layout);
+	
+	/**
+	 * \brief Drop shared file layouts.
+	 * 
+	 * Call if data directory content changed while the file watcher is not running.
+	 * File layouts in use by clients stay valid.
+	 */
+	void InvalidateFileLayouts();
+	
+	
+	
 	/** \brief Server is listening. */
 	bool IsListening() const;
 	
@@ -152,6 +332,12 @@ public:
 	/** \name Events */
 	/*@{*/
 	/*@}*/
+	
+	
+	
+private:
+	void pUpdateFileWatcher();
+	static int pFileLayoutKey(derlHasher::Algorithm algorithm, bool treeHash);
 };
 
 #endif
@@ -0,0 +1,68 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _DERLTRANSFERORDERPOLICY_H_
+#define _DERLTRANSFERORDERPOLICY_H_
+
+#include <memory>
+
+#include "task/derlTaskFileWrite.h"
+
+
+/**
+ * \brief Transfer order policy ordering the files written while synchronizing.
+ * 
+ * Files are started in the order of the ready queue build using this policy. Blocks
+ * are send in file order. Default implementation orders files by path. Files in the
+ * same directory are written after each other resulting in mostly sequential disk
+ * access on both sides.
+ * 
+ * Policies are shared across task processors. Configure the policy before assigning it.
+ */
+class derlTransferOrderPolicy{
+public:
+	/** \brief Reference type. */
+	typedef std::shared_ptr<derlTransferOrderPolicy> Ref;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create transfer order policy. */
+	derlTransferOrderPolicy();
+	
+	/** \brief Clean up transfer order policy. */
+	virtual ~derlTransferOrderPolicy();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Order write file tasks in the order they should be written. */
+	virtual void Order(derlTaskFileWrite::List &tasks) const;
+	/*@}*/
+};
+
+#endif
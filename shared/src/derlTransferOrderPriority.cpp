@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <algorithm>
+#include <unordered_map>
+
+#include "derlTransferOrderPriority.h"
+
+
+// Class derlTransferOrderPriority
+////////////////////////////////////
+
+derlTransferOrderPriority::derlTransferOrderPriority(){
+}
+
+derlTransferOrderPriority::derlTransferOrderPriority(const std::vector<std::string> &paths) :
+pPaths(paths){
+}
+
+
+// Management
+///////////////
+
+void derlTransferOrderPriority::SetPaths(const std::vector<std::string> &paths){
+	pPaths = paths;
+}
+
+void derlTransferOrderPriority::Order(derlTaskFileWrite::List &tasks) const{
+	// find priority once per file instead of once per comparison
+	std::unordered_map<const derlTaskFileWrite*, int> priorities;
+	for(const derlTaskFileWrite::Ref &task : tasks){
+		priorities[task.get()] = GetPriority(task->GetPath());
+	}
+	
+	std::sort(tasks.begin(), tasks.end(), [&priorities](
+	const derlTaskFileWrite::Ref &a, const derlTaskFileWrite::Ref &b){
+		const int priorityA = priorities.at(a.get());
+		const int priorityB = priorities.at(b.get());
+		if(priorityA != priorityB){
+			return priorityA < priorityB;
+		}
+		return a->GetPath() < b->GetPath();
+	});
+}
+
+int derlTransferOrderPriority::GetPriority(const std::string &path) const{
+	const int count = (int)pPaths.size();
+	int i;
+	
+	for(i=0; i<count; i++){
+		const std::string &entry = pPaths.at(i);
+		if(path == entry){
+			return i;
+		}
+		
+		const std::string::size_type length = entry.size();
+		if(length > 0 && path.size() > length && path.compare(0, length, entry) == 0
+		&& (entry.back() == '/' || path.at(length) == '/')){
+			return i;
+		}
+	}
+	
+	return count;
+}
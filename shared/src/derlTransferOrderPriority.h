@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _DERLTRANSFERORDERPRIORITY_H_
+#define _DERLTRANSFERORDERPRIORITY_H_
+
+#include <string>
+#include <vector>
+
+#include "derlTransferOrderPolicy.h"
+
+
+/**
+ * \brief Transfer order policy writing files in the order of a priority list.
+ * 
+ * Priority list contains file paths or directory paths. Files matching an entry are
+ * written before files matching later entries. Directory entries match all files
+ * inside the directory. Files matching multiple entries use the first entry. Files
+ * matching the same entry and files not matching any entry are ordered by path.
+ * Files not matching any entry are written last.
+ */
+class derlTransferOrderPriority : public derlTransferOrderPolicy{
+private:
+	std::vector<std::string> pPaths;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create transfer order policy. */
+	derlTransferOrderPriority();
+	
+	/** \brief Create transfer order policy. */
+	derlTransferOrderPriority(const std::vector<std::string> &paths);
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Priority list of file or directory paths. */
+	inline const std::vector<std::string> &GetPaths() const{ return pPaths; }
+	void SetPaths(const std::vector<std::string> &paths);
+	
+	/** \brief Order write file tasks in the order they should be written. */
+	void Order(derlTaskFileWrite::List &tasks) const override;
+	
+	/** \brief Index of first priority list entry matching path or list size if not matching. */
+	int GetPriority(const std::string &path) const;
+	/*@}*/
+};
+
+#endif
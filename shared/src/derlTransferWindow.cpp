@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <algorithm>
+
+#include "derlTransferWindow.h"
+
+
+// Class derlTransferWindow
+/////////////////////////////
+
+derlTransferWindow::derlTransferWindow() :
+pWindowSize(InitialWindowSize),
+pRoundTripTime(0),
+pBandwidth(0),
+pInProgressSize(0),
+pMemoryLimit(DefaultMemoryLimit),
+pMaxInProgressFiles(0),
+pMaxInProgressBlocks(0),
+pSentCount(0),
+pDelivered(0),
+pDeliveredTime(Clock::now()),
+pRoundTripTimeUpdate(Clock::now()),
+pBandwidthSamples{},
+pNextBandwidthSample(0){
+}
+
+
+// Overrides
+//////////////
+
+void derlTransferWindow::SetMemoryLimit(uint64_t limit){
+	pMemoryLimit = limit;
+}
+
+void derlTransferWindow::SetMaxInProgressFiles(int count){
+	pMaxInProgressFiles = std::max(count, 0);
+}
+
+void derlTransferWindow::SetMaxInProgressBlocks(int count){
+	pMaxInProgressBlocks = std::max(count, 0);
+}
+
+
+// Control
+////////////
+
+bool derlTransferWindow::CanStartFile(int countInProgressFiles) const{
+	if(pMaxInProgressFiles > 0){
+		return countInProgressFiles < pMaxInProgressFiles;
+	}
+	
+	return countInProgressFiles == 0 || (countInProgressFiles < MaxAdaptiveFiles
+		&& pInProgressSize < std::min((uint64_t)pWindowSize, (uint64_t)pMemoryLimit));
+}
+
+bool derlTransferWindow::CanStartBlock(int countInProgressBlocks, uint64_t size) const{
+	if(countInProgressBlocks == 0){
+		return true;
+	}
+	
+	if(pMaxInProgressBlocks > 0){
+		return countInProgressBlocks < pMaxInProgressBlocks && pInProgressSize + size <= pMemoryLimit;
+	}
+	
+	return pInProgressSize + size <= std::min((uint64_t)pWindowSize, (uint64_t)pMemoryLimit);
+}
+
+void derlTransferWindow::BlockStarted(uint64_t size){
+	pInProgressSize += size;
+}
+
+derlTransferWindow::SendState derlTransferWindow::BlockSent(){
+	const Clock::time_point now(Clock::now());
+	
+	// restarting after being idle. the idle time is not part of the delivery rate
+	if(pSentCount == 0){
+		pDeliveredTime = now;
+	}
+	pSentCount++;
+	
+	SendState state;
+	state.sendTime = now;
+	state.deliveredTime = pDeliveredTime;
+	state.delivered = pDelivered;
+	return state;
+}
+
+void derlTransferWindow::BlockAcknowledged(uint64_t size, const SendState &state){
+	const Clock::time_point now(Clock::now());
+	
+	pInProgressSize -= std::min(size, (uint64_t)pInProgressSize);
+	if(pSentCount > 0){
+		pSentCount--;
+	}
+	
+	pDelivered += size;
+	pDeliveredTime = now;
+	
+	// minimum round trip time expires after 10 seconds to adapt to route changes
+	const uint64_t roundTripTime = (uint64_t)std::max(std::chrono::duration_cast<
+		std::chrono::microseconds>(now - state.sendTime).count(), (int64_t)1);
+	if(pRoundTripTime == 0 || roundTripTime <= pRoundTripTime
+	|| now - pRoundTripTimeUpdate > std::chrono::seconds(10)){
+		pRoundTripTime = roundTripTime;
+		pRoundTripTimeUpdate = now;
+	}
+	
+	// delivery rate is the data acknowledged since the block has been sent
+	const int64_t interval = std::chrono::duration_cast<std::chrono::microseconds>(
+		now - state.deliveredTime).count();
+	if(interval > 0){
+		pBandwidthSamples[pNextBandwidthSample] =
+			(pDelivered - state.delivered) * 1000000 / (uint64_t)interval;
+		pNextBandwidthSample = (pNextBandwidthSample + 1) % pBandwidthSampleCount;
+		pBandwidth = *std::max_element(pBandwidthSamples, pBandwidthSamples + pBandwidthSampleCount);
+	}
+	
+	const uint64_t bdp = pBandwidth * pRoundTripTime / 1000000;
+	pWindowSize = std::min(std::max(bdp * 2, MinWindowSize), (uint64_t)pMemoryLimit);
+}
+
+void derlTransferWindow::Reset(){
+	pInProgressSize = 0;
+	pSentCount = 0;
+}
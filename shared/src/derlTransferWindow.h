@@ -0,0 +1,181 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _DERLTRANSFERWINDOW_H_
+#define _DERLTRANSFERWINDOW_H_
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+
+/**
+ * \brief Adaptive window limiting the file data in progress while writing files.
+ * 
+ * Measures the round trip time and delivery rate of file data blocks from sending a
+ * block until the client acknowledges it. The window is twice the bandwidth-delay
+ * product of the minimum round trip time and the maximum recent delivery rate, similar
+ * to BBR. While the link is not saturated the measured delivery rate grows with the
+ * window doubling the window each round trip. Once saturated the window settles.
+ * The window is clamped to a memory limit since data in progress is held in memory.
+ * 
+ * Maximum files and blocks in progress can be overridden with fixed values.
+ * 
+ * Live values can be read from any thread. All other methods have to be called while
+ * holding the mutex of the synchronize task.
+ */
+class derlTransferWindow{
+public:
+	/** \brief Clock type. */
+	typedef std::chrono::steady_clock Clock;
+	
+	/** \brief Delivery state when a block has been sent. */
+	struct SendState{
+		Clock::time_point sendTime;
+		Clock::time_point deliveredTime;
+		uint64_t delivered;
+	};
+	
+	/** \brief Default memory limit in bytes. */
+	static const uint64_t DefaultMemoryLimit = 64 * 1024 * 1024;
+	
+	/** \brief Initial window size in bytes. */
+	static const uint64_t InitialWindowSize = 1024 * 1024;
+	
+	/** \brief Minimum window size in bytes. */
+	static const uint64_t MinWindowSize = 512 * 1024;
+	
+	/** \brief Maximum count of files in progress if not overridden. */
+	static const int MaxAdaptiveFiles = 32;
+	
+	
+	
+private:
+	static const int pBandwidthSampleCount = 16;
+	
+	std::atomic<uint64_t> pWindowSize;
+	std::atomic<uint64_t> pRoundTripTime;
+	std::atomic<uint64_t> pBandwidth;
+	std::atomic<uint64_t> pInProgressSize;
+	std::atomic<uint64_t> pMemoryLimit;
+	std::atomic<int> pMaxInProgressFiles;
+	std::atomic<int> pMaxInProgressBlocks;
+	
+	int pSentCount;
+	uint64_t pDelivered;
+	Clock::time_point pDeliveredTime;
+	Clock::time_point pRoundTripTimeUpdate;
+	uint64_t pBandwidthSamples[pBandwidthSampleCount];
+	int pNextBandwidthSample;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create transfer window. */
+	derlTransferWindow();
+	/*@}*/
+	
+	
+	
+	/** \name Live values */
+	/*@{*/
+	/** \brief Window size in bytes. */
+	inline uint64_t GetWindowSize() const{ return pWindowSize; }
+	
+	/** \brief Minimum round trip time in microseconds or 0 if not measured yet. */
+	inline uint64_t GetRoundTripTime() const{ return pRoundTripTime; }
+	
+	/** \brief Delivery rate in bytes per second or 0 if not measured yet. */
+	inline uint64_t GetBandwidth() const{ return pBandwidth; }
+	
+	/** \brief Size of blocks in progress in bytes. */
+	inline uint64_t GetInProgressSize() const{ return pInProgressSize; }
+	/*@}*/
+	
+	
+	
+	/** \name Overrides */
+	/*@{*/
+	/** \brief Maximum size of blocks in progress in bytes. */
+	inline uint64_t GetMemoryLimit() const{ return pMemoryLimit; }
+	
+	/**
+	 * \brief Set maximum size of blocks in progress in bytes.
+	 * 
+	 * One block is always allowed to be in progress even if larger than the limit.
+	 */
+	void SetMemoryLimit(uint64_t limit);
+	
+	/** \brief Maximum count of files in progress or 0 if adaptive. */
+	inline int GetMaxInProgressFiles() const{ return pMaxInProgressFiles; }
+	
+	/** \brief Set maximum count of files in progress or 0 to use adaptive value. */
+	void SetMaxInProgressFiles(int count);
+	
+	/** \brief Maximum count of blocks in progress or 0 if adaptive. */
+	inline int GetMaxInProgressBlocks() const{ return pMaxInProgressBlocks; }
+	
+	/**
+	 * \brief Set maximum count of blocks in progress or 0 to use adaptive value.
+	 * 
+	 * If set the window size is ignored but the memory limit still applies.
+	 */
+	void SetMaxInProgressBlocks(int count);
+	/*@}*/
+	
+	
+	
+	/** \name Control */
+	/*@{*/
+	/**
+	 * \brief Writing another file can be started.
+	 * 
+	 * Adaptive files are started while the window is not filled by blocks in progress.
+	 */
+	bool CanStartFile(int countInProgressFiles) const;
+	
+	/** \brief Block with size can be started. */
+	bool CanStartBlock(int countInProgressBlocks, uint64_t size) const;
+	
+	/** \brief Block with size has been started. */
+	void BlockStarted(uint64_t size);
+	
+	/** \brief Block has been sent. Store returned state with block. */
+	SendState BlockSent();
+	
+	/** \brief Block with size has been acknowledged. Updates the window. */
+	void BlockAcknowledged(uint64_t size, const SendState &state);
+	
+	/**
+	 * \brief Reset blocks in progress.
+	 * 
+	 * Blocks in progress of a failed synchronization are never acknowledged. Measured
+	 * round trip time, delivery rate and window size are kept.
+	 */
+	void Reset();
+	/*@}*/
+};
+
+#endif
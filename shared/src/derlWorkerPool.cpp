@@ -0,0 +1,116 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdexcept>
+
+#include "derlWorkerPool.h"
+
+
+// Class derlWorkerPool
+/////////////////////////
+
+derlWorkerPool::derlWorkerPool(int threadCount) :
+pCountPending(0),
+pFailed(false),
+pExit(false)
+{
+	int i;
+	for(i=0; i<threadCount; i++){
+		pThreads.emplace_back(&derlWorkerPool::pRunWorker, this);
+	}
+}
+
+derlWorkerPool::~derlWorkerPool() noexcept{
+	{
+	const std::lock_guard guard(pMutex);
+	pExit = true;
+	}
+	pConditionJobs.notify_all();
+	
+	for(std::thread &thread : pThreads){
+		thread.join();
+	}
+}
+
+
+// Management
+///////////////
+
+void derlWorkerPool::Add(const Job &job){
+	{
+	const std::lock_guard guard(pMutex);
+	pJobs.push_back(job);
+	pCountPending++;
+	}
+	pConditionJobs.notify_one();
+}
+
+void derlWorkerPool::WaitPendingBelow(int count){
+	std::unique_lock guard(pMutex);
+	pConditionDone.wait(guard, [&]{ return pCountPending < count; });
+}
+
+void derlWorkerPool::WaitAll(){
+	std::unique_lock guard(pMutex);
+	pConditionDone.wait(guard, [&]{ return pCountPending == 0; });
+	
+	if(pFailed){
+		pFailed = false;
+		throw std::runtime_error("worker job failed");
+	}
+}
+
+
+// Private Functions
+//////////////////////
+
+void derlWorkerPool::pRunWorker(){
+	std::unique_lock guard(pMutex);
+	
+	while(true){
+		pConditionJobs.wait(guard, [&]{ return pExit || !pJobs.empty(); });
+		if(pJobs.empty()){
+			return; // exit requested and all jobs done
+		}
+		
+		const Job job(pJobs.front());
+		pJobs.pop_front();
+		
+		guard.unlock();
+		bool failed = false;
+		try{
+			job();
+			
+		}catch(...){
+			failed = true;
+		}
+		guard.lock();
+		
+		if(failed){
+			pFailed = true;
+		}
+		pCountPending--;
+		pConditionDone.notify_all();
+	}
+}
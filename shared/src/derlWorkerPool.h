@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLWORKERPOOL_H_
+#define _DERLWORKERPOOL_H_
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+
+/**
+ * \brief Pool of worker threads running jobs.
+ * 
+ * Used by task processors to spread CPU heavy work like hashing across cores.
+ * Jobs must not throw exceptions. Failing jobs are reported by WaitAll().
+ */
+class derlWorkerPool{
+public:
+	/** \brief Reference type. */
+	typedef std::unique_ptr<derlWorkerPool> Ref;
+	
+	/** \brief Job. */
+	typedef std::function<void()> Job;
+	
+	
+private:
+	std::vector<std::thread> pThreads;
+	std::deque<Job> pJobs;
+	int pCountPending;
+	bool pFailed;
+	bool pExit;
+	std::mutex pMutex;
+	std::condition_variable pConditionJobs;
+	std::condition_variable pConditionDone;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create worker pool with count threads. */
+	derlWorkerPool(int threadCount);
+	
+	/** \brief Clean up worker pool. Waits for running jobs to finish. */
+	~derlWorkerPool() noexcept;
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Count of worker threads. */
+	inline int GetThreadCount() const{ return (int)pThreads.size(); }
+	
+	/** \brief Add job. */
+	void Add(const Job &job);
+	
+	/** \brief Wait until less than count jobs are queued or running. */
+	void WaitPendingBelow(int count);
+	
+	/**
+	 * \brief Wait until all jobs finished.
+	 * \throws std::runtime_error One or more jobs failed since the last call.
+	 */
+	void WaitAll();
+	/*@}*/
+	
+	
+	
+private:
+	void pRunWorker();
+};
+
+#endif
@@ -0,0 +1,307 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <chrono>
+
+#include "derlWriteJournal.h"
+
+
+// Journal file format. All values are little endian:
+// - char[6] signature "DERLWJ"
+// - uint8 version
+// - uint32 entry count
+// - entries:
+//   - uint16 path length, path bytes
+//   - uint64 file size, uint64 block size, int64 modification time
+//   - uint8 algorithm, file hash using the digest size of the algorithm
+//   - uint32 block count, block bitmap with bit 0 of the first byte being block 0
+
+namespace{
+
+const char vSignature[] = {'D', 'E', 'R', 'L', 'W', 'J'};
+const uint8_t vVersion = 1;
+
+// throttled saving writes the journal file after this many blocks marked written or
+// after this time elapsed since the last saving whatever comes first
+const int vSaveBlockCount = 64;
+const std::chrono::milliseconds vSaveInterval(2000);
+
+class cWriter{
+public:
+	std::string data;
+	
+	void WriteBytes(const void *bytes, size_t size){
+		data.append((const char*)bytes, size);
+	}
+	
+	void WriteUInt(uint64_t value, int size){
+		int i;
+		for(i=0; i<size; i++){
+			data.push_back((char)(uint8_t)(value >> (8 * i)));
+		}
+	}
+};
+
+class cReader{
+public:
+	const std::string &data;
+	size_t position;
+	
+	cReader(const std::string &adata) : data(adata), position(0){
+	}
+	
+	const uint8_t *ReadBytes(size_t size){
+		if(size > data.size() - position){
+			throw std::runtime_error("unexpected end of file");
+		}
+		const uint8_t * const bytes = (const uint8_t*)data.c_str() + position;
+		position += size;
+		return bytes;
+	}
+	
+	uint64_t ReadUInt(int size){
+		const uint8_t * const bytes = ReadBytes(size);
+		uint64_t value = 0;
+		int i;
+		for(i=0; i<size; i++){
+			value |= (uint64_t)bytes[i] << (8 * i);
+		}
+		return value;
+	}
+};
+
+}
+
+
+// Class derlWriteJournal
+///////////////////////////
+
+derlWriteJournal::derlWriteJournal(const std::filesystem::path &path) :
+pPath(path.lexically_normal()),
+pLoaded(false),
+pChanged(false),
+pUnsavedBlocks(0),
+pLastSave(std::chrono::steady_clock::now()){
+}
+
+
+// Management
+///////////////
+
+bool derlWriteJournal::Get(const std::string &path, Entry &entry){
+	const std::lock_guard guard(pMutex);
+	pLoad();
+	
+	const std::unordered_map<std::string, Entry>::const_iterator iter(pEntries.find(path));
+	if(iter == pEntries.cend()){
+		return false;
+	}
+	
+	entry = iter->second;
+	return true;
+}
+
+void derlWriteJournal::Set(const std::string &path, const Entry &entry){
+	const std::lock_guard guard(pMutex);
+	pLoad();
+	pEntries[path] = entry;
+	pChanged = true;
+}
+
+void derlWriteJournal::SetBlockWritten(const std::string &path, int index,
+const std::filesystem::path &filePath){
+	const std::lock_guard guard(pMutex);
+	pLoad();
+	
+	const std::unordered_map<std::string, Entry>::iterator iter(pEntries.find(path));
+	if(iter == pEntries.end()){
+		return;
+	}
+	
+	Entry &entry = iter->second;
+	if(index < 0 || index >= (int)entry.blocks.size()){
+		return;
+	}
+	
+	entry.blocks[index] = true;
+	entry.modificationTime = GetModificationTime(filePath);
+	pChanged = true;
+	pUnsavedBlocks++;
+}
+
+void derlWriteJournal::Remove(const std::string &path){
+	const std::lock_guard guard(pMutex);
+	pLoad();
+	
+	if(pEntries.erase(path) > 0){
+		pChanged = true;
+	}
+}
+
+void derlWriteJournal::Save(){
+	const std::lock_guard guard(pMutex);
+	pSave();
+}
+
+void derlWriteJournal::SaveThrottled(){
+	const std::lock_guard guard(pMutex);
+	if(pUnsavedBlocks < vSaveBlockCount
+	&& std::chrono::steady_clock::now() - pLastSave < vSaveInterval){
+		return;
+	}
+	pSave();
+}
+
+int64_t derlWriteJournal::GetModificationTime(const std::filesystem::path &path){
+	std::error_code error;
+	const std::filesystem::file_time_type time(std::filesystem::last_write_time(path, error));
+	if(error){
+		return 0;
+	}
+	return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+
+// Private Functions
+//////////////////////
+
+void derlWriteJournal::pLoad(){
+	if(pLoaded){
+		return;
+	}
+	pLoaded = true;
+	
+	std::ifstream stream(pPath, std::ios_base::binary);
+	if(!stream.is_open()){
+		return;
+	}
+	
+	const std::string data{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+	stream.close();
+	
+	try{
+		cReader reader(data);
+		if(memcmp(reader.ReadBytes(sizeof(vSignature)), vSignature, sizeof(vSignature)) != 0
+		|| reader.ReadUInt(1) != vVersion){
+			return;
+		}
+		
+		const uint32_t count = (uint32_t)reader.ReadUInt(4);
+		uint32_t i, j;
+		
+		for(i=0; i<count; i++){
+			const size_t pathLength = (size_t)reader.ReadUInt(2);
+			const std::string path((const char*)reader.ReadBytes(pathLength), pathLength);
+			
+			Entry entry;
+			entry.fileSize = reader.ReadUInt(8);
+			entry.blockSize = reader.ReadUInt(8);
+			entry.modificationTime = (int64_t)reader.ReadUInt(8);
+			
+			const uint8_t algorithm = (uint8_t)reader.ReadUInt(1);
+			if(algorithm > (uint8_t)derlHasher::Algorithm::xxh3){
+				throw std::runtime_error("invalid algorithm");
+			}
+			entry.algorithm = (derlHasher::Algorithm)algorithm;
+			
+			const int digestSize = derlHasher::DigestSize(entry.algorithm);
+			uint8_t bytes[derlDigest::Size] = {};
+			memcpy(bytes, reader.ReadBytes(digestSize), digestSize);
+			entry.hash = derlDigest(bytes);
+			
+			const uint32_t blockCount = (uint32_t)reader.ReadUInt(4);
+			const uint8_t * const bitmap = reader.ReadBytes((blockCount + 7) / 8);
+			entry.blocks.assign(blockCount, false);
+			for(j=0; j<blockCount; j++){
+				entry.blocks[j] = (bitmap[j / 8] & (1 << (j % 8))) != 0;
+			}
+			
+			pEntries[path] = entry;
+		}
+		
+	}catch(const std::exception &){
+		// damaged journal file. start with empty journal
+		pEntries.clear();
+	}
+}
+
+void derlWriteJournal::pSave(){
+	if(!pChanged){
+		return;
+	}
+	
+	cWriter writer;
+	writer.WriteBytes(vSignature, sizeof(vSignature));
+	writer.WriteUInt(vVersion, 1);
+	writer.WriteUInt(pEntries.size(), 4);
+	
+	for(const std::pair<const std::string, Entry> &each : pEntries){
+		const Entry &entry = each.second;
+		const size_t blockCount = entry.blocks.size();
+		size_t i;
+		
+		writer.WriteUInt(each.first.size(), 2);
+		writer.WriteBytes(each.first.c_str(), each.first.size());
+		writer.WriteUInt(entry.fileSize, 8);
+		writer.WriteUInt(entry.blockSize, 8);
+		writer.WriteUInt((uint64_t)entry.modificationTime, 8);
+		writer.WriteUInt((uint8_t)entry.algorithm, 1);
+		writer.WriteBytes(entry.hash.GetBytes(), derlHasher::DigestSize(entry.algorithm));
+		writer.WriteUInt(blockCount, 4);
+		
+		std::string bitmap((blockCount + 7) / 8, 0);
+		for(i=0; i<blockCount; i++){
+			if(entry.blocks[i]){
+				bitmap[i / 8] |= (char)(1 << (i % 8));
+			}
+		}
+		writer.WriteBytes(bitmap.c_str(), bitmap.size());
+	}
+	
+	// write to temporary file first then replace journal file. this avoids leaving behind
+	// a truncated journal file if the application is terminated while saving
+	std::filesystem::path pathTemp(pPath);
+	pathTemp += ".tmp";
+	
+	if(pPath.has_parent_path()){
+		std::filesystem::create_directories(pPath.parent_path());
+	}
+	
+	{
+	std::ofstream stream(pathTemp, std::ios_base::binary | std::ios_base::trunc);
+	stream.write(writer.data.c_str(), writer.data.size());
+	stream.close();
+	if(stream.fail()){
+		throw std::runtime_error("failed writing write journal file");
+	}
+	}
+	
+	std::filesystem::rename(pathTemp, pPath);
+	pChanged = false;
+	pUnsavedBlocks = 0;
+	pLastSave = std::chrono::steady_clock::now();
+}
@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _DERLWRITEJOURNAL_H_
+#define _DERLWRITEJOURNAL_H_
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+
+#include "derlDigest.h"
+#include "derlHasher.h"
+
+
+/**
+ * \brief Persistent journal of files being written.
+ * 
+ * Stores for each file being written the target hash, size and block size together with
+ * a bitmap of blocks written so far. If writing a file is interrupted, for example by a
+ * dropped connection, the next write request of the same target continues with the
+ * missing blocks instead of starting over. The modification time of the file present
+ * after the last written block is stored to detect files modified by others.
+ * 
+ * The bitmap records blocks written to disk, not blocks verified against their hash.
+ * Resumed files are verified as a whole by the file hash once all blocks are written.
+ * 
+ * The journal is loaded lazily from a compact binary file the first time it is accessed
+ * and written back by Save(). A missing, outdated or damaged journal file results in an
+ * empty journal. Instances are thread safe and can be shared across task processors.
+ */
+class derlWriteJournal{
+public:
+	/** \brief Reference type. */
+	typedef std::shared_ptr<derlWriteJournal> Ref;
+	
+	/** \brief Journal entry. */
+	struct Entry{
+		/** \brief Target file size in bytes. */
+		uint64_t fileSize;
+		
+		/** \brief Block size. */
+		uint64_t blockSize;
+		
+		/** \brief Hash algorithm used for target hash. */
+		derlHasher::Algorithm algorithm;
+		
+		/** \brief Target file hash. */
+		derlDigest hash;
+		
+		/** \brief File modification time after writing the last block. */
+		int64_t modificationTime;
+		
+		/** \brief Blocks written so far. */
+		std::vector<bool> blocks;
+	};
+	
+	
+private:
+	const std::filesystem::path pPath;
+	std::unordered_map<std::string, Entry> pEntries;
+	bool pLoaded;
+	bool pChanged;
+	int pUnsavedBlocks;
+	std::chrono::steady_clock::time_point pLastSave;
+	std::mutex pMutex;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create write journal stored in file at path. */
+	derlWriteJournal(const std::filesystem::path &path);
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Path of journal file. */
+	inline const std::filesystem::path &GetPath() const{ return pPath; }
+	
+	/** \brief Get entry for file path if present. */
+	bool Get(const std::string &path, Entry &entry);
+	
+	/** \brief Set entry for file path. */
+	void Set(const std::string &path, const Entry &entry);
+	
+	/**
+	 * \brief Mark block written if entry is present.
+	 * 
+	 * Stores the modification time of the file at filePath while holding the lock.
+	 * Concurrent writes of other blocks are thus included in the stored time.
+	 */
+	void SetBlockWritten(const std::string &path, int index, const std::filesystem::path &filePath);
+	
+	/** \brief Remove entry for file path if present. */
+	void Remove(const std::string &path);
+	
+	/**
+	 * \brief Write journal file if entries changed since loading or last saving.
+	 * \throws std::runtime_error Writing journal file failed.
+	 */
+	void Save();
+	
+	/**
+	 * \brief Write journal file if enough blocks have been marked written or enough time
+	 *        elapsed since last saving.
+	 * 
+	 * Used while writing blocks to avoid serializing the entire journal for each block.
+	 * If the application terminates before saving the modification time stored in the
+	 * journal file does not match anymore and the file is written from the start.
+	 * \throws std::runtime_error Writing journal file failed.
+	 */
+	void SaveThrottled();
+	
+	/** \brief Modification time of file or 0 if not found. */
+	static int64_t GetModificationTime(const std::filesystem::path &path);
+	/*@}*/
+	
+	
+	
+private:
+	void pLoad();
+	void pSave();
+};
+
+#endif
@@ -11,12 +11,39 @@
 #include <endian.h>
 #endif
 
+// hardware accelerated block processing. the kernel functions are compiled with the
+// required instruction set enabled and are only called if the CPU supports them
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SHA256_WITH_SHANI
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SHA256_TARGET_SHANI
+#else
+#include <cpuid.h>
+#define SHA256_TARGET_SHANI __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+#endif
 
-/// same as reset()
-SHA256::SHA256()
-{
-  reset();
-}
+#if (defined(__aarch64__) || defined(_M_ARM64)) && !defined(__AARCH64EB__)
+#define SHA256_WITH_ARMV8
+#include <arm_neon.h>
+#if defined(_MSC_VER) || defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO)
+#define SHA256_TARGET_ARMV8
+#elif defined(__clang__)
+#define SHA256_TARGET_ARMV8 __attribute__((target("crypto")))
+#else
+#define SHA256_TARGET_ARMV8 __attribute__((target("+crypto")))
+#endif
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_SHA2
+#define HWCAP_SHA2 (1 << 6)
+#endif
+#endif
+#endif
 
 
 /// restart
@@ -73,167 +100,445 @@ namespace
     uint32_t term2 = ((a | b) & c) | (a & b); //(a & (b ^ c)) ^ (b & c);
     return term1 + term2;
   }
+
+
+  /// process 64 bytes, portable implementation
+  void processBlockScalar(uint32_t* hash, const void* data)
+  {
+    // get last hash
+    uint32_t a = hash[0];
+    uint32_t b = hash[1];
+    uint32_t c = hash[2];
+    uint32_t d = hash[3];
+    uint32_t e = hash[4];
+    uint32_t f = hash[5];
+    uint32_t g = hash[6];
+    uint32_t h = hash[7];
+
+    // data represented as 16x 32-bit words
+    const uint32_t* input = (uint32_t*) data;
+    // convert to big endian
+    uint32_t words[64];
+    int i;
+    for (i = 0; i < 16; i++)
+#if defined(__BYTE_ORDER) && (__BYTE_ORDER != 0) && (__BYTE_ORDER == __BIG_ENDIAN)
+      words[i] =      input[i];
+#else
+      words[i] = swap(input[i]);
+#endif
+
+    uint32_t x,y; // temporaries
+
+    // first round
+    x = h + f1(e,f,g) + 0x428a2f98 + words[ 0]; y = f2(a,b,c); d += x; h = x + y;
+    x = g + f1(d,e,f) + 0x71374491 + words[ 1]; y = f2(h,a,b); c += x; g = x + y;
+    x = f + f1(c,d,e) + 0xb5c0fbcf + words[ 2]; y = f2(g,h,a); b += x; f = x + y;
+    x = e + f1(b,c,d) + 0xe9b5dba5 + words[ 3]; y = f2(f,g,h); a += x; e = x + y;
+    x = d + f1(a,b,c) + 0x3956c25b + words[ 4]; y = f2(e,f,g); h += x; d = x + y;
+    x = c + f1(h,a,b) + 0x59f111f1 + words[ 5]; y = f2(d,e,f); g += x; c = x + y;
+    x = b + f1(g,h,a) + 0x923f82a4 + words[ 6]; y = f2(c,d,e); f += x; b = x + y;
+    x = a + f1(f,g,h) + 0xab1c5ed5 + words[ 7]; y = f2(b,c,d); e += x; a = x + y;
+
+    // secound round
+    x = h + f1(e,f,g) + 0xd807aa98 + words[ 8]; y = f2(a,b,c); d += x; h = x + y;
+    x = g + f1(d,e,f) + 0x12835b01 + words[ 9]; y = f2(h,a,b); c += x; g = x + y;
+    x = f + f1(c,d,e) + 0x243185be + words[10]; y = f2(g,h,a); b += x; f = x + y;
+    x = e + f1(b,c,d) + 0x550c7dc3 + words[11]; y = f2(f,g,h); a += x; e = x + y;
+    x = d + f1(a,b,c) + 0x72be5d74 + words[12]; y = f2(e,f,g); h += x; d = x + y;
+    x = c + f1(h,a,b) + 0x80deb1fe + words[13]; y = f2(d,e,f); g += x; c = x + y;
+    x = b + f1(g,h,a) + 0x9bdc06a7 + words[14]; y = f2(c,d,e); f += x; b = x + y;
+    x = a + f1(f,g,h) + 0xc19bf174 + words[15]; y = f2(b,c,d); e += x; a = x + y;
+
+    // extend to 24 words
+    for (; i < 24; i++)
+      words[i] = words[i-16] +
+                 (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
+                 words[i-7] +
+                 (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
+
+    // third round
+    x = h + f1(e,f,g) + 0xe49b69c1 + words[16]; y = f2(a,b,c); d += x; h = x + y;
+    x = g + f1(d,e,f) + 0xefbe4786 + words[17]; y = f2(h,a,b); c += x; g = x + y;
+    x = f + f1(c,d,e) + 0x0fc19dc6 + words[18]; y = f2(g,h,a); b += x; f = x + y;
+    x = e + f1(b,c,d) + 0x240ca1cc + words[19]; y = f2(f,g,h); a += x; e = x + y;
+    x = d + f1(a,b,c) + 0x2de92c6f + words[20]; y = f2(e,f,g); h += x; d = x + y;
+    x = c + f1(h,a,b) + 0x4a7484aa + words[21]; y = f2(d,e,f); g += x; c = x + y;
+    x = b + f1(g,h,a) + 0x5cb0a9dc + words[22]; y = f2(c,d,e); f += x; b = x + y;
+    x = a + f1(f,g,h) + 0x76f988da + words[23]; y = f2(b,c,d); e += x; a = x + y;
+
+    // extend to 32 words
+    for (; i < 32; i++)
+      words[i] = words[i-16] +
+                 (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
+                 words[i-7] +
+                 (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
+
+    // fourth round
+    x = h + f1(e,f,g) + 0x983e5152 + words[24]; y = f2(a,b,c); d += x; h = x + y;
+    x = g + f1(d,e,f) + 0xa831c66d + words[25]; y = f2(h,a,b); c += x; g = x + y;
+    x = f + f1(c,d,e) + 0xb00327c8 + words[26]; y = f2(g,h,a); b += x; f = x + y;
+    x = e + f1(b,c,d) + 0xbf597fc7 + words[27]; y = f2(f,g,h); a += x; e = x + y;
+    x = d + f1(a,b,c) + 0xc6e00bf3 + words[28]; y = f2(e,f,g); h += x; d = x + y;
+    x = c + f1(h,a,b) + 0xd5a79147 + words[29]; y = f2(d,e,f); g += x; c = x + y;
+    x = b + f1(g,h,a) + 0x06ca6351 + words[30]; y = f2(c,d,e); f += x; b = x + y;
+    x = a + f1(f,g,h) + 0x14292967 + words[31]; y = f2(b,c,d); e += x; a = x + y;
+
+    // extend to 40 words
+    for (; i < 40; i++)
+      words[i] = words[i-16] +
+                 (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
+                 words[i-7] +
+                 (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
+
+    // fifth round
+    x = h + f1(e,f,g) + 0x27b70a85 + words[32]; y = f2(a,b,c); d += x; h = x + y;
+    x = g + f1(d,e,f) + 0x2e1b2138 + words[33]; y = f2(h,a,b); c += x; g = x + y;
+    x = f + f1(c,d,e) + 0x4d2c6dfc + words[34]; y = f2(g,h,a); b += x; f = x + y;
+    x = e + f1(b,c,d) + 0x53380d13 + words[35]; y = f2(f,g,h); a += x; e = x + y;
+    x = d + f1(a,b,c) + 0x650a7354 + words[36]; y = f2(e,f,g); h += x; d = x + y;
+    x = c + f1(h,a,b) + 0x766a0abb + words[37]; y = f2(d,e,f); g += x; c = x + y;
+    x = b + f1(g,h,a) + 0x81c2c92e + words[38]; y = f2(c,d,e); f += x; b = x + y;
+    x = a + f1(f,g,h) + 0x92722c85 + words[39]; y = f2(b,c,d); e += x; a = x + y;
+
+    // extend to 48 words
+    for (; i < 48; i++)
+      words[i] = words[i-16] +
+                 (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
+                 words[i-7] +
+                 (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
+
+    // sixth round
+    x = h + f1(e,f,g) + 0xa2bfe8a1 + words[40]; y = f2(a,b,c); d += x; h = x + y;
+    x = g + f1(d,e,f) + 0xa81a664b + words[41]; y = f2(h,a,b); c += x; g = x + y;
+    x = f + f1(c,d,e) + 0xc24b8b70 + words[42]; y = f2(g,h,a); b += x; f = x + y;
+    x = e + f1(b,c,d) + 0xc76c51a3 + words[43]; y = f2(f,g,h); a += x; e = x + y;
+    x = d + f1(a,b,c) + 0xd192e819 + words[44]; y = f2(e,f,g); h += x; d = x + y;
+    x = c + f1(h,a,b) + 0xd6990624 + words[45]; y = f2(d,e,f); g += x; c = x + y;
+    x = b + f1(g,h,a) + 0xf40e3585 + words[46]; y = f2(c,d,e); f += x; b = x + y;
+    x = a + f1(f,g,h) + 0x106aa070 + words[47]; y = f2(b,c,d); e += x; a = x + y;
+
+    // extend to 56 words
+    for (; i < 56; i++)
+      words[i] = words[i-16] +
+                 (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
+                 words[i-7] +
+                 (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
+
+    // seventh round
+    x = h + f1(e,f,g) + 0x19a4c116 + words[48]; y = f2(a,b,c); d += x; h = x + y;
+    x = g + f1(d,e,f) + 0x1e376c08 + words[49]; y = f2(h,a,b); c += x; g = x + y;
+    x = f + f1(c,d,e) + 0x2748774c + words[50]; y = f2(g,h,a); b += x; f = x + y;
+    x = e + f1(b,c,d) + 0x34b0bcb5 + words[51]; y = f2(f,g,h); a += x; e = x + y;
+    x = d + f1(a,b,c) + 0x391c0cb3 + words[52]; y = f2(e,f,g); h += x; d = x + y;
+    x = c + f1(h,a,b) + 0x4ed8aa4a + words[53]; y = f2(d,e,f); g += x; c = x + y;
+    x = b + f1(g,h,a) + 0x5b9cca4f + words[54]; y = f2(c,d,e); f += x; b = x + y;
+    x = a + f1(f,g,h) + 0x682e6ff3 + words[55]; y = f2(b,c,d); e += x; a = x + y;
+
+    // extend to 64 words
+    for (; i < 64; i++)
+      words[i] = words[i-16] +
+                 (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
+                 words[i-7] +
+                 (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
+
+    // eigth round
+    x = h + f1(e,f,g) + 0x748f82ee + words[56]; y = f2(a,b,c); d += x; h = x + y;
+    x = g + f1(d,e,f) + 0x78a5636f + words[57]; y = f2(h,a,b); c += x; g = x + y;
+    x = f + f1(c,d,e) + 0x84c87814 + words[58]; y = f2(g,h,a); b += x; f = x + y;
+    x = e + f1(b,c,d) + 0x8cc70208 + words[59]; y = f2(f,g,h); a += x; e = x + y;
+    x = d + f1(a,b,c) + 0x90befffa + words[60]; y = f2(e,f,g); h += x; d = x + y;
+    x = c + f1(h,a,b) + 0xa4506ceb + words[61]; y = f2(d,e,f); g += x; c = x + y;
+    x = b + f1(g,h,a) + 0xbef9a3f7 + words[62]; y = f2(c,d,e); f += x; b = x + y;
+    x = a + f1(f,g,h) + 0xc67178f2 + words[63]; y = f2(b,c,d); e += x; a = x + y;
+
+    // update hash
+    hash[0] += a;
+    hash[1] += b;
+    hash[2] += c;
+    hash[3] += d;
+    hash[4] += e;
+    hash[5] += f;
+    hash[6] += g;
+    hash[7] += h;
+  }
+
+  /// process consecutive blocks, portable implementation
+  void processBlocksScalar(uint32_t* hash, const uint8_t* data, size_t numBlocks)
+  {
+    for (; numBlocks > 0; numBlocks--, data += SHA256::BlockSize)
+      processBlockScalar(hash, data);
+  }
+
+
+  /// round constants used by the hardware backends
+  const uint32_t roundConstants[64] =
+  {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+  };
+
+
+#ifdef SHA256_WITH_SHANI
+  /// x86 SHA extensions available
+  bool hasShaNi()
+  {
+    int info[4] = {0, 0, 0, 0};
+#ifdef _MSC_VER
+    __cpuid(info, 0);
+    if (info[0] < 7)
+      return false;
+    __cpuid(info, 1);
+    const bool ssse3 = (info[2] & (1 << 9)) != 0, sse41 = (info[2] & (1 << 19)) != 0;
+    __cpuidex(info, 7, 0);
+#else
+    unsigned int a, b, c, d;
+    if (__get_cpuid_max(0, 0) < 7)
+      return false;
+    __cpuid(1, a, b, c, d);
+    const bool ssse3 = (c & (1 << 9)) != 0, sse41 = (c & (1 << 19)) != 0;
+    __cpuid_count(7, 0, a, b, c, d);
+    info[1] = (int)b;
+#endif
+    return ssse3 && sse41 && (info[1] & (1 << 29)) != 0;
+  }
+
+  /// process consecutive blocks using x86 SHA extensions
+  SHA256_TARGET_SHANI
+  void processBlocksShaNi(uint32_t* hash, const uint8_t* data, size_t numBlocks)
+  {
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // state is kept as ABEF and CDGH while processing
+    __m128i tmp    = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*) &hash[0]), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*) &hash[4]), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    for (; numBlocks > 0; numBlocks--, data += SHA256::BlockSize)
+    {
+      const __m128i saveState0 = state0;
+      const __m128i saveState1 = state1;
+      // message schedule, 4 words per entry, ring buffer of the last 16 words
+      __m128i words[4];
+
+      for (int i = 0; i < 16; i++)
+      {
+        if (i < 4)
+          words[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (data + 16 * i)), byteSwap);
+        else
+        {
+          tmp = _mm_sha256msg1_epu32(words[i & 3], words[(i + 1) & 3]);
+          tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(words[(i + 3) & 3], words[(i + 2) & 3], 4));
+          words[i & 3] = _mm_sha256msg2_epu32(tmp, words[(i + 3) & 3]);
+        }
+
+        tmp = _mm_add_epi32(words[i & 3], _mm_loadu_si128((const __m128i*) &roundConstants[4 * i]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, tmp);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(tmp, 0x0E));
+      }
+
+      state0 = _mm_add_epi32(state0, saveState0);
+      state1 = _mm_add_epi32(state1, saveState1);
+    }
+
+    // back to ABCD and EFGH
+    tmp    = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128((__m128i*) &hash[0], state0);
+    _mm_storeu_si128((__m128i*) &hash[4], state1);
+  }
+#endif
+
+
+#ifdef SHA256_WITH_ARMV8
+  /// ARMv8 SHA-256 instructions available
+  bool hasArmV8()
+  {
+#if defined(__APPLE__)
+    return true;
+#elif defined(_WIN32)
+    return IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) != 0;
+#elif defined(__linux__)
+    return (getauxval(AT_HWCAP) & HWCAP_SHA2) != 0;
+#else
+    return false;
+#endif
+  }
+
+  /// process consecutive blocks using ARMv8 SHA-256 instructions
+  SHA256_TARGET_ARMV8
+  void processBlocksArmV8(uint32_t* hash, const uint8_t* data, size_t numBlocks)
+  {
+    uint32x4_t state0 = vld1q_u32(&hash[0]);
+    uint32x4_t state1 = vld1q_u32(&hash[4]);
+
+    for (; numBlocks > 0; numBlocks--, data += SHA256::BlockSize)
+    {
+      const uint32x4_t saveState0 = state0;
+      const uint32x4_t saveState1 = state1;
+      // message schedule, 4 words per entry, ring buffer of the last 16 words
+      uint32x4_t words[4];
+
+      for (int i = 0; i < 16; i++)
+      {
+        if (i < 4)
+          words[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+        else
+          words[i & 3] = vsha256su1q_u32(vsha256su0q_u32(words[i & 3], words[(i + 1) & 3]),
+                                         words[(i + 2) & 3], words[(i + 3) & 3]);
+
+        const uint32x4_t tmp = vaddq_u32(words[i & 3], vld1q_u32(&roundConstants[4 * i]));
+        const uint32x4_t prevState0 = state0;
+        state0 = vsha256hq_u32(state0, state1, tmp);
+        state1 = vsha256h2q_u32(state1, prevState0, tmp);
+      }
+
+      state0 = vaddq_u32(state0, saveState0);
+      state1 = vaddq_u32(state1, saveState1);
+    }
+
+    vst1q_u32(&hash[0], state0);
+    vst1q_u32(&hash[4], state1);
+  }
+#endif
+
+
+  typedef void (*ProcessBlocksFunc)(uint32_t* hash, const uint8_t* data, size_t numBlocks);
+
+  /// block processing function of backend or nullptr if not supported by this CPU
+  ProcessBlocksFunc backendFunction(SHA256::Backend backend)
+  {
+    switch (backend)
+    {
+    case SHA256::BackendScalar:
+      return processBlocksScalar;
+#ifdef SHA256_WITH_SHANI
+    case SHA256::BackendShaNi:
+      return hasShaNi() ? processBlocksShaNi : nullptr;
+#endif
+#ifdef SHA256_WITH_ARMV8
+    case SHA256::BackendArmV8:
+      return hasArmV8() ? processBlocksArmV8 : nullptr;
+#endif
+    default:
+      return nullptr;
+    }
+  }
+
+  /// compare backend against the scalar implementation using pseudo random data
+  bool matchesScalar(ProcessBlocksFunc function)
+  {
+    uint8_t data[7 * SHA256::BlockSize];
+    uint32_t seed = 0x2545f491;
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+      seed = seed * 1664525 + 1013904223;
+      data[i] = (uint8_t)(seed >> 24);
+    }
+
+    for (size_t numBlocks = 1; numBlocks <= 7; numBlocks++)
+    {
+      uint32_t expected[8], actual[8];
+      for (int i = 0; i < 8; i++)
+        expected[i] = actual[i] = 0x6a09e667 + 0x9e3779b9 * (uint32_t)(i + numBlocks);
+
+      processBlocksScalar(expected, data, numBlocks);
+      function(actual, data, numBlocks);
+
+      for (int i = 0; i < 8; i++)
+        if (actual[i] != expected[i])
+          return false;
+    }
+    return true;
+  }
+
+  /// fastest backend supported by this CPU which passes the self test
+  SHA256::Backend detectBackend()
+  {
+    const SHA256::Backend candidates[] = { SHA256::BackendShaNi, SHA256::BackendArmV8 };
+    for (SHA256::Backend backend : candidates)
+    {
+      const ProcessBlocksFunc function = backendFunction(backend);
+      if (function && matchesScalar(function))
+        return backend;
+    }
+    return SHA256::BackendScalar;
+  }
+}
+
+
+/// same as reset()
+SHA256::SHA256() :
+  m_processBlocks(backendFunction(getBackend()))
+{
+  reset();
 }
 
 
 /// process 64 bytes
 void SHA256::processBlock(const void* data)
 {
-  // get last hash
-  uint32_t a = m_hash[0];
-  uint32_t b = m_hash[1];
-  uint32_t c = m_hash[2];
-  uint32_t d = m_hash[3];
-  uint32_t e = m_hash[4];
-  uint32_t f = m_hash[5];
-  uint32_t g = m_hash[6];
-  uint32_t h = m_hash[7];
-
-  // data represented as 16x 32-bit words
-  const uint32_t* input = (uint32_t*) data;
-  // convert to big endian
-  uint32_t words[64];
-  int i;
-  for (i = 0; i < 16; i++)
-#if defined(__BYTE_ORDER) && (__BYTE_ORDER != 0) && (__BYTE_ORDER == __BIG_ENDIAN)
-    words[i] =      input[i];
-#else
-    words[i] = swap(input[i]);
-#endif
+  m_processBlocks(m_hash, (const uint8_t*) data, 1);
+}
+
+
+/// process consecutive blocks of 64 bytes each
+void SHA256::processBlocks(const void* data, size_t numBlocks)
+{
+  m_processBlocks(m_hash, (const uint8_t*) data, numBlocks);
+}
+
 
-  uint32_t x,y; // temporaries
-
-  // first round
-  x = h + f1(e,f,g) + 0x428a2f98 + words[ 0]; y = f2(a,b,c); d += x; h = x + y;
-  x = g + f1(d,e,f) + 0x71374491 + words[ 1]; y = f2(h,a,b); c += x; g = x + y;
-  x = f + f1(c,d,e) + 0xb5c0fbcf + words[ 2]; y = f2(g,h,a); b += x; f = x + y;
-  x = e + f1(b,c,d) + 0xe9b5dba5 + words[ 3]; y = f2(f,g,h); a += x; e = x + y;
-  x = d + f1(a,b,c) + 0x3956c25b + words[ 4]; y = f2(e,f,g); h += x; d = x + y;
-  x = c + f1(h,a,b) + 0x59f111f1 + words[ 5]; y = f2(d,e,f); g += x; c = x + y;
-  x = b + f1(g,h,a) + 0x923f82a4 + words[ 6]; y = f2(c,d,e); f += x; b = x + y;
-  x = a + f1(f,g,h) + 0xab1c5ed5 + words[ 7]; y = f2(b,c,d); e += x; a = x + y;
-
-  // secound round
-  x = h + f1(e,f,g) + 0xd807aa98 + words[ 8]; y = f2(a,b,c); d += x; h = x + y;
-  x = g + f1(d,e,f) + 0x12835b01 + words[ 9]; y = f2(h,a,b); c += x; g = x + y;
-  x = f + f1(c,d,e) + 0x243185be + words[10]; y = f2(g,h,a); b += x; f = x + y;
-  x = e + f1(b,c,d) + 0x550c7dc3 + words[11]; y = f2(f,g,h); a += x; e = x + y;
-  x = d + f1(a,b,c) + 0x72be5d74 + words[12]; y = f2(e,f,g); h += x; d = x + y;
-  x = c + f1(h,a,b) + 0x80deb1fe + words[13]; y = f2(d,e,f); g += x; c = x + y;
-  x = b + f1(g,h,a) + 0x9bdc06a7 + words[14]; y = f2(c,d,e); f += x; b = x + y;
-  x = a + f1(f,g,h) + 0xc19bf174 + words[15]; y = f2(b,c,d); e += x; a = x + y;
-
-  // extend to 24 words
-  for (; i < 24; i++)
-    words[i] = words[i-16] +
-               (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
-               words[i-7] +
-               (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
-
-  // third round
-  x = h + f1(e,f,g) + 0xe49b69c1 + words[16]; y = f2(a,b,c); d += x; h = x + y;
-  x = g + f1(d,e,f) + 0xefbe4786 + words[17]; y = f2(h,a,b); c += x; g = x + y;
-  x = f + f1(c,d,e) + 0x0fc19dc6 + words[18]; y = f2(g,h,a); b += x; f = x + y;
-  x = e + f1(b,c,d) + 0x240ca1cc + words[19]; y = f2(f,g,h); a += x; e = x + y;
-  x = d + f1(a,b,c) + 0x2de92c6f + words[20]; y = f2(e,f,g); h += x; d = x + y;
-  x = c + f1(h,a,b) + 0x4a7484aa + words[21]; y = f2(d,e,f); g += x; c = x + y;
-  x = b + f1(g,h,a) + 0x5cb0a9dc + words[22]; y = f2(c,d,e); f += x; b = x + y;
-  x = a + f1(f,g,h) + 0x76f988da + words[23]; y = f2(b,c,d); e += x; a = x + y;
-
-  // extend to 32 words
-  for (; i < 32; i++)
-    words[i] = words[i-16] +
-               (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
-               words[i-7] +
-               (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
-
-  // fourth round
-  x = h + f1(e,f,g) + 0x983e5152 + words[24]; y = f2(a,b,c); d += x; h = x + y;
-  x = g + f1(d,e,f) + 0xa831c66d + words[25]; y = f2(h,a,b); c += x; g = x + y;
-  x = f + f1(c,d,e) + 0xb00327c8 + words[26]; y = f2(g,h,a); b += x; f = x + y;
-  x = e + f1(b,c,d) + 0xbf597fc7 + words[27]; y = f2(f,g,h); a += x; e = x + y;
-  x = d + f1(a,b,c) + 0xc6e00bf3 + words[28]; y = f2(e,f,g); h += x; d = x + y;
-  x = c + f1(h,a,b) + 0xd5a79147 + words[29]; y = f2(d,e,f); g += x; c = x + y;
-  x = b + f1(g,h,a) + 0x06ca6351 + words[30]; y = f2(c,d,e); f += x; b = x + y;
-  x = a + f1(f,g,h) + 0x14292967 + words[31]; y = f2(b,c,d); e += x; a = x + y;
-
-  // extend to 40 words
-  for (; i < 40; i++)
-    words[i] = words[i-16] +
-               (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
-               words[i-7] +
-               (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
-
-  // fifth round
-  x = h + f1(e,f,g) + 0x27b70a85 + words[32]; y = f2(a,b,c); d += x; h = x + y;
-  x = g + f1(d,e,f) + 0x2e1b2138 + words[33]; y = f2(h,a,b); c += x; g = x + y;
-  x = f + f1(c,d,e) + 0x4d2c6dfc + words[34]; y = f2(g,h,a); b += x; f = x + y;
-  x = e + f1(b,c,d) + 0x53380d13 + words[35]; y = f2(f,g,h); a += x; e = x + y;
-  x = d + f1(a,b,c) + 0x650a7354 + words[36]; y = f2(e,f,g); h += x; d = x + y;
-  x = c + f1(h,a,b) + 0x766a0abb + words[37]; y = f2(d,e,f); g += x; c = x + y;
-  x = b + f1(g,h,a) + 0x81c2c92e + words[38]; y = f2(c,d,e); f += x; b = x + y;
-  x = a + f1(f,g,h) + 0x92722c85 + words[39]; y = f2(b,c,d); e += x; a = x + y;
-
-  // extend to 48 words
-  for (; i < 48; i++)
-    words[i] = words[i-16] +
-               (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
-               words[i-7] +
-               (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
-
-  // sixth round
-  x = h + f1(e,f,g) + 0xa2bfe8a1 + words[40]; y = f2(a,b,c); d += x; h = x + y;
-  x = g + f1(d,e,f) + 0xa81a664b + words[41]; y = f2(h,a,b); c += x; g = x + y;
-  x = f + f1(c,d,e) + 0xc24b8b70 + words[42]; y = f2(g,h,a); b += x; f = x + y;
-  x = e + f1(b,c,d) + 0xc76c51a3 + words[43]; y = f2(f,g,h); a += x; e = x + y;
-  x = d + f1(a,b,c) + 0xd192e819 + words[44]; y = f2(e,f,g); h += x; d = x + y;
-  x = c + f1(h,a,b) + 0xd6990624 + words[45]; y = f2(d,e,f); g += x; c = x + y;
-  x = b + f1(g,h,a) + 0xf40e3585 + words[46]; y = f2(c,d,e); f += x; b = x + y;
-  x = a + f1(f,g,h) + 0x106aa070 + words[47]; y = f2(b,c,d); e += x; a = x + y;
-
-  // extend to 56 words
-  for (; i < 56; i++)
-    words[i] = words[i-16] +
-               (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
-               words[i-7] +
-               (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
-
-  // seventh round
-  x = h + f1(e,f,g) + 0x19a4c116 + words[48]; y = f2(a,b,c); d += x; h = x + y;
-  x = g + f1(d,e,f) + 0x1e376c08 + words[49]; y = f2(h,a,b); c += x; g = x + y;
-  x = f + f1(c,d,e) + 0x2748774c + words[50]; y = f2(g,h,a); b += x; f = x + y;
-  x = e + f1(b,c,d) + 0x34b0bcb5 + words[51]; y = f2(f,g,h); a += x; e = x + y;
-  x = d + f1(a,b,c) + 0x391c0cb3 + words[52]; y = f2(e,f,g); h += x; d = x + y;
-  x = c + f1(h,a,b) + 0x4ed8aa4a + words[53]; y = f2(d,e,f); g += x; c = x + y;
-  x = b + f1(g,h,a) + 0x5b9cca4f + words[54]; y = f2(c,d,e); f += x; b = x + y;
-  x = a + f1(f,g,h) + 0x682e6ff3 + words[55]; y = f2(b,c,d); e += x; a = x + y;
-
-  // extend to 64 words
-  for (; i < 64; i++)
-    words[i] = words[i-16] +
-               (rotate(words[i-15],  7) ^ rotate(words[i-15], 18) ^ (words[i-15] >>  3)) +
-               words[i-7] +
-               (rotate(words[i- 2], 17) ^ rotate(words[i- 2], 19) ^ (words[i- 2] >> 10));
-
-  // eigth round
-  x = h + f1(e,f,g) + 0x748f82ee + words[56]; y = f2(a,b,c); d += x; h = x + y;
-  x = g + f1(d,e,f) + 0x78a5636f + words[57]; y = f2(h,a,b); c += x; g = x + y;
-  x = f + f1(c,d,e) + 0x84c87814 + words[58]; y = f2(g,h,a); b += x; f = x + y;
-  x = e + f1(b,c,d) + 0x8cc70208 + words[59]; y = f2(f,g,h); a += x; e = x + y;
-  x = d + f1(a,b,c) + 0x90befffa + words[60]; y = f2(e,f,g); h += x; d = x + y;
-  x = c + f1(h,a,b) + 0xa4506ceb + words[61]; y = f2(d,e,f); g += x; c = x + y;
-  x = b + f1(g,h,a) + 0xbef9a3f7 + words[62]; y = f2(c,d,e); f += x; b = x + y;
-  x = a + f1(f,g,h) + 0xc67178f2 + words[63]; y = f2(b,c,d); e += x; a = x + y;
-
-  // update hash
-  m_hash[0] += a;
-  m_hash[1] += b;
-  m_hash[2] += c;
-  m_hash[3] += d;
-  m_hash[4] += e;
-  m_hash[5] += f;
-  m_hash[6] += g;
-  m_hash[7] += h;
+/// backend used by all instances, detected on first use
+SHA256::Backend SHA256::getBackend()
+{
+  static const Backend backend = detectBackend();
+  return backend;
+}
+
+
+/// name of backend for logging
+const char* SHA256::getBackendName(Backend backend)
+{
+  switch (backend)
+  {
+  case BackendShaNi:
+    return "SHA-NI";
+  case BackendArmV8:
+    return "ARMv8";
+  case BackendScalar:
+  default:
+    return "Scalar";
+  }
+}
+
+
+/// check all backends supported by this CPU against the scalar implementation
+bool SHA256::selfTest()
+{
+  // known answer test of the scalar implementation including padding
+  SHA256 sha256;
+  sha256.m_processBlocks = processBlocksScalar;
+  sha256.add("abc", 3);
+  if (sha256.getHash() != "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad")
+    return false;
+
+  const Backend backends[] = { BackendShaNi, BackendArmV8 };
+  for (Backend backend : backends)
+  {
+    const ProcessBlocksFunc function = backendFunction(backend);
+    if (function && !matchesScalar(function))
+      return false;
+  }
+  return true;
 }
 
 
@@ -264,12 +569,13 @@ void SHA256::add(const void* data, size_t numBytes)
     return;
 
   // process full blocks
-  while (numBytes >= BlockSize)
+  const size_t numBlocks = numBytes / BlockSize;
+  if (numBlocks > 0)
   {
-    processBlock(current);
-    current    += BlockSize;
-    m_numBytes += BlockSize;
-    numBytes   -= BlockSize;
+    processBlocks(current, numBlocks);
+    current    += numBlocks * BlockSize;
+    m_numBytes += numBlocks * BlockSize;
+    numBytes   -= numBlocks * BlockSize;
   }
 
   // keep remaining bytes in buffer
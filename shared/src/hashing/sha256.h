@@ -40,6 +40,9 @@ public:
   /// split into 64 byte blocks (=> 512 bits), hash is 32 bytes long
   enum { BlockSize = 512 / 8, HashBytes = 32 };
 
+  /// block processing implementations, the best supported one is selected at runtime
+  enum Backend { BackendScalar, BackendShaNi, BackendArmV8 };
+
   /// same as reset()
   SHA256();
 
@@ -59,9 +62,18 @@ public:
   /// restart
   void reset();
 
+  /// backend used by all instances, detected on first use
+  static Backend getBackend();
+  /// name of backend for logging
+  static const char* getBackendName(Backend backend);
+  /// check all backends supported by this CPU against the scalar implementation
+  static bool selfTest();
+
 private:
   /// process 64 bytes
   void processBlock(const void* data);
+  /// process consecutive blocks of 64 bytes each
+  void processBlocks(const void* data, size_t numBlocks);
   /// process everything left in the internal buffer
   void processBuffer();
 
@@ -75,4 +87,7 @@ private:
   enum { HashValues = HashBytes / 4 };
   /// hash, stored as integers
   uint32_t m_hash[HashValues];
+
+  /// block processing function of selected backend
+  void (*m_processBlocks)(uint32_t* hash, const uint8_t* data, size_t numBlocks);
 };
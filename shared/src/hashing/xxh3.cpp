@@ -0,0 +1,468 @@
+// //////////////////////////////////////////////////////////
+// xxh3.cpp
+// XXH3 128 bit hash, compatible with xxHash 0.8 XXH3_128bits()
+// using the default secret and seed 0.
+//
+
+#include "xxh3.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XXH3_WITH_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+
+namespace
+{
+  const uint64_t Prime32_1 = 0x9E3779B1U;
+  const uint64_t Prime32_2 = 0x85EBCA77U;
+  const uint64_t Prime32_3 = 0xC2B2AE3DU;
+  const uint64_t Prime64_1 = 0x9E3779B185EBCA87ULL;
+  const uint64_t Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+  const uint64_t Prime64_3 = 0x165667B19E3779F9ULL;
+  const uint64_t Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+  const uint64_t Prime64_5 = 0x27D4EB2F165667C5ULL;
+  const uint64_t PrimeMx1  = 0x165667919E3779F9ULL;
+  const uint64_t PrimeMx2  = 0x9FB21C651E98DF25ULL;
+
+  /// default secret
+  const size_t SecretSize = 192;
+  const uint8_t secret[SecretSize] =
+  {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e
+  };
+
+  /// stripes per block, secret is advanced by 8 bytes per stripe
+  const size_t StripesPerBlock = (SecretSize - XXH3_128::StripeSize) / 8;
+  /// secret offsets
+  const size_t SecretLastAccStart   = 7;
+  const size_t SecretMergeAccsStart = 11;
+  const size_t MidSizeMax           = 240;
+  const size_t MidSizeStartOffset   = 3;
+  const size_t MidSizeLastOffset    = 17;
+  const size_t SecretSizeMin        = 136;
+
+  struct Hash128
+  {
+    uint64_t low;
+    uint64_t high;
+  };
+
+
+  inline uint32_t readLE32(const uint8_t* p)
+  {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+
+  inline uint64_t readLE64(const uint8_t* p)
+  {
+    return (uint64_t)readLE32(p) | ((uint64_t)readLE32(p + 4) << 32);
+  }
+
+  inline uint32_t swap32(uint32_t x)
+  {
+    return  (x << 24) | ((x << 8) & 0x00ff0000) | ((x >> 8) & 0x0000ff00) | (x >> 24);
+  }
+
+  inline uint64_t swap64(uint64_t x)
+  {
+    return ((uint64_t)swap32((uint32_t)x) << 32) | swap32((uint32_t)(x >> 32));
+  }
+
+  inline uint32_t rotl32(uint32_t x, int r)
+  {
+    return (x << r) | (x >> (32 - r));
+  }
+
+  inline uint64_t xorShift64(uint64_t v, int shift)
+  {
+    return v ^ (v >> shift);
+  }
+
+  /// full 64x64 => 128 bit product
+  inline Hash128 mult64to128(uint64_t a, uint64_t b)
+  {
+    Hash128 r;
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t product = (__uint128_t)a * b;
+    r.low  = (uint64_t)product;
+    r.high = (uint64_t)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    r.low = _umul128(a, b, &r.high);
+#else
+    const uint64_t loLo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    const uint64_t hiLo = (a >> 32)        * (b & 0xFFFFFFFF);
+    const uint64_t loHi = (a & 0xFFFFFFFF) * (b >> 32);
+    const uint64_t hiHi = (a >> 32)        * (b >> 32);
+    const uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+    r.high = (hiLo >> 32) + (cross >> 32) + hiHi;
+    r.low  = (cross << 32) | (loLo & 0xFFFFFFFF);
+#endif
+    return r;
+  }
+
+  inline uint64_t mul128fold64(uint64_t a, uint64_t b)
+  {
+    const Hash128 product = mult64to128(a, b);
+    return product.low ^ product.high;
+  }
+
+  inline uint64_t xxh64Avalanche(uint64_t h)
+  {
+    h ^= h >> 33;
+    h *= Prime64_2;
+    h ^= h >> 29;
+    h *= Prime64_3;
+    h ^= h >> 32;
+    return h;
+  }
+
+  inline uint64_t xxh3Avalanche(uint64_t h)
+  {
+    h = xorShift64(h, 37);
+    h *= PrimeMx1;
+    h = xorShift64(h, 32);
+    return h;
+  }
+
+  inline uint64_t mix16B(const uint8_t* data, const uint8_t* key)
+  {
+    return mul128fold64(readLE64(data) ^ readLE64(key), readLE64(data + 8) ^ readLE64(key + 8));
+  }
+
+  inline void mix32B(Hash128& acc, const uint8_t* data1, const uint8_t* data2, const uint8_t* key)
+  {
+    acc.low  += mix16B(data1, key);
+    acc.low  ^= readLE64(data2) + readLE64(data2 + 8);
+    acc.high += mix16B(data2, key + 16);
+    acc.high ^= readLE64(data1) + readLE64(data1 + 8);
+  }
+
+
+  /// 0 to 16 bytes
+  Hash128 hashShort(const uint8_t* data, size_t size)
+  {
+    Hash128 h;
+
+    if (size > 8)
+    {
+      const uint64_t bitflipLow  = readLE64(secret + 32) ^ readLE64(secret + 40);
+      const uint64_t bitflipHigh = readLE64(secret + 48) ^ readLE64(secret + 56);
+      const uint64_t dataLow  = readLE64(data);
+      uint64_t       dataHigh = readLE64(data + size - 8);
+
+      Hash128 m = mult64to128(dataLow ^ dataHigh ^ bitflipLow, Prime64_1);
+      m.low += (uint64_t)(size - 1) << 54;
+      dataHigh ^= bitflipHigh;
+      m.high += dataHigh + (uint64_t)(uint32_t)dataHigh * (Prime32_2 - 1);
+      m.low ^= swap64(m.high);
+
+      h = mult64to128(m.low, Prime64_2);
+      h.high += m.high * Prime64_2;
+      h.low  = xxh3Avalanche(h.low);
+      h.high = xxh3Avalanche(h.high);
+    }
+    else if (size >= 4)
+    {
+      const uint64_t data64 = readLE32(data) + ((uint64_t)readLE32(data + size - 4) << 32);
+      const uint64_t bitflip = readLE64(secret + 16) ^ readLE64(secret + 24);
+
+      h = mult64to128(data64 ^ bitflip, Prime64_1 + (size << 2));
+      h.high += h.low << 1;
+      h.low  ^= h.high >> 3;
+      h.low   = xorShift64(h.low, 35);
+      h.low  *= PrimeMx2;
+      h.low   = xorShift64(h.low, 28);
+      h.high  = xxh3Avalanche(h.high);
+    }
+    else if (size > 0)
+    {
+      const uint32_t combinedLow = ((uint32_t)data[0] << 16) | ((uint32_t)data[size >> 1] << 24)
+                                 | (uint32_t)data[size - 1] | ((uint32_t)size << 8);
+      const uint32_t combinedHigh = rotl32(swap32(combinedLow), 13);
+      const uint64_t bitflipLow  = readLE32(secret) ^ readLE32(secret + 4);
+      const uint64_t bitflipHigh = readLE32(secret + 8) ^ readLE32(secret + 12);
+
+      h.low  = xxh64Avalanche((uint64_t)combinedLow ^ bitflipLow);
+      h.high = xxh64Avalanche((uint64_t)combinedHigh ^ bitflipHigh);
+    }
+    else
+    {
+      h.low  = xxh64Avalanche(readLE64(secret + 64) ^ readLE64(secret + 72));
+      h.high = xxh64Avalanche(readLE64(secret + 80) ^ readLE64(secret + 88));
+    }
+
+    return h;
+  }
+
+  /// 17 to 240 bytes
+  Hash128 hashMedium(const uint8_t* data, size_t size)
+  {
+    Hash128 acc;
+    acc.low  = size * Prime64_1;
+    acc.high = 0;
+
+    if (size <= 128)
+    {
+      if (size > 32)
+      {
+        if (size > 64)
+        {
+          if (size > 96)
+            mix32B(acc, data + 48, data + size - 64, secret + 96);
+          mix32B(acc, data + 32, data + size - 48, secret + 64);
+        }
+        mix32B(acc, data + 16, data + size - 32, secret + 32);
+      }
+      mix32B(acc, data, data + size - 16, secret);
+    }
+    else
+    {
+      size_t i;
+      for (i = 32; i < 160; i += 32)
+        mix32B(acc, data + i - 32, data + i - 16, secret + i - 32);
+      acc.low  = xxh3Avalanche(acc.low);
+      acc.high = xxh3Avalanche(acc.high);
+      for (i = 160; i <= size; i += 32)
+        mix32B(acc, data + i - 32, data + i - 16, secret + MidSizeStartOffset + i - 160);
+      mix32B(acc, data + size - 16, data + size - 32, secret + SecretSizeMin - MidSizeLastOffset - 16);
+    }
+
+    Hash128 h;
+    h.low  = xxh3Avalanche(acc.low + acc.high);
+    h.high = 0 - xxh3Avalanche(acc.low * Prime64_1 + acc.high * Prime64_4 + size * Prime64_2);
+    return h;
+  }
+
+
+  /// process one stripe of 64 bytes
+  inline void accumulate512(uint64_t* acc, const uint8_t* data, const uint8_t* key)
+  {
+#ifdef XXH3_WITH_SSE2
+    for (int i = 0; i < 4; i++)
+    {
+      const __m128i dataVec = _mm_loadu_si128((const __m128i*)(data + 16 * i));
+      const __m128i dataKey = _mm_xor_si128(dataVec, _mm_loadu_si128((const __m128i*)(key + 16 * i)));
+      const __m128i product = _mm_mul_epu32(dataKey, _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)));
+      const __m128i dataSwap = _mm_shuffle_epi32(dataVec, _MM_SHUFFLE(1, 0, 3, 2));
+      const __m128i sum = _mm_add_epi64(_mm_loadu_si128((const __m128i*)(acc + 2 * i)), dataSwap);
+      _mm_storeu_si128((__m128i*)(acc + 2 * i), _mm_add_epi64(product, sum));
+    }
+#else
+    for (int i = 0; i < 8; i++)
+    {
+      const uint64_t dataValue = readLE64(data + 8 * i);
+      const uint64_t dataKey = dataValue ^ readLE64(key + 8 * i);
+      acc[i ^ 1] += dataValue;
+      acc[i] += (uint64_t)(uint32_t)dataKey * (dataKey >> 32);
+    }
+#endif
+  }
+
+  /// scramble accumulators at the end of a block
+  inline void scrambleAcc(uint64_t* acc, const uint8_t* key)
+  {
+#ifdef XXH3_WITH_SSE2
+    const __m128i prime32 = _mm_set1_epi32((int)Prime32_1);
+    for (int i = 0; i < 4; i++)
+    {
+      const __m128i accVec = _mm_loadu_si128((const __m128i*)(acc + 2 * i));
+      const __m128i dataVec = _mm_xor_si128(accVec, _mm_srli_epi64(accVec, 47));
+      const __m128i dataKey = _mm_xor_si128(dataVec, _mm_loadu_si128((const __m128i*)(key + 16 * i)));
+      const __m128i productLow = _mm_mul_epu32(dataKey, prime32);
+      const __m128i productHigh = _mm_mul_epu32(_mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)), prime32);
+      _mm_storeu_si128((__m128i*)(acc + 2 * i), _mm_add_epi64(productLow, _mm_slli_epi64(productHigh, 32)));
+    }
+#else
+    for (int i = 0; i < 8; i++)
+      acc[i] = (xorShift64(acc[i], 47) ^ readLE64(key + 8 * i)) * Prime32_1;
+#endif
+  }
+
+  inline uint64_t mergeAccs(const uint64_t* acc, const uint8_t* key, uint64_t start)
+  {
+    uint64_t result = start;
+    for (int i = 0; i < 4; i++)
+      result += mul128fold64(acc[2 * i] ^ readLE64(key + 16 * i), acc[2 * i + 1] ^ readLE64(key + 16 * i + 8));
+    return xxh3Avalanche(result);
+  }
+}
+
+
+/// same as reset()
+XXH3_128::XXH3_128()
+{
+  reset();
+}
+
+
+/// restart
+void XXH3_128::reset()
+{
+  m_acc[0] = Prime32_3;
+  m_acc[1] = Prime64_1;
+  m_acc[2] = Prime64_2;
+  m_acc[3] = Prime64_3;
+  m_acc[4] = Prime64_4;
+  m_acc[5] = Prime32_2;
+  m_acc[6] = Prime64_5;
+  m_acc[7] = Prime32_1;
+  m_numStripes = 0;
+  m_numBytes   = 0;
+  m_bufferSize = 0;
+}
+
+
+/// consume stripes, scrambling accumulators at the end of each block
+void XXH3_128::consumeStripes(const uint8_t* data, size_t numStripes)
+{
+  while (numStripes > 0)
+  {
+    size_t count = StripesPerBlock - m_numStripes;
+    if (count > numStripes)
+      count = numStripes;
+
+    for (size_t i = 0; i < count; i++, data += StripeSize)
+      accumulate512(m_acc, data, secret + (m_numStripes + i) * 8);
+
+    m_numStripes += count;
+    numStripes   -= count;
+
+    if (m_numStripes == StripesPerBlock)
+    {
+      scrambleAcc(m_acc, secret + SecretSize - StripeSize);
+      m_numStripes = 0;
+    }
+  }
+}
+
+
+/// add arbitrary number of bytes
+void XXH3_128::add(const void* data, size_t numBytes)
+{
+  const uint8_t* current = (const uint8_t*) data;
+  m_numBytes += numBytes;
+
+  // stripes are only consumed if more data follows them. the final stripe is
+  // required to finish the hash and short inputs are hashed without stripes
+  if (m_bufferSize + numBytes <= BufferSize)
+  {
+    memcpy(m_buffer + m_bufferSize, current, numBytes);
+    m_bufferSize += numBytes;
+    return;
+  }
+
+  if (m_bufferSize > 0)
+  {
+    const size_t fill = BufferSize - m_bufferSize;
+    memcpy(m_buffer + m_bufferSize, current, fill);
+    current  += fill;
+    numBytes -= fill;
+    consumeStripes(m_buffer, BufferSize / StripeSize);
+    m_bufferSize = 0;
+  }
+
+  if (numBytes > BufferSize)
+  {
+    // keep at least one byte for the buffer
+    const size_t numStripes = (numBytes - 1) / StripeSize;
+    consumeStripes(current, numStripes);
+    current  += numStripes * StripeSize;
+    numBytes -= numStripes * StripeSize;
+
+    // last consumed stripe is required if less than a stripe remains
+    memcpy(m_buffer + BufferSize - StripeSize, current - StripeSize, StripeSize);
+  }
+
+  memcpy(m_buffer, current, numBytes);
+  m_bufferSize = numBytes;
+}
+
+
+/// return latest hash as bytes
+void XXH3_128::getHash(unsigned char buffer[XXH3_128::HashBytes])
+{
+  Hash128 h;
+
+  if (m_numBytes > MidSizeMax)
+  {
+    // work on copies to allow adding more data afterwards
+    uint64_t acc[8];
+    memcpy(acc, m_acc, sizeof(acc));
+    const size_t savedNumStripes = m_numStripes;
+    uint8_t lastStripe[StripeSize];
+    const uint8_t* lastStripePtr;
+
+    if (m_bufferSize >= StripeSize)
+    {
+      uint64_t savedAcc[8];
+      memcpy(savedAcc, m_acc, sizeof(savedAcc));
+      consumeStripes(m_buffer, (m_bufferSize - 1) / StripeSize);
+      memcpy(acc, m_acc, sizeof(acc));
+      memcpy(m_acc, savedAcc, sizeof(savedAcc));
+      lastStripePtr = m_buffer + m_bufferSize - StripeSize;
+    }
+    else
+    {
+      const size_t catchUp = StripeSize - m_bufferSize;
+      memcpy(lastStripe, m_buffer + BufferSize - catchUp, catchUp);
+      memcpy(lastStripe + catchUp, m_buffer, m_bufferSize);
+      lastStripePtr = lastStripe;
+    }
+    m_numStripes = savedNumStripes;
+
+    accumulate512(acc, lastStripePtr, secret + SecretSize - StripeSize - SecretLastAccStart);
+
+    h.low  = mergeAccs(acc, secret + SecretMergeAccsStart, m_numBytes * Prime64_1);
+    h.high = mergeAccs(acc, secret + SecretSize - sizeof(acc) - SecretMergeAccsStart, ~(m_numBytes * Prime64_2));
+  }
+  else if (m_numBytes > 16)
+    h = hashMedium(m_buffer, (size_t)m_numBytes);
+  else
+    h = hashShort(m_buffer, (size_t)m_numBytes);
+
+  // canonical representation, big endian
+  for (int i = 0; i < 8; i++)
+  {
+    buffer[i]     = (unsigned char)(h.high >> (56 - 8 * i));
+    buffer[i + 8] = (unsigned char)(h.low  >> (56 - 8 * i));
+  }
+}
+
+
+/// return latest hash as 32 hex characters
+std::string XXH3_128::getHash()
+{
+  // compute hash
+  unsigned char rawHash[HashBytes];
+  getHash(rawHash);
+
+  // convert to hex string
+  std::string result;
+  result.reserve(2 * HashBytes);
+  for (int i = 0; i < HashBytes; i++)
+  {
+    static const char dec2hex[16+1] = "0123456789abcdef";
+    result += dec2hex[(rawHash[i] >> 4) & 15];
+    result += dec2hex[ rawHash[i]       & 15];
+  }
+
+  return result;
+}
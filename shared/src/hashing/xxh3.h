@@ -0,0 +1,58 @@
+// //////////////////////////////////////////////////////////
+// xxh3.h
+// XXH3 128 bit hash, compatible with xxHash 0.8 XXH3_128bits()
+// using the default secret and seed 0.
+//
+
+#pragma once
+
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/// compute XXH3 128 bit hash
+/** Usage:
+    XXH3_128 xxh3;
+    while (more data available)
+      xxh3.add(pointer to fresh data, number of new bytes);
+    unsigned char digest[XXH3_128::HashBytes];
+    xxh3.getHash(digest);
+
+    The digest is stored in canonical form, high 64 bits first, both big endian.
+  */
+class XXH3_128
+{
+public:
+  /// stripes of 64 bytes, internal buffer of 4 stripes, hash is 16 bytes long
+  enum { StripeSize = 64, BufferSize = 256, HashBytes = 16 };
+
+  /// same as reset()
+  XXH3_128();
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as 32 hex characters
+  std::string getHash();
+  /// return latest hash as bytes
+  void        getHash(unsigned char buffer[HashBytes]);
+
+  /// restart
+  void reset();
+
+private:
+  /// consume stripes, scrambling accumulators at the end of each block
+  void consumeStripes(const uint8_t* data, size_t numStripes);
+
+  /// accumulators
+  uint64_t m_acc[8];
+  /// stripes consumed in current block
+  size_t   m_numStripes;
+  /// size of processed data in bytes
+  uint64_t m_numBytes;
+  /// valid bytes in m_buffer
+  size_t   m_bufferSize;
+  /// bytes not processed yet. last stripe is kept to finish long inputs
+  uint8_t  m_buffer[BufferSize];
+};
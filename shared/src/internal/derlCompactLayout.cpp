@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "derlCompactLayout.h"
+
+#include <denetwork/message/denMessageReader.h>
+#include <denetwork/message/denMessageWriter.h>
+
+
+// Class derlCompactLayout
+////////////////////////////
+
+// Encoding
+/////////////
+
+void derlCompactLayout::WriteVarUInt(denMessageWriter &writer, uint64_t value){
+	while(value >= 0x80){
+		writer.WriteByte((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	writer.WriteByte((uint8_t)value);
+}
+
+uint64_t derlCompactLayout::ReadVarUInt(denMessageReader &reader){
+	uint64_t value = 0;
+	int shift;
+	
+	for(shift=0; shift<64; shift+=7){
+		const uint8_t byte = reader.ReadByte();
+		value |= (uint64_t)(byte & 0x7f) << shift;
+		if((byte & 0x80) == 0){
+			return value;
+		}
+	}
+	
+	throw std::runtime_error("Invalid variable length integer");
+}
+
+void derlCompactLayout::WritePath(denMessageWriter &writer,
+const std::string &path, std::string &previousPath){
+	const std::string::size_type maxPrefix = std::min(path.size(), previousPath.size());
+	std::string::size_type prefix = 0;
+	while(prefix < maxPrefix && path[prefix] == previousPath[prefix]){
+		prefix++;
+	}
+	
+	const std::string::size_type suffix = path.size() - prefix;
+	WriteVarUInt(writer, prefix);
+	WriteVarUInt(writer, suffix);
+	if(suffix > 0){
+		writer.Write(path.c_str() + prefix, suffix);
+	}
+	
+	previousPath = path;
+}
+
+const std::string &derlCompactLayout::ReadPath(denMessageReader &reader, std::string &previousPath){
+	const uint64_t prefix = ReadVarUInt(reader);
+	const uint64_t suffix = ReadVarUInt(reader);
+	if(prefix > previousPath.size() || suffix > reader.GetLength() - reader.GetPosition()){
+		throw std::runtime_error("Invalid front coded path");
+	}
+	
+	previousPath.resize((std::string::size_type)(prefix + suffix));
+	if(suffix > 0){
+		reader.Read(&previousPath[(std::string::size_type)prefix], (size_t)suffix);
+	}
+	return previousPath;
+}
@@ -0,0 +1,70 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLCOMPACTLAYOUT_H_
+#define _DERLCOMPACTLAYOUT_H_
+
+#include <string>
+#include <stdint.h>
+
+class denMessageReader;
+class denMessageWriter;
+
+
+/**
+ * \brief Compact file layout encoding.
+ * 
+ * Files are written sorted by path. Each path is front coded against the previous path
+ * as variable length shared prefix length, suffix length and suffix. Sizes are written
+ * as variable length unsigned integers using 7 bits per byte.
+ * 
+ * For internal use.
+ */
+class derlCompactLayout{
+public:
+	/** \name Encoding */
+	/*@{*/
+	/** \brief Write variable length unsigned integer. */
+	static void WriteVarUInt(denMessageWriter &writer, uint64_t value);
+	
+	/** \brief Read variable length unsigned integer. */
+	static uint64_t ReadVarUInt(denMessageReader &reader);
+	
+	/**
+	 * \brief Write path front coded against previous path.
+	 * 
+	 * Previous path is set to path. Use empty previous path for the first path.
+	 */
+	static void WritePath(denMessageWriter &writer, const std::string &path, std::string &previousPath);
+	
+	/**
+	 * \brief Read path front coded against previous path.
+	 * 
+	 * Previous path is set to read path. Use empty previous path for the first path.
+	 */
+	static const std::string &ReadPath(denMessageReader &reader, std::string &previousPath);
+	/*@}*/
+};
+
+#endif
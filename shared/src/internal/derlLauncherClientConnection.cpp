@@ -30,6 +30,7 @@
 #include "../derlLauncherClient.h"
 #include "../derlProtocol.h"
 #include "../derlRunParameters.h"
+#include "derlCompactLayout.h"
 
 #include <denetwork/message/denMessage.h>
 #include <denetwork/message/denMessageReader.h>
@@ -48,10 +49,13 @@ derlLauncherClientConnection::derlLauncherClientConnection(derlLauncherClient &c
 pClient(client),
 pConnectionAccepted(false),
 pEnabledFeatures(0),
+pLayoutHashFeatures(0),
 pEnableDebugLog(false),
 pStateRun(std::make_shared<denState>(false)),
 pValueRunStatus(std::make_shared<denValueInt>(denValueIntegerFormat::uint8)),
-pPendingRequestLayout(false)
+pPendingRequestLayout(false),
+pRequestLayoutPages(false),
+pLayoutPagesSent(false)
 {
 	pValueRunStatus->SetValue((uint64_t)derlProtocol::RunStateStatus::stopped);
 	pStateRun->AddValue(pValueRunStatus);
@@ -68,6 +72,11 @@ void derlLauncherClientConnection::SetEnableDebugLog(bool enable){
 	pEnableDebugLog = enable;
 }
 
+derlHasher::Algorithm derlLauncherClientConnection::GetHashAlgorithm() const{
+	return (pEnabledFeatures & (uint32_t)derlProtocol::Features::fastHash) != 0
+		? derlHasher::Algorithm::xxh3 : derlHasher::Algorithm::sha256;
+}
+
 void derlLauncherClientConnection::SetLogger(const denLogger::Ref &logger){
 	denConnection::SetLogger(logger);
 	pStateRun->SetLogger(logger);
@@ -78,7 +87,23 @@ void derlLauncherClientConnection::SetLogger(const denLogger::Ref &logger){
 void derlLauncherClientConnection::ConnectionEstablished(){
 	const denMessage::Ref message(denMessage::Pool().Get());
 	{
-		uint32_t supportedFeatures = 0;
+		uint32_t supportedFeatures = (uint32_t)derlProtocol::Features::binaryDigest
+			| (uint32_t)derlProtocol::Features::treeHash
+			| (uint32_t)derlProtocol::Features::layoutPages
+			| (uint32_t)derlProtocol::Features::compactLayout
+			| (uint32_t)derlProtocol::Features::layoutChanges
+			| (uint32_t)derlProtocol::Features::rollingDelta
+			| (uint32_t)derlProtocol::Features::contentChunks
+			| (uint32_t)derlProtocol::Features::partialResize
+			| (uint32_t)derlProtocol::Features::compression
+			| (uint32_t)derlProtocol::Features::fileBundles
+			| (uint32_t)derlProtocol::Features::zeroBlocks;
+		if(pClient.GetEnableFastHash()){
+			supportedFeatures |= (uint32_t)derlProtocol::Features::fastHash;
+		}
+		if(pClient.GetWriteJournal()){
+			supportedFeatures |= (uint32_t)derlProtocol::Features::resumeWrite;
+		}
 		
 		denMessageWriter writer(message->Item());
 		writer.WriteByte((uint8_t)derlProtocol::MessageCodes::connectRequest);
@@ -149,7 +174,7 @@ bool derlLauncherClientConnection::ProcessReceivedMessages(){
 		
 		switch(code){
 		case derlProtocol::MessageCodes::requestFileLayout:
-			pProcessRequestLayout();
+			pProcessRequestLayout(reader);
 			break;
 			
 		case derlProtocol::MessageCodes::requestFileBlockHashes:
@@ -172,6 +197,10 @@ bool derlLauncherClientConnection::ProcessReceivedMessages(){
 			pProcessRequestFinishWriteFile(reader);
 			break;
 			
+		case derlProtocol::MessageCodes::sendFileBundle:
+			pProcessSendFileBundle(reader);
+			break;
+			
 		case derlProtocol::MessageCodes::startApplication:
 			pProcessStartApplication(reader);
 			break;
@@ -203,9 +232,31 @@ void derlLauncherClientConnection::OnFileLayoutChanged(){
 		return;
 	}
 	
+	{
+	const std::lock_guard guard(derlGlobal::mutexNetwork);
+	if(pLayoutPagesSent){
+		// file layout has been send as pages while building it
+		pLayoutPagesSent = false;
+		pPendingRequestLayout = false;
+	}
+	}
+	
+	if(!pPendingRequestLayout){
+		const derlTaskFileBlockHashes::List deferred(std::move(pDeferredFileBlockHashes));
+		pDeferredFileBlockHashes.clear();
+		for(const derlTaskFileBlockHashes::Ref &each : deferred){
+			pProcessFileBlockHashes(each);
+		}
+		return;
+	}
+	
 	const derlFileLayout::Ref layout(pClient.GetFileLayoutSync());
 	if(layout){
 		pPendingRequestLayout = false;
+		{
+		const std::lock_guard guard(derlGlobal::mutexNetwork);
+		pRequestLayoutPages = false;
+		}
 		if(GetConnected()){
 			pSendResponseFileLayout(*layout);
 		}
@@ -215,6 +266,63 @@ void derlLauncherClientConnection::OnFileLayoutChanged(){
 	}
 }
 
+bool derlLauncherClientConnection::BeginLayoutPages(){
+	const std::lock_guard guard(derlGlobal::mutexNetwork);
+	if(!pRequestLayoutPages){
+		return false;
+	}
+	
+	pRequestLayoutPages = false;
+	return GetConnected();
+}
+
+void derlLauncherClientConnection::SendResponseFileLayoutPage(const derlFile::List &files){
+	const std::lock_guard guard(derlGlobal::mutexNetwork);
+	if(!GetConnected()){
+		return;
+	}
+	
+	const denMessage::Ref message(denMessage::Pool().Get());
+	{
+		denMessageWriter writer(message->Item());
+		writer.WriteByte((uint8_t)derlProtocol::MessageCodes::responseFileLayoutPage);
+		writer.WriteUInt((uint32_t)files.size());
+		pWriteLayoutFiles(writer, files);
+	}
+	pQueueSend.Add(message);
+}
+
+void derlLauncherClientConnection::EndLayoutPages(bool success, int count,
+uint64_t identifier, uint64_t generation){
+	SendResponseFileLayoutFinished(success, count, identifier, generation);
+	
+	const std::lock_guard guard(derlGlobal::mutexNetwork);
+	pLayoutPagesSent = true;
+}
+
+void derlLauncherClientConnection::SendResponseFileLayoutFinished(bool success, int count,
+uint64_t identifier, uint64_t generation){
+	const std::lock_guard guard(derlGlobal::mutexNetwork);
+	if(!GetConnected()){
+		return;
+	}
+	
+	const denMessage::Ref message(denMessage::Pool().Get());
+	{
+		denMessageWriter writer(message->Item());
+		writer.WriteByte((uint8_t)derlProtocol::MessageCodes::responseFileLayoutFinished);
+		writer.WriteByte((uint8_t)(success ? derlProtocol::FileLayoutResult::success
+			: derlProtocol::FileLayoutResult::failure));
+		writer.WriteUInt((uint32_t)count);
+		
+		if((pEnabledFeatures & (uint32_t)derlProtocol::Features::layoutChanges) != 0){
+			writer.WriteULong(identifier);
+			writer.WriteULong(generation);
+		}
+	}
+	pQueueSend.Add(message);
+}
+
 void derlLauncherClientConnection::LogException(const std::string &functionName,
 const std::exception &exception, const std::string &message){
 	std::stringstream ss;
@@ -256,7 +364,7 @@ const std::string &path, uint32_t blockSize){
 	pQueueSend.Add(message);
 }
 
-void derlLauncherClientConnection::SendResponseFileBlockHashes(const derlFile &file){
+void derlLauncherClientConnection::SendResponseFileBlockHashes(const derlFile &file, bool weakHashes){
 	const std::lock_guard guard(derlGlobal::mutexNetwork);
 	if(!GetConnected()){
 		return;
@@ -273,7 +381,14 @@ void derlLauncherClientConnection::SendResponseFileBlockHashes(const derlFile &f
 		writer.WriteString16(path);
 		writer.WriteUInt((uint32_t)count);
 		for(i=0; i<count; i++){
-			writer.WriteString8(file.GetBlockAt(i)->GetHash());
+			const derlFileBlock &block = *file.GetBlockAt(i);
+			derlHasher::WriteDigest(writer, block.GetHash(), GetHashAlgorithm(), pEnabledFeatures);
+			if(file.GetContentChunks()){
+				writer.WriteUInt((uint32_t)block.GetSize());
+				
+			}else if(weakHashes){
+				writer.WriteUInt(block.GetWeakHash());
+			}
 		}
 		pQueueSend.Add(message);
 	}
@@ -341,6 +456,19 @@ void derlLauncherClientConnection::SendResponseWriteFile(const derlTaskFileWrite
 		if(task.GetStatus() == derlTaskFileWrite::Status::processing){
 			writer.WriteByte((uint8_t)derlProtocol::WriteFileResult::success);
 			
+			if((pEnabledFeatures & (uint32_t)derlProtocol::Features::resumeWrite) != 0){
+				const std::vector<bool> &blocks = task.GetResumeBlocks();
+				std::string bitmap((blocks.size() + 7) / 8, 0);
+				size_t i;
+				for(i=0; i<blocks.size(); i++){
+					if(blocks[i]){
+						bitmap[i / 8] |= (char)(1 << (i % 8));
+					}
+				}
+				writer.WriteUInt((uint32_t)bitmap.size());
+				writer.Write((void*)bitmap.c_str(), bitmap.size());
+			}
+			
 		}else{
 			writer.WriteByte((uint8_t)derlProtocol::WriteFileResult::failure);
 		}
@@ -392,6 +520,38 @@ void derlLauncherClientConnection::SendResponseFinishWriteFile(const derlTaskFil
 	pQueueSend.Add(message);
 }
 
+void derlLauncherClientConnection::SendResponseFileBundle(const derlTaskFileBundle &task){
+	const std::lock_guard guard(derlGlobal::mutexNetwork);
+	if(!GetConnected()){
+		return;
+	}
+	
+	const denMessage::Ref message(denMessage::Pool().Get());
+	{
+		denMessageWriter writer(message->Item());
+		writer.WriteByte((uint8_t)derlProtocol::MessageCodes::responseFileBundle);
+		writer.WriteUInt((uint32_t)task.GetFiles().size());
+		
+		for(const derlTaskFileWrite::Ref &file : task.GetFiles()){
+			writer.WriteString16(file->GetPath());
+			
+			switch(file->GetStatus()){
+			case derlTaskFileWrite::Status::success:
+				writer.WriteByte((uint8_t)derlProtocol::FinishWriteFileResult::success);
+				break;
+				
+			case derlTaskFileWrite::Status::validationFailed:
+				writer.WriteByte((uint8_t)derlProtocol::FinishWriteFileResult::validationFailed);
+				break;
+				
+			default:
+				writer.WriteByte((uint8_t)derlProtocol::FinishWriteFileResult::failure);
+			}
+		}
+	}
+	pQueueSend.Add(message);
+}
+
 void derlLauncherClientConnection::SendResponseSystemPropertyNoLock(
 const std::string &property, const std::string &value){
 	if(!GetConnected()){
@@ -475,20 +635,46 @@ void derlLauncherClientConnection::pMessageReceivedConnect(denMessage &message){
 	}
 	
 	pEnabledFeatures = reader.ReadUInt();
+	
+	// layout hashes are only valid for the hash features they have been calculated with
+	const uint32_t hashFeatures = pEnabledFeatures & ((uint32_t)derlProtocol::Features::fastHash
+		| (uint32_t)derlProtocol::Features::treeHash);
+	if(hashFeatures != pLayoutHashFeatures){
+		pLayoutHashFeatures = hashFeatures;
+		pClient.SetDirtyFileLayoutSync(true);
+	}
+	
 	pConnectionAccepted = true;
 	pClient.OnConnectionEstablished();
 }
 
-void derlLauncherClientConnection::pProcessRequestLayout(){
+void derlLauncherClientConnection::pProcessRequestLayout(denMessageReader &reader){
 	Log(denLogger::LogSeverity::info, "pProcessRequestLayout", "Layout request received");
+	pDeferredFileBlockHashes.clear();
+	pClient.ClearWriteFilesSync();
+	
+	uint64_t identifier = 0, generation = 0;
+	if((pEnabledFeatures & (uint32_t)derlProtocol::Features::layoutChanges) != 0){
+		identifier = reader.ReadULong();
+		generation = reader.ReadULong();
+	}
+	
 	const derlFileLayout::Ref layout(pClient.GetFileLayoutSync());
 	if(layout){
 		pPendingRequestLayout = false;
-		pSendResponseFileLayout(*layout);
+		if(identifier == 0 || identifier != layout->GetIdentifier()
+		|| !pSendResponseFileLayoutChanges(*layout, generation)){
+			pSendResponseFileLayout(*layout);
+		}
 		
 	}else{
 		pPendingRequestLayout = true;
 		{
+		const std::lock_guard guard(derlGlobal::mutexNetwork);
+		pRequestLayoutPages = (pEnabledFeatures & (uint32_t)derlProtocol::Features::layoutPages) != 0;
+		pLayoutPagesSent = false;
+		}
+		{
 		const std::lock_guard guard(pClient.GetMutexPendingTasks());
 		if(!pClient.HasPendingTasksWithType(derlBaseTask::Type::fileLayout)){
 			pClient.GetPendingTasks().push_back(std::make_shared<derlTaskFileLayout>());
@@ -501,20 +687,41 @@ void derlLauncherClientConnection::pProcessRequestLayout(){
 void derlLauncherClientConnection::pProcessRequestFileBlockHashes(denMessageReader &reader){
 	const std::string path(reader.ReadString16());
 	const uint32_t blockSize = reader.ReadUInt();
+	const derlTaskFileBlockHashes::Ref task(std::make_shared<derlTaskFileBlockHashes>(path, blockSize));
+	if((pEnabledFeatures & (uint32_t)derlProtocol::Features::contentChunks) != 0){
+		task->SetContentChunks(reader.ReadByte() != 0);
+	}
+	if((pEnabledFeatures & (uint32_t)derlProtocol::Features::rollingDelta) != 0){
+		task->SetWeakHashes(reader.ReadByte() != 0);
+	}
 	
 	{
 	std::stringstream ss;
-	ss << "Calculate file block hashes received: " << path << " blockSize " << (int)blockSize;
+	ss << "Calculate file block hashes received: " << path << " blockSize " << (int)blockSize
+		<< (task->GetContentChunks() ? " chunks" : "") << (task->GetWeakHashes() ? " weak" : "");
 	Log(denLogger::LogSeverity::info, "pProcessRequestFileBlockHashes", ss.str());
 	}
 	
+	if(pPendingRequestLayout){
+		// server requests block hashes while receiving file layout pages
+		pDeferredFileBlockHashes.push_back(task);
+		return;
+	}
+	
+	pProcessFileBlockHashes(task);
+}
+
+void derlLauncherClientConnection::pProcessFileBlockHashes(const derlTaskFileBlockHashes::Ref &task){
+	const std::string &path = task->GetPath();
+	const uint32_t blockSize = (uint32_t)task->GetBlockSize();
+	
 	const derlFileLayout::Ref layout(pClient.GetFileLayoutSync());
 	if(!layout){
 		std::stringstream log;
 		log << "Block hashes for file requested but file layout is not present: "
 			<< path << ". Answering with empty file.";
 		Log(denLogger::LogSeverity::warning, "pProcessRequestFileBlockHashes", log.str());
-		SendResponseFileBlockHashes(path);
+		SendResponseFileBlockHashes(path, blockSize);
 		return;
 	}
 	
@@ -524,12 +731,22 @@ void derlLauncherClientConnection::pProcessRequestFileBlockHashes(denMessageRead
 		log << "Block hashes for non-existing file requested: "
 			<< path << ". Answering with empty file.";
 		Log(denLogger::LogSeverity::warning, "pProcessRequestFileBlockHashes", log.str());
-		SendResponseFileBlockHashes(path);
+		SendResponseFileBlockHashes(path, blockSize);
 		return;
 	}
 	
-	if(file->GetHasBlocks() && file->GetBlockSize() == blockSize){
-		SendResponseFileBlockHashes(*file);
+	if(task->GetContentChunks()){
+		// chunks are only send but not stored in the file layout
+		pClient.AddPendingTaskSync(task);
+		
+	}else if(file->GetHasBlocks() && file->GetBlockCount() > 0 && file->GetBlockSize() == blockSize
+	&& !file->GetContentChunks() && (!task->GetWeakHashes() || file->GetHasWeakHashes())){
+		SendResponseFileBlockHashes(*file, task->GetWeakHashes());
+		
+	}else if(file->GetHasBlocks() && file->GetBlockCount() > 0 && file->GetBlockSize() == blockSize
+	&& !file->GetContentChunks()){
+		// weak hashes are only calculated on request. processor adds them to the blocks
+		pClient.AddPendingTaskSync(task);
 		
 	}else{
 		file = std::make_shared<derlFile>(*file);
@@ -537,7 +754,7 @@ void derlLauncherClientConnection::pProcessRequestFileBlockHashes(denMessageRead
 		file->SetBlockSize(blockSize);
 		layout->SetFileAtSync(path, file);
 		
-		pClient.AddPendingTaskSync(std::make_shared<derlTaskFileBlockHashes>(path, blockSize));
+		pClient.AddPendingTaskSync(task);
 	}
 }
 
@@ -578,16 +795,24 @@ void derlLauncherClientConnection::pProcessRequestWriteFile(denMessageReader &re
 	task->SetFileSize(reader.ReadULong());
 	task->SetBlockSize(reader.ReadULong());
 	task->SetBlockCount((int)reader.ReadUInt());
-	task->SetTruncate(file && file->GetSize() != task->GetFileSize());
+	if((pEnabledFeatures & ((uint32_t)derlProtocol::Features::rollingDelta
+	| (uint32_t)derlProtocol::Features::contentChunks)) != 0){
+		task->SetDelta(reader.ReadByte() != 0);
+	}
+	if((pEnabledFeatures & (uint32_t)derlProtocol::Features::resumeWrite) != 0){
+		task->SetHash(derlHasher::ReadDigest(reader, GetHashAlgorithm(), pEnabledFeatures));
+	}
+	task->SetTruncate(!task->GetDelta() && file && file->GetSize() != task->GetFileSize());
 	
 	pWriteFileTasks[path] = task;
+	pClient.BeginWriteFileSync(path);
 	pClient.AddPendingTaskSync(task);
 	
 	if(pEnableDebugLog){
 		std::stringstream log;
 		log << "Request write file received: " << path << " fileSize " << task->GetFileSize()
 			<< " blockSize " << task->GetBlockSize() << " blockCount " << task->GetBlockCount()
-			<< " truncate " << task->GetTruncate();
+			<< " truncate " << task->GetTruncate() << " delta " << task->GetDelta();
 		LogDebug("pProcessRequestWriteFile", log.str());
 	}
 }
@@ -596,6 +821,12 @@ void derlLauncherClientConnection::pProcessSendFileData(denMessageReader &reader
 	const std::string path(reader.ReadString16());
 	const int indexBlock = reader.ReadUInt();
 	
+	derlProtocol::Compression compression = derlProtocol::Compression::none;
+	if((pEnabledFeatures & ((uint32_t)derlProtocol::Features::compression
+	| (uint32_t)derlProtocol::Features::zeroBlocks)) != 0){
+		compression = (derlProtocol::Compression)reader.ReadByte();
+	}
+	
 	const uint64_t size = (uint64_t)(reader.GetLength() - reader.GetPosition());
 	
 	const derlTaskFileWrite::Map::const_iterator iterWrite(pWriteFileTasks.find(path));
@@ -619,11 +850,83 @@ void derlLauncherClientConnection::pProcessSendFileData(denMessageReader &reader
 	const uint64_t blockOffset = taskWrite.GetBlockSize() * indexBlock;
 	const uint64_t blockSize = std::min(taskWrite.GetBlockSize(), taskWrite.GetFileSize() - blockOffset);
 	
+	if(compression != derlProtocol::Compression::none
+	&& compression != derlProtocol::Compression::lz4
+	&& (compression != derlProtocol::Compression::zero || taskWrite.GetDelta())){
+		std::stringstream log;
+		log << "Send file data received but compression is invalid: "
+			<< path << " index " << indexBlock;
+		Log(denLogger::LogSeverity::warning, "pProcessSendFileData", log.str());
+		taskWrite.SetStatus(derlTaskFileWrite::Status::failure);
+		return;
+	}
+	
 	derlTaskFileWriteBlock::Ref taskBlock(std::make_shared<derlTaskFileWriteBlock>(
 		taskWrite, indexBlock, blockSize));
-	taskBlock->GetData().assign(blockSize, 0);
+	taskBlock->SetCompressed(compression == derlProtocol::Compression::lz4);
+	taskBlock->SetZero(compression == derlProtocol::Compression::zero);
+	
+	if(taskBlock->GetZero()){
+		// block is left as hole in the file by the task processor
+		
+	}else if(taskWrite.GetDelta()){
+		derlTaskFileWriteBlock::Instructions &instructions = taskBlock->GetInstructions();
+		const int count = (int)reader.ReadUInt();
+		uint64_t literalOffset = 0, targetSize = 0;
+		int i;
+		
+		for(i=0; i<count; i++){
+			derlTaskFileWriteBlock::Instruction instruction;
+			const derlProtocol::DeltaInstruction type = (derlProtocol::DeltaInstruction)reader.ReadByte();
+			
+			if(type == derlProtocol::DeltaInstruction::copy){
+				instruction.type = derlTaskFileWriteBlock::InstructionType::copy;
+				instruction.offset = reader.ReadULong();
+				instruction.size = reader.ReadULong();
+				
+			}else if(type == derlProtocol::DeltaInstruction::literal){
+				instruction.type = derlTaskFileWriteBlock::InstructionType::literal;
+				instruction.offset = literalOffset;
+				instruction.size = reader.ReadULong();
+				literalOffset += instruction.size;
+				
+			}else{
+				std::stringstream log;
+				log << "Send file data received but delta instruction is invalid: "
+					<< path << " index " << indexBlock;
+				Log(denLogger::LogSeverity::warning, "pProcessSendFileData", log.str());
+				taskWrite.SetStatus(derlTaskFileWrite::Status::failure);
+				return;
+			}
+			
+			instructions.push_back(instruction);
+			targetSize += instruction.size;
+		}
+		
+		const uint64_t dataSize = (uint64_t)(reader.GetLength() - reader.GetPosition());
+		if(targetSize != blockSize || (!taskBlock->GetCompressed() && literalOffset != dataSize)){
+			std::stringstream log;
+			log << "Send file data received but delta size does not match: "
+				<< path << " index " << indexBlock << " size " << targetSize
+				<< " literal " << literalOffset << " data " << dataSize;
+			Log(denLogger::LogSeverity::warning, "pProcessSendFileData", log.str());
+			taskWrite.SetStatus(derlTaskFileWrite::Status::failure);
+			return;
+		}
+		
+		taskBlock->GetData().assign(dataSize, 0);
+		reader.Read((void*)taskBlock->GetData().c_str(), dataSize);
+		
+	}else if(taskBlock->GetCompressed()){
+		// decompressed by task processor
+		taskBlock->GetData().assign(size, 0);
+		reader.Read((void*)taskBlock->GetData().c_str(), size);
+		
+	}else{
+		taskBlock->GetData().assign(blockSize, 0);
+		reader.Read((void*)taskBlock->GetData().c_str(), size);
+	}
 	taskBlock->SetStatus(derlTaskFileWriteBlock::Status::dataReady);
-	reader.Read((void*)taskBlock->GetData().c_str(), size);
 	
 	pClient.AddPendingTaskSync(taskBlock);
 	
@@ -659,7 +962,7 @@ void derlLauncherClientConnection::pProcessRequestFinishWriteFile(denMessageRead
 		return;
 	}
 	
-	task.SetHash(reader.ReadString8());
+	task.SetHash(derlHasher::ReadDigest(reader, GetHashAlgorithm(), pEnabledFeatures));
 	task.SetStatus(derlTaskFileWrite::Status::finishing);
 	}
 	
@@ -668,6 +971,73 @@ void derlLauncherClientConnection::pProcessRequestFinishWriteFile(denMessageRead
 	pWriteFileTasks.erase(iterTask);
 }
 
+void derlLauncherClientConnection::pProcessSendFileBundle(denMessageReader &reader){
+	const bool compression = (pEnabledFeatures & (uint32_t)derlProtocol::Features::compression) != 0;
+	const derlTaskFileBundle::Ref task(std::make_shared<derlTaskFileBundle>());
+	const int count = reader.ReadUInt();
+	int i;
+	
+	for(i=0; i<count; i++){
+		const derlTaskFileWrite::Ref file(std::make_shared<derlTaskFileWrite>(reader.ReadString16()));
+		file->SetFileSize(reader.ReadULong());
+		file->SetBlockSize(reader.ReadULong());
+		file->SetHash(derlHasher::ReadDigest(reader, GetHashAlgorithm(), pEnabledFeatures));
+		file->SetBundled(true);
+		
+		derlProtocol::Compression fileCompression = derlProtocol::Compression::none;
+		if(compression){
+			fileCompression = (derlProtocol::Compression)reader.ReadByte();
+		}
+		
+		const uint64_t dataSize = reader.ReadUInt();
+		
+		if(file->GetFileSize() > 0){
+			file->SetBlockCount(1);
+			
+			const derlTaskFileWriteBlock::Ref block(std::make_shared<derlTaskFileWriteBlock>(
+				*file, 0, file->GetFileSize()));
+			block->GetData().assign(dataSize, 0);
+			reader.Read((void*)block->GetData().c_str(), dataSize);
+			block->SetCompressed(fileCompression == derlProtocol::Compression::lz4);
+			file->GetBlocks().push_back(block);
+			
+			if((fileCompression != derlProtocol::Compression::none
+			&& fileCompression != derlProtocol::Compression::lz4)
+			|| (!block->GetCompressed() && dataSize != file->GetFileSize())){
+				std::stringstream log;
+				log << "Send file bundle received but file data is invalid: " << file->GetPath();
+				Log(denLogger::LogSeverity::warning, "pProcessSendFileBundle", log.str());
+				file->SetStatus(derlTaskFileWrite::Status::failure);
+			}
+			
+		}else if(dataSize > 0){
+			std::stringstream log;
+			log << "Send file bundle received but file data is invalid: " << file->GetPath();
+			Log(denLogger::LogSeverity::warning, "pProcessSendFileBundle", log.str());
+			file->SetStatus(derlTaskFileWrite::Status::failure);
+			
+			std::string data;
+			data.assign(dataSize, 0);
+			reader.Read((void*)data.c_str(), dataSize);
+		}
+		
+		task->GetFiles().push_back(file);
+		
+		// invalid files are not written and thus never finished
+		if(file->GetStatus() == derlTaskFileWrite::Status::pending){
+			pClient.BeginWriteFileSync(file->GetPath());
+		}
+	}
+	
+	{
+	std::stringstream ss;
+	ss << "Send file bundle received: " << count << " file(s)";
+	Log(denLogger::LogSeverity::info, "pProcessSendFileBundle", ss.str());
+	}
+	
+	pClient.AddPendingTaskSync(task);
+}
+
 void derlLauncherClientConnection::pProcessStartApplication(denMessageReader &reader){
 	derlRunParameters params;
 	params.SetGameConfig(reader.ReadString16());
@@ -702,40 +1072,143 @@ void derlLauncherClientConnection::pProcessRequestSystemProperty(denMessageReade
 	}
 }
 
-void derlLauncherClientConnection::pSendResponseFileLayout(const derlFileLayout &layout){
+void derlLauncherClientConnection::pSendResponseFileLayout(derlFileLayout &layout){
+	derlFile::List files;
+	uint64_t identifier, generation;
+	{
+	const std::lock_guard guard(layout.GetMutex());
+	derlFile::Map::const_iterator iter;
+	for(iter=layout.GetFilesBegin(); iter!=layout.GetFilesEnd(); iter++){
+		files.push_back(iter->second);
+	}
+	identifier = layout.GetIdentifier();
+	generation = layout.GetGeneration();
+	}
+	
+	if((pEnabledFeatures & (uint32_t)derlProtocol::Features::compactLayout) != 0){
+		// sorting the entire layout keeps front coding effective across pages
+		std::sort(files.begin(), files.end(), [](const derlFile::Ref &a, const derlFile::Ref &b){
+			return a->GetPath() < b->GetPath();
+		});
+	}
+	
+	if((pEnabledFeatures & (uint32_t)derlProtocol::Features::layoutPages) != 0){
+		const int count = (int)files.size();
+		int i;
+		for(i=0; i<count; i+=LayoutPageSize){
+			SendResponseFileLayoutPage(derlFile::List(files.cbegin() + i,
+				files.cbegin() + std::min(i + LayoutPageSize, count)));
+		}
+		
+		SendResponseFileLayoutFinished(true, count, identifier, generation);
+		return;
+	}
+	
 	const std::lock_guard guard(derlGlobal::mutexNetwork);
 	if(!GetConnected()){
 		return;
 	}
+	
+	const denMessage::Ref message(denMessage::Pool().Get());
+	{
+	denMessageWriter writer(message->Item());
+	writer.WriteByte((uint8_t)derlProtocol::MessageCodes::responseFileLayout);
+	
+	writer.WriteUInt((uint32_t)files.size());
+	pWriteLayoutFiles(writer, files);
+	
+	if((pEnabledFeatures & (uint32_t)derlProtocol::Features::layoutChanges) != 0){
+		writer.WriteULong(identifier);
+		writer.WriteULong(generation);
+	}
+	}
+	pQueueSend.Add(message);
+}
 
-	if(layout.GetFileCount() == 0){
-		const denMessage::Ref message(denMessage::Pool().Get());
-		{
-			denMessageWriter writer(message->Item());
-			writer.WriteByte((uint8_t)derlProtocol::MessageCodes::responseFileLayout);
-			writer.WriteUInt(0);
-		}
-		pQueueSend.Add(message);
-		return;
+bool derlLauncherClientConnection::pSendResponseFileLayoutChanges(
+derlFileLayout &layout, uint64_t generation){
+	derlFile::List changed;
+	derlFileLayout::ListPath removed;
+	uint64_t identifier, currentGeneration;
+	{
+	const std::lock_guard guard(layout.GetMutex());
+	if(!layout.CanGetChangesSince(generation)){
+		return false;
+	}
+	
+	layout.GetChangesSince(generation, changed, removed);
+	
+	// if many files changed sending the file layout is cheaper
+	if((changed.size() + removed.size()) * 2 > (size_t)layout.GetFileCount()
+	&& changed.size() + removed.size() > (size_t)LayoutPageSize){
+		return false;
+	}
+	
+	identifier = layout.GetIdentifier();
+	currentGeneration = layout.GetGeneration();
+	}
+	
+	{
+	std::stringstream ss;
+	ss << "Send file layout changes since generation " << generation << ": "
+		<< changed.size() << " changed, " << removed.size() << " removed";
+	Log(denLogger::LogSeverity::info, "pSendResponseFileLayoutChanges", ss.str());
+	}
+	
+	const std::lock_guard guard(derlGlobal::mutexNetwork);
+	if(!GetConnected()){
+		return true;
 	}
 	
 	const denMessage::Ref message(denMessage::Pool().Get());
 	{
 	denMessageWriter writer(message->Item());
-	writer.WriteByte((uint8_t)derlProtocol::MessageCodes::responseFileLayout);
+	writer.WriteByte((uint8_t)derlProtocol::MessageCodes::responseFileLayoutChanges);
+	writer.WriteULong(identifier);
+	writer.WriteULong(currentGeneration);
 	
-	const int count = layout.GetFileCount();
-	writer.WriteUInt((uint32_t)count);
+	writer.WriteUInt((uint32_t)changed.size());
+	pWriteLayoutFiles(writer, changed);
 	
-	derlFile::Map::const_iterator iter;
-	for(iter=layout.GetFilesBegin(); iter!=layout.GetFilesEnd(); iter++){
-		const derlFile &file = *iter->second.get();
+	writer.WriteUInt((uint32_t)removed.size());
+	if((pEnabledFeatures & (uint32_t)derlProtocol::Features::compactLayout) != 0){
+		std::sort(removed.begin(), removed.end());
+		std::string previousPath;
+		for(const std::string &path : removed){
+			derlCompactLayout::WritePath(writer, path, previousPath);
+		}
 		
-		writer.WriteString16(file.GetPath());
-		writer.WriteULong(file.GetSize());
-		writer.WriteString8(file.GetHash());
+	}else{
+		for(const std::string &path : removed){
+			writer.WriteString16(path);
+		}
 	}
-	
 	}
 	pQueueSend.Add(message);
+	return true;
+}
+
+void derlLauncherClientConnection::pWriteLayoutFiles(denMessageWriter &writer,
+const derlFile::List &files) const{
+	if((pEnabledFeatures & (uint32_t)derlProtocol::Features::compactLayout) == 0){
+		for(const derlFile::Ref &file : files){
+			writer.WriteString16(file->GetPath());
+			writer.WriteULong(file->GetSize());
+			derlHasher::WriteDigest(writer, file->GetHash(), GetHashAlgorithm(), pEnabledFeatures);
+		}
+		return;
+	}
+	
+	derlFile::List sorted(files);
+	std::sort(sorted.begin(), sorted.end(), [](const derlFile::Ref &a, const derlFile::Ref &b){
+		return a->GetPath() < b->GetPath();
+	});
+	
+	std::string previousPath;
+	for(const derlFile::Ref &file : sorted){
+		derlCompactLayout::WritePath(writer, file->GetPath(), previousPath);
+		derlCompactLayout::WriteVarUInt(writer, file->GetSize());
+		derlHasher::WriteDigest(writer, file->GetHash(), GetHashAlgorithm(), pEnabledFeatures);
+	}
 }
+
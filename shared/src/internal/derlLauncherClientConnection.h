@@ -33,16 +33,19 @@
 #include <denetwork/value/denValueInteger.h>
 
 #include "../derlMessageQueue.h"
+#include "../derlHasher.h"
+#include "../derlFile.h"
 #include "../task/derlTaskFileWrite.h"
+#include "../task/derlTaskFileBundle.h"
 #include "../task/derlTaskFileDelete.h"
 #include "../task/derlTaskFileBlockHashes.h"
 
 
 class derlLauncherClient;
 class derlFileLayout;
-class derlFile;
 
 class denMessageReader;
+class denMessageWriter;
 
 
 /**
@@ -51,19 +54,27 @@ class denMessageReader;
  * For internal use.
  */
 class derlLauncherClientConnection : public denConnection{
+public:
+	/** \brief Count of files send per file layout page. */
+	static const int LayoutPageSize = 500;
+	
+	
 private:
 	typedef std::unique_lock<std::mutex> Lock;
 	
 	derlLauncherClient &pClient;
 	bool pConnectionAccepted;
 	uint32_t pEnabledFeatures;
+	uint32_t pLayoutHashFeatures;
 	bool pEnableDebugLog;
 	
 	const denState::Ref pStateRun;
 	const denValueInt::Ref pValueRunStatus;
 	
 	bool pPendingRequestLayout;
+	bool pRequestLayoutPages, pLayoutPagesSent;
 	derlTaskFileWrite::Map pWriteFileTasks;
+	derlTaskFileBlockHashes::List pDeferredFileBlockHashes;
 	
 	derlMessageQueue pQueueReceived, pQueueSend;
 	
@@ -90,6 +101,12 @@ public:
 	/** \brief Send message queue. */
 	inline derlMessageQueue &GetQueueSend(){ return pQueueSend; }
 	
+	/** \brief Features enabled for connection. */
+	inline uint32_t GetEnabledFeatures() const{ return pEnabledFeatures; }
+	
+	/** \brief Hash algorithm negotiated for connection. */
+	derlHasher::Algorithm GetHashAlgorithm() const;
+	
 	/** \brief Debug logging is enabled. */
 	inline bool GetEnableDebugLog() const{ return pEnableDebugLog; }
 	
@@ -160,6 +177,27 @@ public:
 	/** \brief File layout changed. */
 	void OnFileLayoutChanged();
 	
+	/**
+	 * \brief Begin sending file layout pages while building file layout.
+	 * \returns true if a file layout request is waiting for the file layout to be build
+	 *          and file layout pages are enabled for the connection.
+	 */
+	bool BeginLayoutPages();
+	
+	/**
+	 * \brief End sending file layout pages started with BeginLayoutPages().
+	 * 
+	 * Sends finished message. The pending file layout request is then answered.
+	 */
+	void EndLayoutPages(bool success, int count, uint64_t identifier, uint64_t generation);
+	
+	/** \brief Send file layout page. */
+	void SendResponseFileLayoutPage(const derlFile::List &files);
+	
+	/** \brief Send file layout finished after sending file layout pages. */
+	void SendResponseFileLayoutFinished(bool success, int count,
+		uint64_t identifier, uint64_t generation);
+	
 	/** \brief Log exception. */
 	void LogException(const std::string &functionName, const std::exception &exception,
 		const std::string &message);
@@ -172,12 +210,13 @@ public:
 	void LogDebug(const std::string &functionName, const std::string &message);
 	
 	void SendResponseFileBlockHashes(const std::string &path, uint32_t blockSize);
-	void SendResponseFileBlockHashes(const derlFile &file);
+	void SendResponseFileBlockHashes(const derlFile &file, bool weakHashes);
 	void SendResponseDeleteFile(const derlTaskFileDelete &task);
 	void SendFileDataReceived(const derlTaskFileWriteBlock &block);
 	void SendResponseWriteFile(const derlTaskFileWrite &task);
 	void SendFailResponseWriteFile(const std::string &path);
 	void SendResponseFinishWriteFile(const derlTaskFileWrite &task);
+	void SendResponseFileBundle(const derlTaskFileBundle &task);
 	void SendResponseSystemPropertyNoLock(const std::string &property, const std::string &value);
 	void SendLog(denLogger::LogSeverity severity, const std::string &source, const std::string &log);
 	void SendKeepAlive();
@@ -187,17 +226,22 @@ public:
 private:
 	void pMessageReceivedConnect(denMessage &message);
 	
-	void pProcessRequestLayout();
+	void pProcessRequestLayout(denMessageReader &reader);
 	void pProcessRequestFileBlockHashes(denMessageReader &reader);
+	void pProcessFileBlockHashes(const derlTaskFileBlockHashes::Ref &task);
 	void pProcessRequestDeleteFile(denMessageReader &reader);
 	void pProcessRequestWriteFile(denMessageReader &reader);
 	void pProcessSendFileData(denMessageReader &reader);
 	void pProcessRequestFinishWriteFile(denMessageReader &reader);
+	void pProcessSendFileBundle(denMessageReader &reader);
 	void pProcessStartApplication(denMessageReader &reader);
 	void pProcessStopApplication(denMessageReader &reader);
 	void pProcessRequestSystemProperty(denMessageReader &reader);
 	
-	void pSendResponseFileLayout(const derlFileLayout &layout);
+	void pSendResponseFileLayout(derlFileLayout &layout);
+	bool pSendResponseFileLayoutChanges(derlFileLayout &layout, uint64_t generation);
+	void pWriteLayoutFiles(denMessageWriter &writer, const derlFile::List &files) const;
+	
 };
 
 #endif
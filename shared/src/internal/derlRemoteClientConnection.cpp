@@ -30,6 +30,7 @@
 #include "../derlProtocol.h"
 #include "../derlServer.h"
 #include "../derlGlobal.h"
+#include "derlCompactLayout.h"
 
 #include <denetwork/denServer.h>
 #include <denetwork/message/denMessage.h>
@@ -72,14 +73,29 @@ void derlRemoteClientConnection::StateRun::RemoteValueChanged(denValue &value){
 derlRemoteClientConnection::derlRemoteClientConnection(derlServer &server) :
 pServer(server),
 pClient(nullptr),
-pSupportedFeatures(0),
+pSupportedFeatures((uint32_t)derlProtocol::Features::binaryDigest
+	| (uint32_t)derlProtocol::Features::treeHash
+	| (uint32_t)derlProtocol::Features::layoutPages
+	| (uint32_t)derlProtocol::Features::compactLayout
+	| (uint32_t)derlProtocol::Features::layoutChanges
+	| (uint32_t)derlProtocol::Features::partialResize
+	| (uint32_t)derlProtocol::Features::resumeWrite
+	| (uint32_t)derlProtocol::Features::zeroBlocks
+	| (server.GetEnableFastHash() ? (uint32_t)derlProtocol::Features::fastHash : 0)
+	| (server.GetEnableRollingDelta() ? (uint32_t)derlProtocol::Features::rollingDelta : 0)
+	| (server.GetContentChunkSize() > 0 ? (uint32_t)derlProtocol::Features::contentChunks : 0)
+	| (server.GetEnableCompression() ? (uint32_t)derlProtocol::Features::compression : 0)
+	| (server.GetMaxBundleFileSize() > 0 ? (uint32_t)derlProtocol::Features::fileBundles : 0)),
 pEnabledFeatures(0),
 pEnableDebugLog(false),
 pStateRun(std::make_shared<StateRun>(*this)),
-pMaxInProgressFiles(1),
 pCountInProgressFiles(0),
-pMaxInProgressBlocks(2), //1
-pCountInProgressBlocks(0)
+pCountInProgressBlocks(0),
+pMaxInProgressBundles(2),
+pCountInProgressBundles(0),
+pMaxBundleFileSize(server.GetMaxBundleFileSize()),
+pMaxBundleSize(1048576),
+pMaxBundleFiles(1000)
 {
 	SetLogger(server.GetLogger());
 }
@@ -99,6 +115,11 @@ void derlRemoteClientConnection::SetEnableDebugLog(bool enable){
 	pEnableDebugLog = enable;
 }
 
+derlHasher::Algorithm derlRemoteClientConnection::GetHashAlgorithm() const{
+	return (pEnabledFeatures & (uint32_t)derlProtocol::Features::fastHash) != 0
+		? derlHasher::Algorithm::xxh3 : derlHasher::Algorithm::sha256;
+}
+
 const denValueInt::Ref &derlRemoteClientConnection::GetValueRunStatus() const{
 	return pStateRun->valueRunStatus;
 }
@@ -158,6 +179,18 @@ bool derlRemoteClientConnection::ProcessReceivedMessages(){
 			pProcessResponseFileLayout(reader);
 			break;
 			
+		case derlProtocol::MessageCodes::responseFileLayoutPage:
+			pProcessResponseFileLayoutPage(reader);
+			break;
+			
+		case derlProtocol::MessageCodes::responseFileLayoutFinished:
+			pProcessResponseFileLayoutFinished(reader);
+			break;
+			
+		case derlProtocol::MessageCodes::responseFileLayoutChanges:
+			pProcessResponseFileLayoutChanges(reader);
+			break;
+			
 		case derlProtocol::MessageCodes::responseFileBlockHashes:
 			pProcessResponseFileBlockHashes(reader);
 			break;
@@ -178,6 +211,10 @@ bool derlRemoteClientConnection::ProcessReceivedMessages(){
 			pProcessResponseFinishWriteFile(reader);
 			break;
 			
+		case derlProtocol::MessageCodes::responseFileBundle:
+			pProcessResponseFileBundle(reader);
+			break;
+			
 		case derlProtocol::MessageCodes::responseSystemProperty:
 			pProcessResponseSystemProperty(reader);
 			break;
@@ -196,41 +233,62 @@ bool derlRemoteClientConnection::ProcessReceivedMessages(){
 	return returnValue;
 }
 
+void derlRemoteClientConnection::QueueWriteFiles(derlTaskSyncClient &taskSync,
+const derlTaskFileWrite::List &tasks){
+	const bool bundles = (pEnabledFeatures & (uint32_t)derlProtocol::Features::fileBundles) != 0;
+	
+	for(const derlTaskFileWrite::Ref &taskWrite : tasks){
+		if(bundles && pCanBundleFile(*taskWrite)){
+			taskSync.GetQueueWriteFileBundle().push_back(taskWrite);
+			
+		}else{
+			taskSync.GetQueueWriteFile().push_back(taskWrite);
+		}
+	}
+}
+
 void derlRemoteClientConnection::SendNextWriteRequests(derlTaskSyncClient &taskSync){
 	const std::lock_guard guard(taskSync.GetMutex());
 	
-	derlTaskFileWrite::Map &tasksWrite = taskSync.GetTasksWriteFile();
-	if(tasksWrite.empty()){
+	if(taskSync.GetTasksWriteFile().empty()){
 		return;
 	}
 	
-	for(derlTaskFileWrite::Map::const_reference &eachWrite : tasksWrite){
-		const derlTaskFileWrite::Ref &taskWrite = eachWrite.second;
+	derlTaskFileWrite::List &tasksActive = taskSync.GetTasksWriteFileActive();
+	tasksActive.erase(std::remove_if(tasksActive.begin(), tasksActive.end(),
+		[](const derlTaskFileWrite::Ref &taskWrite){
+			return taskWrite->GetStatus() == derlTaskFileWrite::Status::success
+				|| taskWrite->GetStatus() == derlTaskFileWrite::Status::failure;
+		}), tasksActive.end());
+	
+	pSendNextFileBundle(taskSync);
+	
+	derlTaskFileWrite::Queue &queue = taskSync.GetQueueWriteFile();
+	while(!queue.empty() && pTransferWindow.CanStartFile(pCountInProgressFiles)){
+		const derlTaskFileWrite::Ref taskWrite(queue.front());
+		queue.pop_front();
+		tasksActive.push_back(taskWrite);
 		
-		switch(taskWrite->GetStatus()){
-		case derlTaskFileWrite::Status::pending:
-			if(pCountInProgressFiles >= pMaxInProgressFiles){
-				break;
-			}
-			
-			taskWrite->SetStatus(derlTaskFileWrite::Status::preparing);
-			pCountInProgressFiles++;
+		taskWrite->SetStatus(derlTaskFileWrite::Status::preparing);
+		pCountInProgressFiles++;
+		
+		try{
+			pSendRequestWriteFile(*taskWrite);
 			
-			try{
-				pSendRequestWriteFile(*taskWrite);
-				
-			}catch(const std::exception &e){
-				taskWrite->SetStatus(derlTaskFileWrite::Status::failure);
-				LogException("SendRequestWriteFiles", e, "Failed");
-				throw;
-				
-			}catch(...){
-				taskWrite->SetStatus(derlTaskFileWrite::Status::failure);
-				Log(denLogger::LogSeverity::error, "SendRequestWriteFiles", "Failed");
-				throw;
-			}
-			break;
+		}catch(const std::exception &e){
+			taskWrite->SetStatus(derlTaskFileWrite::Status::failure);
+			LogException("SendRequestWriteFiles", e, "Failed");
+			throw;
 			
+		}catch(...){
+			taskWrite->SetStatus(derlTaskFileWrite::Status::failure);
+			Log(denLogger::LogSeverity::error, "SendRequestWriteFiles", "Failed");
+			throw;
+		}
+	}
+	
+	for(const derlTaskFileWrite::Ref &taskWrite : tasksActive){
+		switch(taskWrite->GetStatus()){
 		case derlTaskFileWrite::Status::processing:{
 			const derlTaskFileWriteBlock::List &blocks = taskWrite->GetBlocks();
 			if(blocks.empty()){
@@ -255,11 +313,12 @@ void derlRemoteClientConnection::SendNextWriteRequests(derlTaskSyncClient &taskS
 					derlTaskFileWriteBlock &block = *eachBlock;
 					
 					if(block.GetStatus() == derlTaskFileWriteBlock::Status::pending){
-						if(pCountInProgressBlocks >= pMaxInProgressBlocks){
+						if(!pTransferWindow.CanStartBlock(pCountInProgressBlocks, block.GetSize())){
 							break;
 						}
 						
 						pCountInProgressBlocks++;
+						pTransferWindow.BlockStarted(block.GetSize());
 						
 						if(block.GetSize() > 0){
 							block.SetStatus(derlTaskFileWriteBlock::Status::readingData);
@@ -272,6 +331,7 @@ void derlRemoteClientConnection::SendNextWriteRequests(derlTaskSyncClient &taskS
 					
 					if(block.GetStatus() == derlTaskFileWriteBlock::Status::dataReady){
 						block.SetStatus(derlTaskFileWriteBlock::Status::dataSent);
+						block.SetSendState(pTransferWindow.BlockSent());
 						try{
 							pSendSendFileData(block);
 							
@@ -312,6 +372,13 @@ void derlRemoteClientConnection::SendNextWriteRequestsFailSync(derlTaskSyncClien
 	}
 }
 
+void derlRemoteClientConnection::ResetTransferState(){
+	pTransferWindow.Reset();
+	pCountInProgressFiles = 0;
+	pCountInProgressBlocks = 0;
+	pCountInProgressBundles = 0;
+}
+
 void derlRemoteClientConnection::LogException(const std::string &functionName,
 const std::exception &exception, const std::string &message){
 	std::stringstream ss;
@@ -336,18 +403,31 @@ void derlRemoteClientConnection::LogDebug(const std::string &functionName, const
 	}
 }
 
-void derlRemoteClientConnection::SendRequestLayout(){
+void derlRemoteClientConnection::SendRequestLayout(uint64_t identifier, uint64_t generation){
 	const std::lock_guard guard(derlGlobal::mutexNetwork);
 	if(!GetConnected()){
 		return;
 	}
 	
-	Log(denLogger::LogSeverity::info, "SendRequestLayout", "Request file layout");
+	const bool changes = (pEnabledFeatures & (uint32_t)derlProtocol::Features::layoutChanges) != 0;
+	
+	if(changes && identifier != 0){
+		std::stringstream ss;
+		ss << "Request file layout changes since generation " << generation;
+		Log(denLogger::LogSeverity::info, "SendRequestLayout", ss.str());
+		
+	}else{
+		Log(denLogger::LogSeverity::info, "SendRequestLayout", "Request file layout");
+	}
 	
 	const denMessage::Ref message(denMessage::Pool().Get());
 	{
 		denMessageWriter writer(message->Item());
 		writer.WriteByte((uint8_t)derlProtocol::MessageCodes::requestFileLayout);
+		if(changes){
+			writer.WriteULong(identifier);
+			writer.WriteULong(generation);
+		}
 	}
 	pQueueSend.Add(message);
 }
@@ -360,7 +440,8 @@ void derlRemoteClientConnection::SendRequestFileBlockHashes(const derlTaskFileBl
 	
 	{
 	std::stringstream log;
-	log << "Request file blocks: " << task.GetPath() << " blockSize " << task.GetBlockSize();
+	log << "Request file blocks: " << task.GetPath() << " blockSize " << task.GetBlockSize()
+		<< (task.GetContentChunks() ? " chunks" : "") << (task.GetWeakHashes() ? " weak" : "");
 	Log(denLogger::LogSeverity::info, "SendRequestFileBlockHashes", log.str());
 	}
 	
@@ -370,6 +451,13 @@ void derlRemoteClientConnection::SendRequestFileBlockHashes(const derlTaskFileBl
 		writer.WriteByte((uint8_t)derlProtocol::MessageCodes::requestFileBlockHashes);
 		writer.WriteString16(task.GetPath());
 		writer.WriteUInt((uint32_t)task.GetBlockSize());
+		
+		if((pEnabledFeatures & (uint32_t)derlProtocol::Features::contentChunks) != 0){
+			writer.WriteByte(task.GetContentChunks() ? 1 : 0);
+		}
+		if((pEnabledFeatures & (uint32_t)derlProtocol::Features::rollingDelta) != 0){
+			writer.WriteByte(task.GetWeakHashes() ? 1 : 0);
+		}
 	}
 	pQueueSend.Add(message);
 }
@@ -562,48 +650,159 @@ void derlRemoteClientConnection::pProcessResponseFileLayout(denMessageReader &re
 		return;
 	}
 	
-	const derlTaskFileLayout::Ref taskLayout(taskSync->GetTaskFileLayoutClient());
+	const derlTaskFileLayout::Ref taskLayout(pGetTaskFileLayoutClient(
+		"pProcessResponseFileLayout", *taskSync));
+	if(!taskLayout){
+		return;
+	}
+	
+	pReadLayoutFiles(reader, reader.ReadUInt(), *taskLayout->GetLayout(), nullptr);
+	pReadLayoutGeneration(reader, *taskLayout->GetLayout());
+	pFinishFileLayoutClient(taskSync, *taskLayout);
+}
+
+void derlRemoteClientConnection::pProcessResponseFileLayoutPage(denMessageReader &reader){
+	const derlTaskSyncClient::Ref taskSync(pGetSyncTask(
+		"pProcessResponseFileLayoutPage", derlTaskSyncClient::Status::pending));
+	if(!taskSync){
+		return;
+	}
+	
+	const derlTaskFileLayout::Ref taskLayout(pGetTaskFileLayoutClient(
+		"pProcessResponseFileLayoutPage", *taskSync));
 	if(!taskLayout){
-		Log(denLogger::LogSeverity::warning, "pProcessResponseFileLayout",
-			"Received ResponseFileLayout but task is done");
 		return;
 	}
 	
 	const derlFileLayout::Ref layout(taskLayout->GetLayout());
 	const int count = reader.ReadUInt();
-	int i;
+	derlFile::List files;
+	pReadLayoutFiles(reader, count, *layout, &files);
 	
-	for(i=0; i<count; i++){
-		const derlFile::Ref file(std::make_shared<derlFile>(reader.ReadString16()));
-		file->SetSize(reader.ReadULong());
-		file->SetHash(reader.ReadString8());
-		layout->AddFile(file);
+	if(pEnableDebugLog){
+		std::stringstream ss;
+		ss << "File layout page received. " << count << " file(s)";
+		LogDebug("pProcessResponseFileLayoutPage", ss.str());
 	}
 	
-	pClient->SetFileLayoutClient(taskLayout->GetLayout());
+	pRequestEarlyFileBlockHashes(taskSync, *layout, files);
+}
+
+void derlRemoteClientConnection::pProcessResponseFileLayoutFinished(denMessageReader &reader){
+	const derlTaskSyncClient::Ref taskSync(pGetSyncTask(
+		"pProcessResponseFileLayoutFinished", derlTaskSyncClient::Status::pending));
+	if(!taskSync){
+		return;
+	}
 	
-	std::stringstream ss;
-	ss << "File layout received. " << count << " file(s)";
-	Log(denLogger::LogSeverity::info, "pProcessResponseFileLayout", ss.str());
+	const derlTaskFileLayout::Ref taskLayout(pGetTaskFileLayoutClient(
+		"pProcessResponseFileLayoutFinished", *taskSync));
+	if(!taskLayout){
+		return;
+	}
 	
-	const std::lock_guard guard(taskSync->GetMutex());
-	taskSync->SetTaskFileLayoutClient(nullptr);
-	if(!taskSync->GetTaskFileLayoutServer()){
-		pClient->AddPendingTaskSync(taskSync);
+	const derlProtocol::FileLayoutResult result = (derlProtocol::FileLayoutResult)reader.ReadByte();
+	const int count = reader.ReadUInt();
+	
+	if(result != derlProtocol::FileLayoutResult::success){
+		Log(denLogger::LogSeverity::error, "pProcessResponseFileLayoutFinished",
+			"Client failed building file layout");
+		pClient->FailSynchronization("Synchronize client failed: client failed building file layout");
+		return;
+	}
+	
+	if(count != taskLayout->GetLayout()->GetFileCount()){
+		std::stringstream ss;
+		ss << "Synchronize client failed: received " << taskLayout->GetLayout()->GetFileCount()
+			<< " file(s) in file layout pages but client send " << count << " file(s)";
+		Log(denLogger::LogSeverity::error, "pProcessResponseFileLayoutFinished", ss.str());
+		pClient->FailSynchronization(ss.str());
+		return;
 	}
+	
+	pReadLayoutGeneration(reader, *taskLayout->GetLayout());
+	pFinishFileLayoutClient(taskSync, *taskLayout);
 }
 
-void derlRemoteClientConnection::pProcessResponseFileBlockHashes(denMessageReader &reader){
+void derlRemoteClientConnection::pProcessResponseFileLayoutChanges(denMessageReader &reader){
 	const derlTaskSyncClient::Ref taskSync(pGetSyncTask(
-		"pProcessResponseFileBlockHashes", derlTaskSyncClient::Status::processHashing));
+		"pProcessResponseFileLayoutChanges", derlTaskSyncClient::Status::pending));
 	if(!taskSync){
 		return;
 	}
 	
-	const std::string path(reader.ReadString16());
+	const derlTaskFileLayout::Ref taskLayout(pGetTaskFileLayoutClient(
+		"pProcessResponseFileLayoutChanges", *taskSync));
+	if(!taskLayout){
+		return;
+	}
+	
+	const uint64_t identifier = reader.ReadULong();
+	const uint64_t generation = reader.ReadULong();
+	
+	const derlFileLayout::Ref &base = taskSync->GetFileLayoutClientBase();
+	if(!base || base->GetIdentifier() != identifier){
+		Log(denLogger::LogSeverity::warning, "pProcessResponseFileLayoutChanges",
+			"Received file layout changes not matching previous file layout. Request file layout");
+		taskSync->SetFileLayoutClientBase(nullptr);
+		SendRequestLayout(0, 0);
+		return;
+	}
+	
+	// the base file layout has been modified while synchronizing. copy only file properties
+	derlFileLayout &layout = *taskLayout->GetLayout();
+	derlFile::Map::const_iterator iter;
+	for(iter=base->GetFilesBegin(); iter!=base->GetFilesEnd(); iter++){
+		const derlFile &baseFile = *iter->second;
+		const derlFile::Ref file(std::make_shared<derlFile>(baseFile.GetPath()));
+		file->SetSize(baseFile.GetSize());
+		file->SetHash(baseFile.GetHash());
+		layout.AddFile(file);
+	}
+	
+	const int changedCount = reader.ReadUInt();
+	pReadLayoutFiles(reader, changedCount, layout, nullptr);
+	
+	const int removedCount = reader.ReadUInt();
+	const bool compact = (pEnabledFeatures & (uint32_t)derlProtocol::Features::compactLayout) != 0;
+	std::string previousPath;
+	int i;
+	for(i=0; i<removedCount; i++){
+		if(compact){
+			layout.RemoveFileIfPresent(derlCompactLayout::ReadPath(reader, previousPath));
+			
+		}else{
+			layout.RemoveFileIfPresent(reader.ReadString16());
+		}
+	}
+	
+	layout.SetIdentifier(identifier);
+	layout.SetGeneration(generation);
 	
 	{
-	const std::lock_guard guard(taskSync->GetMutex());
+	std::stringstream ss;
+	ss << "File layout changes received. " << changedCount << " changed, "
+		<< removedCount << " removed";
+	Log(denLogger::LogSeverity::info, "pProcessResponseFileLayoutChanges", ss.str());
+	}
+	
+	pFinishFileLayoutClient(taskSync, *taskLayout);
+}
+
+void derlRemoteClientConnection::pProcessResponseFileBlockHashes(denMessageReader &reader){
+	// hashes can be requested while client file layout pages are received
+	const derlTaskSyncClient::Ref taskSync(pGetSyncTask("pProcessResponseFileBlockHashes",
+		derlTaskSyncClient::Status::pending, derlTaskSyncClient::Status::processHashing));
+	if(!taskSync){
+		return;
+	}
+	
+	const std::string path(reader.ReadString16());
+	bool contentChunks, weakHashes;
+	
+	// hold the lock until the hashes are applied. once the task is removed processor
+	// threads can start preparing the write tasks reading the client file blocks
+	std::unique_lock guard(taskSync->GetMutex());
 	derlTaskFileBlockHashes::Map::iterator iterTaskHashes(taskSync->GetTasksFileBlockHashes().find(path));
 	if(iterTaskHashes == taskSync->GetTasksFileBlockHashes().end()){
 		std::stringstream log;
@@ -620,13 +819,14 @@ void derlRemoteClientConnection::pProcessResponseFileBlockHashes(denMessageReade
 		Log(denLogger::LogSeverity::warning, "pProcessResponseFileBlockHashes", log.str());
 		return;
 	}
-	}
-	
-	taskSync->GetTasksFileBlockHashes().erase(iterTaskHashes);
+	contentChunks = taskHashes.GetContentChunks();
+	weakHashes = taskHashes.GetWeakHashes();
 	}
 	
 	try{
-		const derlFileLayout::Ref layout(pClient->GetFileLayoutClient());
+		// while receiving file layout pages the file layout is not yet set in the client
+		const derlTaskFileLayout::Ref &taskLayout = taskSync->GetTaskFileLayoutClient();
+		const derlFileLayout::Ref layout(taskLayout ? taskLayout->GetLayout() : pClient->GetFileLayoutClient());
 		if(!layout){
 			std::stringstream ss;
 			ss << "Block hashes for file received but file layout is not present: " << path;
@@ -641,19 +841,50 @@ void derlRemoteClientConnection::pProcessResponseFileBlockHashes(denMessageReade
 		}
 		
 		const int count = reader.ReadUInt();
-		if(count > file->GetBlockCount()){
-			std::stringstream ss;
-			ss << "Block hashes for file received but with count is out of range: "
-				<< path << " count " << count << " allowed " << file->GetBlockCount();
-			throw std::runtime_error(ss.str());
-		}
 		
-		int i;
-		for(i=0; i<count; i++){
-			file->GetBlockAt(i)->SetHash(reader.ReadString8());
+		if(contentChunks){
+			// chunks are variable in size and follow each other
+			uint64_t offset = 0;
+			int i;
+			for(i=0; i<count; i++){
+				const derlDigest hash(derlHasher::ReadDigest(reader, GetHashAlgorithm(), pEnabledFeatures));
+				const uint64_t size = reader.ReadUInt();
+				
+				const derlFileBlock::Ref block(std::make_shared<derlFileBlock>(offset, size));
+				block->SetHash(hash);
+				file->AddBlock(block);
+				offset += size;
+			}
+			
+			if(offset != file->GetSize()){
+				// client file changed since the layout has been send. write entire file
+				std::stringstream log;
+				log << "Chunk hashes for file received but size does not match: "
+					<< path << " size " << offset << " expected " << file->GetSize();
+				Log(denLogger::LogSeverity::warning, "pProcessResponseFileBlockHashes", log.str());
+				file->RemoveAllBlocks();
+			}
+			
+		}else{
+			if(count > file->GetBlockCount()){
+				std::stringstream ss;
+				ss << "Block hashes for file received but with count is out of range: "
+					<< path << " count " << count << " allowed " << file->GetBlockCount();
+				throw std::runtime_error(ss.str());
+			}
+			
+			int i;
+			for(i=0; i<count; i++){
+				derlFileBlock &block = *file->GetBlockAt(i);
+				block.SetHash(derlHasher::ReadDigest(reader, GetHashAlgorithm(), pEnabledFeatures));
+				if(weakHashes){
+					block.SetWeakHash(reader.ReadUInt());
+				}
+			}
 		}
 		
 	}catch(const std::exception &e){
+		guard.unlock();
 		LogException("ProcessResponseFileBlockHashes", e, "Failed");
 		
 		std::stringstream ss;
@@ -662,11 +893,15 @@ void derlRemoteClientConnection::pProcessResponseFileBlockHashes(denMessageReade
 		return;
 		
 	}catch(...){
+		guard.unlock();
 		Log(denLogger::LogSeverity::error, "ProcessResponseFileBlockHashes", "Failed");
 		pClient->FailSynchronization();
 		return;
 	}
 	
+	taskSync->GetTasksFileBlockHashes().erase(iterTaskHashes);
+	guard.unlock();
+	
 	{
 	std::stringstream ss;
 	ss << "Block hashes received: " << path;
@@ -746,6 +981,10 @@ void derlRemoteClientConnection::pProcessResponseWriteFile(denMessageReader &rea
 	}
 	
 	if(result == derlProtocol::WriteFileResult::success){
+		if((pEnabledFeatures & (uint32_t)derlProtocol::Features::resumeWrite) != 0){
+			pResumeWriteFile(taskWrite, reader);
+		}
+		
 		taskWrite.SetStatus(derlTaskFileWrite::Status::processing);
 		guard.unlock();
 		SendNextWriteRequestsFailSync(*taskSync);
@@ -817,10 +1056,19 @@ void derlRemoteClientConnection::pProcessFileDataReceived(denMessageReader &read
 		return;
 	}
 	
+	pTransferWindow.BlockAcknowledged(block.GetSize(), block.GetSendState());
 	blocks.erase(iterBlock);
 	if(pCountInProgressBlocks > 0){
 		pCountInProgressBlocks--;
 	}
+	
+	if(pEnableDebugLog){
+		std::stringstream log;
+		log << "Transfer window " << pTransferWindow.GetWindowSize()
+			<< " rtt " << pTransferWindow.GetRoundTripTime()
+			<< "us bandwidth " << pTransferWindow.GetBandwidth();
+		LogDebug("pProcessFileDataReceived", log.str());
+	}
 	}
 	}
 	
@@ -865,6 +1113,8 @@ void derlRemoteClientConnection::pProcessResponseFinishWriteFile(denMessageReade
 		return;
 	}
 	
+	taskWrite.SetStatus(result == derlProtocol::WriteFileResult::success
+		? derlTaskFileWrite::Status::success : derlTaskFileWrite::Status::failure);
 	tasksWrite.erase(iterWrite);
 	if(pCountInProgressFiles > 0){
 		pCountInProgressFiles--;
@@ -885,6 +1135,68 @@ void derlRemoteClientConnection::pProcessResponseFinishWriteFile(denMessageReade
 	}
 }
 
+void derlRemoteClientConnection::pProcessResponseFileBundle(denMessageReader &reader){
+	const derlTaskSyncClient::Ref taskSync(pGetSyncTask(
+		"pProcessResponseFileBundle", derlTaskSyncClient::Status::processWriting));
+	if(!taskSync){
+		return;
+	}
+	
+	const int count = reader.ReadUInt();
+	std::string failedPath;
+	int i;
+	
+	{
+	const std::lock_guard guard(taskSync->GetMutex());
+	derlTaskFileWrite::Map &tasksWrite = taskSync->GetTasksWriteFile();
+	
+	for(i=0; i<count; i++){
+		const std::string path(reader.ReadString16());
+		const derlProtocol::FinishWriteFileResult result =
+			(derlProtocol::FinishWriteFileResult)reader.ReadByte();
+		
+		derlTaskFileWrite::Map::iterator iterWrite(tasksWrite.find(path));
+		if(iterWrite == tasksWrite.end()){
+			std::stringstream log;
+			log << "File bundle response received with invalid path: " << path;
+			Log(denLogger::LogSeverity::warning, "pProcessResponseFileBundle", log.str());
+			continue;
+		}
+		
+		derlTaskFileWrite &taskWrite = *iterWrite->second;
+		if(!taskWrite.GetBundled() || taskWrite.GetStatus() != derlTaskFileWrite::Status::finishing){
+			std::stringstream log;
+			log << "File bundle response received but file is not finishing: " << path;
+			Log(denLogger::LogSeverity::warning, "pProcessResponseFileBundle", log.str());
+			continue;
+		}
+		
+		tasksWrite.erase(iterWrite);
+		
+		if(result != derlProtocol::FinishWriteFileResult::success && failedPath.empty()){
+			failedPath = path;
+		}
+	}
+	
+	if(pCountInProgressBundles > 0){
+		pCountInProgressBundles--;
+	}
+	}
+	
+	if(failedPath.empty()){
+		std::stringstream ss;
+		ss << "File bundle written: " << count << " file(s)";
+		Log(denLogger::LogSeverity::info, "pProcessResponseFileBundle", ss.str());
+		pCheckFinishedWrite(taskSync);
+		
+	}else{
+		std::stringstream ss;
+		ss << "Writing file failed: " << failedPath;
+		Log(denLogger::LogSeverity::error, "pProcessResponseFileBundle", ss.str());
+		pClient->FailSynchronization(ss.str());
+	}
+}
+
 void derlRemoteClientConnection::pProcessResponseSystemProperty(denMessageReader &reader){
 	const std::string property(reader.ReadString8());
 	const std::string value(reader.ReadString16());
@@ -892,6 +1204,17 @@ void derlRemoteClientConnection::pProcessResponseSystemProperty(denMessageReader
 }
 
 void derlRemoteClientConnection::pSendRequestWriteFile(const derlTaskFileWrite &task){
+	const bool resume = (pEnabledFeatures & (uint32_t)derlProtocol::Features::resumeWrite) != 0;
+	derlFile::Ref file;
+	if(resume){
+		file = pClient->GetFileLayoutServer()->GetFileAt(task.GetPath());
+		if(!file){
+			std::stringstream ss;
+			ss << "File missing in layout: " << task.GetPath();
+			throw std::runtime_error(ss.str());
+		}
+	}
+	
 	const std::lock_guard guard(derlGlobal::mutexNetwork);
 	const denMessage::Ref message(denMessage::Pool().Get());
 	{
@@ -902,6 +1225,15 @@ void derlRemoteClientConnection::pSendRequestWriteFile(const derlTaskFileWrite &
 		writer.WriteULong(task.GetBlockSize());
 		writer.WriteUInt(task.GetBlockCount());
 		
+		if((pEnabledFeatures & ((uint32_t)derlProtocol::Features::rollingDelta
+		| (uint32_t)derlProtocol::Features::contentChunks)) != 0){
+			writer.WriteByte(task.GetDelta() ? 1 : 0);
+		}
+		
+		if(resume){
+			derlHasher::WriteDigest(writer, file->GetHash(), GetHashAlgorithm(), pEnabledFeatures);
+		}
+		
 		std::stringstream log;
 		log << "Request write file: " << task.GetPath() << " size " << task.GetFileSize();
 		Log(denLogger::LogSeverity::info, "pSendRequestsWriteFile", log.str());
@@ -914,6 +1246,12 @@ void derlRemoteClientConnection::pSendSendFileData(derlTaskFileWriteBlock &block
 		std::stringstream log;
 		log << "Send file data: " << block.GetParentTask().GetPath()
 			<< " block " << block.GetIndex() << " size " << block.GetSize();
+		if(block.GetCompressed()){
+			log << " compressed " << block.GetData().size();
+		}
+		if(block.GetZero()){
+			log << " zero";
+		}
 		LogDebug("pSendSendFileData", log.str());
 	}
 	
@@ -924,7 +1262,43 @@ void derlRemoteClientConnection::pSendSendFileData(derlTaskFileWriteBlock &block
 		writer.WriteByte((uint8_t)derlProtocol::MessageCodes::sendFileData);
 		writer.WriteString16(block.GetParentTask().GetPath());
 		writer.WriteUInt((uint32_t)block.GetIndex());
-		writer.Write((void*)block.GetData().c_str(), block.GetSize());
+		
+		if((pEnabledFeatures & ((uint32_t)derlProtocol::Features::compression
+		| (uint32_t)derlProtocol::Features::zeroBlocks)) != 0){
+			if(block.GetZero()){
+				writer.WriteByte((uint8_t)derlProtocol::Compression::zero);
+				
+			}else if(block.GetCompressed()){
+				writer.WriteByte((uint8_t)derlProtocol::Compression::lz4);
+				
+			}else{
+				writer.WriteByte((uint8_t)derlProtocol::Compression::none);
+			}
+		}
+		
+		if(block.GetParentTask().GetDelta()){
+			const derlTaskFileWriteBlock::Instructions &instructions = block.GetInstructions();
+			writer.WriteUInt((uint32_t)instructions.size());
+			for(const derlTaskFileWriteBlock::Instruction &instruction : instructions){
+				switch(instruction.type){
+				case derlTaskFileWriteBlock::InstructionType::copy:
+					writer.WriteByte((uint8_t)derlProtocol::DeltaInstruction::copy);
+					writer.WriteULong(instruction.offset);
+					break;
+					
+				case derlTaskFileWriteBlock::InstructionType::literal:
+					writer.WriteByte((uint8_t)derlProtocol::DeltaInstruction::literal);
+					break;
+				}
+				writer.WriteULong(instruction.size);
+			}
+			
+			// literal data of all literal instructions in order
+			writer.Write((void*)block.GetData().c_str(), block.GetData().size());
+			
+		}else{
+			writer.Write((void*)block.GetData().c_str(), block.GetData().size());
+		}
 	}
 	pQueueSend.Add(message);
 }
@@ -943,7 +1317,7 @@ void derlRemoteClientConnection::pSendRequestFinishWriteFile(const derlTaskFileW
 		denMessageWriter writer(message->Item());
 		writer.WriteByte((uint8_t)derlProtocol::MessageCodes::requestFinishWriteFile);
 		writer.WriteString16(task.GetPath());
-		writer.WriteString8(file->GetHash());
+		derlHasher::WriteDigest(writer, file->GetHash(), GetHashAlgorithm(), pEnabledFeatures);
 		
 		std::stringstream log;
 		log << "Request finish write file: " << task.GetPath();
@@ -952,6 +1326,167 @@ void derlRemoteClientConnection::pSendRequestFinishWriteFile(const derlTaskFileW
 	pQueueSend.Add(message);
 }
 
+void derlRemoteClientConnection::pSendNextFileBundle(derlTaskSyncClient &taskSync){
+	// only one bundle is prepared at a time
+	derlTaskFileWrite::List &bundle = taskSync.GetTasksWriteFileBundle();
+	
+	if(bundle.empty()){
+		if(pCountInProgressBundles >= pMaxInProgressBundles){
+			return;
+		}
+		
+		derlTaskFileWrite::Queue &queue = taskSync.GetQueueWriteFileBundle();
+		uint64_t bundleSize = 0;
+		
+		while(!queue.empty()){
+			const derlTaskFileWrite::Ref taskWrite(queue.front());
+			if((int)bundle.size() >= pMaxBundleFiles
+			|| (!bundle.empty() && bundleSize + taskWrite->GetFileSize() > pMaxBundleSize)){
+				break;
+			}
+			
+			queue.pop_front();
+			taskWrite->SetBundled(true);
+			taskWrite->SetStatus(derlTaskFileWrite::Status::preparing);
+			bundleSize += taskWrite->GetFileSize();
+			bundle.push_back(taskWrite);
+			
+			for(const derlTaskFileWriteBlock::Ref &eachBlock : taskWrite->GetBlocks()){
+				if(eachBlock->GetSize() > 0){
+					eachBlock->SetStatus(derlTaskFileWriteBlock::Status::readingData);
+					pClient->AddPendingTaskSync(eachBlock);
+					
+				}else{
+					eachBlock->SetStatus(derlTaskFileWriteBlock::Status::dataReady);
+				}
+			}
+		}
+		
+		if(bundle.empty()){
+			return;
+		}
+	}
+	
+	for(const derlTaskFileWrite::Ref &taskWrite : bundle){
+		for(const derlTaskFileWriteBlock::Ref &eachBlock : taskWrite->GetBlocks()){
+			if(eachBlock->GetStatus() != derlTaskFileWriteBlock::Status::dataReady){
+				return;
+			}
+		}
+	}
+	
+	for(const derlTaskFileWrite::Ref &taskWrite : bundle){
+		taskWrite->SetStatus(derlTaskFileWrite::Status::finishing);
+		for(const derlTaskFileWriteBlock::Ref &eachBlock : taskWrite->GetBlocks()){
+			eachBlock->SetStatus(derlTaskFileWriteBlock::Status::dataSent);
+		}
+	}
+	pCountInProgressBundles++;
+	
+	const derlTaskFileWrite::List tasks(std::move(bundle));
+	bundle.clear();
+	
+	try{
+		pSendSendFileBundle(tasks);
+		
+	}catch(const std::exception &e){
+		for(const derlTaskFileWrite::Ref &taskWrite : tasks){
+			taskWrite->SetStatus(derlTaskFileWrite::Status::failure);
+		}
+		LogException("SendSendFileBundle", e, "Failed");
+		throw;
+		
+	}catch(...){
+		for(const derlTaskFileWrite::Ref &taskWrite : tasks){
+			taskWrite->SetStatus(derlTaskFileWrite::Status::failure);
+		}
+		Log(denLogger::LogSeverity::error, "SendSendFileBundle", "Failed");
+		throw;
+	}
+}
+
+void derlRemoteClientConnection::pSendSendFileBundle(const derlTaskFileWrite::List &tasks){
+	const derlFileLayout::Ref layout(pClient->GetFileLayoutServer());
+	const bool compression = (pEnabledFeatures & (uint32_t)derlProtocol::Features::compression) != 0;
+	uint64_t bundleSize = 0;
+	
+	const std::lock_guard guard(derlGlobal::mutexNetwork);
+	const denMessage::Ref message(denMessage::Pool().Get());
+	{
+		denMessageWriter writer(message->Item());
+		writer.WriteByte((uint8_t)derlProtocol::MessageCodes::sendFileBundle);
+		writer.WriteUInt((uint32_t)tasks.size());
+		
+		for(const derlTaskFileWrite::Ref &taskWrite : tasks){
+			const derlFile::Ref file(layout->GetFileAt(taskWrite->GetPath()));
+			if(!file){
+				std::stringstream ss;
+				ss << "File missing in layout: " << taskWrite->GetPath();
+				throw std::runtime_error(ss.str());
+			}
+			
+			writer.WriteString16(taskWrite->GetPath());
+			writer.WriteULong(taskWrite->GetFileSize());
+			writer.WriteULong(taskWrite->GetBlockSize());
+			derlHasher::WriteDigest(writer, file->GetHash(), GetHashAlgorithm(), pEnabledFeatures);
+			
+			const derlTaskFileWriteBlock::List &blocks = taskWrite->GetBlocks();
+			const derlTaskFileWriteBlock * const block = blocks.empty() ? nullptr : blocks.front().get();
+			
+			if(compression){
+				writer.WriteByte((uint8_t)(block && block->GetCompressed()
+					? derlProtocol::Compression::lz4 : derlProtocol::Compression::none));
+			}
+			
+			if(block){
+				writer.WriteUInt((uint32_t)block->GetData().size());
+				writer.Write((void*)block->GetData().c_str(), block->GetData().size());
+				bundleSize += block->GetData().size();
+				
+			}else{
+				writer.WriteUInt(0);
+			}
+		}
+	}
+	pQueueSend.Add(message);
+	
+	std::stringstream log;
+	log << "Send file bundle: " << tasks.size() << " file(s) size " << bundleSize;
+	Log(denLogger::LogSeverity::info, "pSendSendFileBundle", log.str());
+}
+
+void derlRemoteClientConnection::pResumeWriteFile(derlTaskFileWrite &task, denMessageReader &reader){
+	const int bitmapSize = (int)reader.ReadUInt();
+	std::string bitmap;
+	bitmap.assign(bitmapSize, 0);
+	reader.Read((void*)bitmap.c_str(), bitmapSize);
+	
+	if(task.GetDelta()){
+		return;
+	}
+	
+	derlTaskFileWriteBlock::List &blocks = task.GetBlocks();
+	const derlTaskFileWriteBlock::List::size_type count = blocks.size();
+	
+	blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+		[&bitmap](const derlTaskFileWriteBlock::Ref &block){
+			const int index = block->GetIndex();
+			return index / 8 < (int)bitmap.size() && (bitmap[index / 8] & (1 << (index % 8))) != 0;
+		}), blocks.end());
+	
+	if(blocks.size() < count){
+		std::stringstream log;
+		log << "Resume write file: " << task.GetPath() << " skip "
+			<< (count - blocks.size()) << " of " << count << " block(s)";
+		Log(denLogger::LogSeverity::info, "pResumeWriteFile", log.str());
+	}
+}
+
+bool derlRemoteClientConnection::pCanBundleFile(derlTaskFileWrite &task) const{
+	return !task.GetDelta() && task.GetFileSize() <= pMaxBundleFileSize
+		&& task.GetBlockCount() <= 1 && (int)task.GetBlocks().size() == task.GetBlockCount();
+}
+
 derlTaskSyncClient::Ref derlRemoteClientConnection::pGetSyncTask(
 const std::string &functionName, derlTaskSyncClient::Status status){
 	const derlTaskSyncClient::Ref task(pClient->GetTaskSyncClient());
@@ -994,9 +1529,90 @@ derlTaskSyncClient::Status status1, derlTaskSyncClient::Status status2){
 	return task;
 }
 
+derlTaskFileLayout::Ref derlRemoteClientConnection::pGetTaskFileLayoutClient(
+const std::string &functionName, const derlTaskSyncClient &taskSync){
+	const derlTaskFileLayout::Ref &taskLayout = taskSync.GetTaskFileLayoutClient();
+	if(!taskLayout){
+		Log(denLogger::LogSeverity::warning, functionName,
+			"Received file layout response but task is done");
+	}
+	return taskLayout;
+}
+
+void derlRemoteClientConnection::pFinishFileLayoutClient(
+const derlTaskSyncClient::Ref &taskSync, const derlTaskFileLayout &taskLayout){
+	pClient->SetFileLayoutClient(taskLayout.GetLayout());
+	
+	std::stringstream ss;
+	ss << "File layout received. " << taskLayout.GetLayout()->GetFileCount() << " file(s)";
+	Log(denLogger::LogSeverity::info, "pFinishFileLayoutClient", ss.str());
+	
+	const std::lock_guard guard(taskSync->GetMutex());
+	taskSync->SetTaskFileLayoutClient(nullptr);
+	if(!taskSync->GetTaskFileLayoutServer()){
+		pClient->AddPendingTaskSync(taskSync);
+	}
+}
+
+void derlRemoteClientConnection::pRequestEarlyFileBlockHashes(const derlTaskSyncClient::Ref &taskSync,
+const derlFileLayout &layoutClient, const derlFile::List &files){
+	// server file layout is set before the server file layout task is cleared
+	const derlFileLayout::Ref layoutServer(pClient->GetFileLayoutServerSync());
+	if(!layoutServer){
+		return; // server file layout is not build yet
+	}
+	
+	try{
+		const std::lock_guard guard(taskSync->GetMutex());
+		if(taskSync->GetTaskFileLayoutServer()){
+			return;
+		}
+		
+		// the first time all files received so far are checked
+		derlFile::List checkFiles;
+		if(taskSync->GetEarlyFileBlockHashes()){
+			checkFiles = files;
+			
+		}else{
+			derlFile::Map::const_iterator iter;
+			for(iter=layoutClient.GetFilesBegin(); iter!=layoutClient.GetFilesEnd(); iter++){
+				checkFiles.push_back(iter->second);
+			}
+			taskSync->SetEarlyFileBlockHashes(true);
+		}
+		
+		for(const derlFile::Ref &fileClient : checkFiles){
+			const derlFile::Ref fileServer(layoutServer->GetFileAt(fileClient->GetPath()));
+			if(!fileServer){
+				continue;
+			}
+			
+			const derlTaskFileBlockHashes::Ref taskHashes(
+				taskSync->AddFileBlockHashesTask(*fileServer, *fileClient));
+			if(taskHashes){
+				SendRequestFileBlockHashes(*taskHashes);
+			}
+		}
+		
+	}catch(const std::exception &e){
+		LogException("pRequestEarlyFileBlockHashes", e, "Failed");
+		
+		std::stringstream ss;
+		ss << "Synchronize client failed: " << e.what();
+		pClient->FailSynchronization(ss.str());
+		
+	}catch(...){
+		Log(denLogger::LogSeverity::error, "pRequestEarlyFileBlockHashes", "Failed");
+		pClient->FailSynchronization();
+	}
+}
+
 void derlRemoteClientConnection::pCheckFinishedHashes(const derlTaskSyncClient::Ref &task){
 	{
 	const std::lock_guard guard(task->GetMutex());
+	if(task->GetStatus() != derlTaskSyncClient::Status::processHashing){
+		return; // hashes requested early. status changes after comparing the file layouts
+	}
 	if(!task->GetTasksFileBlockHashes().empty()){
 		return;
 	}
@@ -1036,3 +1652,37 @@ void derlRemoteClientConnection::pCheckFinishedWrite(const derlTaskSyncClient::R
 		pClient->FailSynchronization();
 	}
 }
+
+void derlRemoteClientConnection::pReadLayoutFiles(denMessageReader &reader, int count,
+derlFileLayout &layout, derlFile::List *files) const{
+	const bool compact = (pEnabledFeatures & (uint32_t)derlProtocol::Features::compactLayout) != 0;
+	std::string previousPath;
+	int i;
+	
+	for(i=0; i<count; i++){
+		derlFile::Ref file;
+		if(compact){
+			file = std::make_shared<derlFile>(derlCompactLayout::ReadPath(reader, previousPath));
+			file->SetSize(derlCompactLayout::ReadVarUInt(reader));
+			
+		}else{
+			file = std::make_shared<derlFile>(reader.ReadString16());
+			file->SetSize(reader.ReadULong());
+		}
+		file->SetHash(derlHasher::ReadDigest(reader, GetHashAlgorithm(), pEnabledFeatures));
+		
+		layout.AddFile(file);
+		if(files){
+			files->push_back(file);
+		}
+	}
+}
+
+void derlRemoteClientConnection::pReadLayoutGeneration(
+denMessageReader &reader, derlFileLayout &layout) const{
+	if((pEnabledFeatures & (uint32_t)derlProtocol::Features::layoutChanges) != 0){
+		layout.SetIdentifier(reader.ReadULong());
+		layout.SetGeneration(reader.ReadULong());
+	}
+}
+
@@ -31,6 +31,8 @@
 #include "../derlMessageQueue.h"
 #include "../derlRunParameters.h"
 #include "../derlProtocol.h"
+#include "../derlHasher.h"
+#include "../derlTransferWindow.h"
 #include "../task/derlTaskFileWrite.h"
 #include "../task/derlTaskFileDelete.h"
 #include "../task/derlTaskFileBlockHashes.h"
@@ -46,6 +48,7 @@ class derlFileLayout;
 class derlFile;
 
 class denMessageReader;
+class denMessageWriter;
 
 
 /**
@@ -81,8 +84,13 @@ private:
 	
 	const std::shared_ptr<StateRun> pStateRun;
 	
-	int pMaxInProgressFiles, pCountInProgressFiles;
-	int pMaxInProgressBlocks, pCountInProgressBlocks;
+	derlTransferWindow pTransferWindow;
+	int pCountInProgressFiles;
+	int pCountInProgressBlocks;
+	int pMaxInProgressBundles, pCountInProgressBundles;
+	const uint64_t pMaxBundleFileSize;
+	uint64_t pMaxBundleSize;
+	int pMaxBundleFiles;
 	
 	derlMessageQueue pQueueReceived, pQueueSend;
 	
@@ -110,6 +118,16 @@ public:
 	/** \brief Name of client. */
 	inline const std::string &GetName() const{ return pName; }
 	
+	/** \brief Features enabled for connection. */
+	inline uint32_t GetEnabledFeatures() const{ return pEnabledFeatures; }
+	
+	/** \brief Hash algorithm negotiated for connection. */
+	derlHasher::Algorithm GetHashAlgorithm() const;
+	
+	/** \brief Transfer window. */
+	inline derlTransferWindow &GetTransferWindow(){ return pTransferWindow; }
+	inline const derlTransferWindow &GetTransferWindow() const{ return pTransferWindow; }
+	
 	
 	/** \brief Received message queue. */
 	inline derlMessageQueue &GetQueueReceived(){ return pQueueReceived; }
@@ -159,6 +177,14 @@ public:
 	 */
 	bool ProcessReceivedMessages();
 	
+	/**
+	 * \brief Add write file tasks to the ready queues of sync task.
+	 * 
+	 * Tasks have to be ordered using the transfer order policy. Files written using
+	 * file bundles are added to the bundle ready queue. Caller has to lock task mutex.
+	 */
+	void QueueWriteFiles(derlTaskSyncClient &taskSync, const derlTaskFileWrite::List &tasks);
+	
 	/** \brief Send next write requests if possible. */
 	void SendNextWriteRequests(derlTaskSyncClient &taskSync);
 	
@@ -169,6 +195,14 @@ public:
 	 */
 	void SendNextWriteRequestsFailSync(derlTaskSyncClient &taskSync);
 	
+	/**
+	 * \brief Reset write transfer state of synchronization.
+	 * 
+	 * Called if synchronization starts or fails. Responses of a failed synchronization
+	 * are never received and would keep their transfers in progress forever.
+	 */
+	void ResetTransferState();
+	
 	/** \brief Log exception. */
 	void LogException(const std::string &functionName, const std::exception &exception,
 		const std::string &message);
@@ -180,7 +214,7 @@ public:
 	/** \brief Debug log message only printed if debugging is enabled. */
 	void LogDebug(const std::string &functionName, const std::string &message);
 	
-	void SendRequestLayout();
+	void SendRequestLayout(uint64_t identifier, uint64_t generation);
 	void SendRequestFileBlockHashes(const derlTaskFileBlockHashes &task);
 	void SendRequestDeleteFile(const derlTaskFileDelete &task);
 	void SendStartApplication(const derlRunParameters &parameters);
@@ -195,23 +229,41 @@ private:
 	
 	void pProcessRequestLogs(denMessageReader &reader);
 	void pProcessResponseFileLayout(denMessageReader &reader);
+	void pProcessResponseFileLayoutPage(denMessageReader &reader);
+	void pProcessResponseFileLayoutFinished(denMessageReader &reader);
+	void pProcessResponseFileLayoutChanges(denMessageReader &reader);
 	void pProcessResponseFileBlockHashes(denMessageReader &reader);
 	void pProcessResponseDeleteFile(denMessageReader &reader);
 	void pProcessResponseWriteFile(denMessageReader &reader);
 	void pProcessFileDataReceived(denMessageReader &reader);
 	void pProcessResponseFinishWriteFile(denMessageReader &reader);
+	void pProcessResponseFileBundle(denMessageReader &reader);
 	void pProcessResponseSystemProperty(denMessageReader &reader);
 	
 	void pSendRequestWriteFile(const derlTaskFileWrite &task);
 	void pSendSendFileData(derlTaskFileWriteBlock &block);
 	void pSendRequestFinishWriteFile(const derlTaskFileWrite &task);
+	void pSendNextFileBundle(derlTaskSyncClient &taskSync);
+	void pSendSendFileBundle(const derlTaskFileWrite::List &tasks);
+	void pResumeWriteFile(derlTaskFileWrite &task, denMessageReader &reader);
+	bool pCanBundleFile(derlTaskFileWrite &task) const;
 	
 	derlTaskSyncClient::Ref pGetSyncTask(const std::string &functionName,
 		derlTaskSyncClient::Status status);
 	derlTaskSyncClient::Ref pGetSyncTask(const std::string &functionName,
 		derlTaskSyncClient::Status status1, derlTaskSyncClient::Status status2);
+	derlTaskFileLayout::Ref pGetTaskFileLayoutClient(const std::string &functionName,
+		const derlTaskSyncClient &taskSync);
+	void pFinishFileLayoutClient(const derlTaskSyncClient::Ref &taskSync,
+		const derlTaskFileLayout &taskLayout);
+	void pRequestEarlyFileBlockHashes(const derlTaskSyncClient::Ref &taskSync,
+		const derlFileLayout &layoutClient, const derlFile::List &files);
 	void pCheckFinishedHashes(const derlTaskSyncClient::Ref &task);
 	void pCheckFinishedWrite(const derlTaskSyncClient::Ref &task);
+	
+	void pReadLayoutFiles(denMessageReader &reader, int count, derlFileLayout &layout,
+		derlFile::List *files) const;
+	void pReadLayoutGeneration(denMessageReader &reader, derlFileLayout &layout) const;
 };
 
 #endif
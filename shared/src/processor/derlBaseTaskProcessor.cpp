@@ -22,19 +22,76 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
 #include <stdexcept>
 #include <mutex>
 #include <thread>
 #include <chrono>
 #include <cstring>
 #include <sstream>
+#include <deque>
+#include <vector>
 
 #include "derlBaseTaskProcessor.h"
 #include "../config.h"
 #include "../derlFile.h"
 #include "../derlFileBlock.h"
 #include "../derlFileLayout.h"
-#include "../hashing/sha256.h"
+#include "../derlHasher.h"
+#include "../derlRollingChecksum.h"
+#include "../derlFastCdc.h"
+#include "../derlProtocol.h"
+
+#ifdef OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <time.h>
+#endif
+
+
+namespace{
+
+// files modified less than this time before being hashed are not stored in the hash cache.
+// the file could be modified again within the modification time resolution of the file
+// system without the modification time changing
+const int64_t vHashCacheRacyTime = 2000000000LL;
+
+// layout worker using the default file access implementation
+class cLayoutWorker : public derlBaseTaskProcessor{
+public:
+	void RunTask() override{
+	}
+};
+
+#ifdef OS_UNIX
+// record returned by getdents64(). name is null terminated and starts at offsetof(name)
+struct sLinuxDirent64{
+	uint64_t inode;
+	int64_t offset;
+	unsigned short recordLength;
+	unsigned char type;
+	char name[1];
+};
+
+const int vDirentBufferSize = 32768;
+#endif
+
+int64_t fileTimeNow(){
+#ifdef OS_UNIX
+	timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (int64_t)now.tv_sec * 1000000000LL + (int64_t)now.tv_nsec;
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::filesystem::file_time_type::clock::now().time_since_epoch()).count();
+#endif
+}
+
+}
 
 
 // Class derlBaseTaskProcessor
@@ -42,11 +99,37 @@
 
 derlBaseTaskProcessor::derlBaseTaskProcessor() :
 pExit(false),
+pEnableMemoryMap(false),
+pFileMapped(false),
+pFileMapping(nullptr),
+pFileMappingSize(0),
+pIoEngine(IoEngine::stream),
+pIoQueueDepth(8),
+pIoReadSize(1024L * 256L),
+pFileDescriptor(-1),
+pFileKnownSize(-1),
+pBaseDirFd(-1),
+pDirectoryFd(-1),
+pLayoutEntry(nullptr),
 pFileHashReadSize(1024L * 8L),
+pBlockSizePolicy(std::make_shared<derlBlockSizePolicy>()),
+pHashAlgorithm(derlHasher::Algorithm::sha256),
+pHashTree(false),
+pHashThreadCount(std::max(1, (int)std::thread::hardware_concurrency())),
+pLayoutThreadCount(1),
 pLogClassName("derlBaseTaskProcessor"),
 pEnableDebugLog(false){
 }
 
+derlBaseTaskProcessor::~derlBaseTaskProcessor() noexcept{
+#ifdef OS_UNIX
+	// base directory file descriptor is closed by CalcFileLayout()
+	if(pDirectoryFd != -1){
+		close(pDirectoryFd);
+	}
+#endif
+}
+
 // Management
 ///////////////
 
@@ -54,6 +137,41 @@ void derlBaseTaskProcessor::SetBaseDirectory(const std::filesystem::path &path){
 	pBaseDir = path;
 }
 
+void derlBaseTaskProcessor::SetBlockSizePolicy(const derlBlockSizePolicy::Ref &policy){
+	pBlockSizePolicy = policy ? policy : std::make_shared<derlBlockSizePolicy>();
+}
+
+void derlBaseTaskProcessor::SetHashAlgorithm(derlHasher::Algorithm algorithm){
+	pHashAlgorithm = algorithm;
+}
+
+void derlBaseTaskProcessor::SetHashTree(bool hashTree){
+	pHashTree = hashTree;
+}
+
+void derlBaseTaskProcessor::SetHashThreadCount(int count){
+	pHashThreadCount = std::max(1, count);
+}
+
+void derlBaseTaskProcessor::SetEnableMemoryMap(bool enable){
+	pEnableMemoryMap = enable;
+}
+
+void derlBaseTaskProcessor::SetIoEngine(IoEngine engine){
+	pIoEngine = engine;
+	if(engine != IoEngine::ioUring){
+		pIoUring.reset();
+	}
+}
+
+void derlBaseTaskProcessor::SetIoQueueDepth(int depth){
+	pIoQueueDepth = std::max(1, depth);
+}
+
+void derlBaseTaskProcessor::SetHashCache(const derlHashCache::Ref &cache){
+	pHashCache = cache;
+}
+
 void derlBaseTaskProcessor::Exit(){
 	pExit = true;
 }
@@ -67,35 +185,250 @@ void derlBaseTaskProcessor::Run(){
 void derlBaseTaskProcessor::CalcFileLayout(derlFileLayout &layout, const std::string &pathDir){
 	//LogDebug("CalcFileLayout", pathDir);
 	
-	if(!IsPathDirectory(pathDir)){
-		return; // directory does not exist. report empty layout
+	const bool openBaseDirFd = pBaseDirFd == -1;
+	if(openBaseDirFd){
+		pOpenBaseDirFd();
 	}
 	
-	ListDirEntries entries;
-	ListDirectoryFiles(entries, pathDir);
-	
-	for(const DirectoryEntry &each : entries){
-		if(each.isDirectory){
-			CalcFileLayout(layout, each.path);
-			if(pExit){
-				return;
+	try{
+		if(IsPathDirectory(pathDir)){
+			if(pLayoutThreadCount > 1){
+				pCalcFileLayoutParallel(layout, pathDir);
+				
+			}else{
+				pCalcFileLayoutSerial(layout, pathDir);
 			}
+		}
+		
+	}catch(...){
+		if(openBaseDirFd){
+			pCloseLayoutFds();
+		}
+		throw;
+	}
+	
+	if(openBaseDirFd){
+		pCloseLayoutFds();
+	}
+}
+
+void derlBaseTaskProcessor::OnLayoutFileAdded(const derlFile::Ref &){
+}
+
+derlFile::Ref derlBaseTaskProcessor::CalcLayoutFile(const DirectoryEntry &entry){
+	const derlFile::Ref file(std::make_shared<derlFile>(entry.path));
+	file->SetSize(entry.fileSize);
+	const uint64_t blockSize = pBlockSizePolicy->GetBlockSize(entry.path, entry.fileSize);
+	if(!LoadCachedFileHashes(*file, entry, blockSize)){
+		// the listed size is used instead of looking it up again
+		pLayoutEntry = &entry;
+		try{
+			CalcFileHashes(*file, blockSize);
 			
-		}else{
-			const derlFile::Ref file(std::make_shared<derlFile>(each.path));
-			file->SetSize(each.fileSize);
-			CalcFileHash(*file);
-			layout.AddFile(file);
+		}catch(...){
+			pLayoutEntry = nullptr;
+			throw;
 		}
+		pLayoutEntry = nullptr;
+		
+		StoreCachedFileHashes(*file, entry);
+	}
+	return file;
+}
+
+bool derlBaseTaskProcessor::IsHashCacheFile(const std::string &path) const{
+	return pHashCache && pBaseDir / path == pHashCache->GetPath();
+}
+
+void derlBaseTaskProcessor::SetLayoutThreadCount(int count){
+	pLayoutThreadCount = std::max(1, count);
+}
+
+std::unique_ptr<derlBaseTaskProcessor> derlBaseTaskProcessor::CreateLayoutWorker(){
+	return std::make_unique<cLayoutWorker>();
+}
+
+derlWorkerPool &derlBaseTaskProcessor::GetLayoutWorkerPool(){
+	if(!pLayoutWorkerPool || pLayoutWorkerPool->GetThreadCount() != pLayoutThreadCount){
+		pLayoutWorkerPool.reset();
+		pLayoutWorkerPool = std::make_unique<derlWorkerPool>(pLayoutThreadCount);
+	}
+	return *pLayoutWorkerPool;
+}
+
+void derlBaseTaskProcessor::SaveHashCache(const derlFileLayout &layout){
+	if(!pHashCache){
+		return;
+	}
+	
+	try{
+		pHashCache->Retain(layout);
+		pHashCache->Save();
+		
+	}catch(const std::exception &e){
+		LogException("SaveHashCache", e, pHashCache->GetPath().string());
 	}
 }
 
+bool derlBaseTaskProcessor::LoadCachedFileHashes(derlFile &file,
+const DirectoryEntry &entry, uint64_t blockSize){
+	if(!pHashCache || entry.modificationTime == 0){
+		return false;
+	}
+	
+	derlHashCache::Entry cached;
+	if(!pHashCache->Get(entry.path, cached)){
+		return false;
+	}
+	
+	if(cached.size != entry.fileSize || cached.modificationTime != entry.modificationTime
+	|| cached.inode != entry.inode || cached.algorithm != pHashAlgorithm
+	|| cached.hashTree != pHashTree || cached.blockSize != (uint32_t)blockSize){
+		return false;
+	}
+	
+	const uint64_t blockCount = blockSize > 0L && cached.size > blockSize
+		? ((cached.size - 1L) / blockSize) + 1L : 1L;
+	if(cached.blockHashes.size() != blockCount){
+		return false;
+	}
+	
+	derlFileBlock::List blocks;
+	uint64_t i;
+	
+	if(blockCount == 1L){
+		const derlFileBlock::Ref block(std::make_shared<derlFileBlock>(0, cached.size));
+		block->SetHash(cached.blockHashes.front());
+		blocks.push_back(block);
+		
+	}else{
+		for(i=0L; i<blockCount; i++){
+			const uint64_t blockOffset = blockSize * i;
+			const derlFileBlock::Ref block(std::make_shared<derlFileBlock>(
+				blockOffset, std::min(blockSize, cached.size - blockOffset)));
+			block->SetHash(cached.blockHashes.at(i));
+			blocks.push_back(block);
+		}
+	}
+	
+	file.SetSize(cached.size);
+	file.SetHash(cached.hash);
+	file.SetBlockSize((uint32_t)blockSize);
+	file.SetBlocks(blocks);
+	file.SetHasBlocks(true);
+	return true;
+}
+
+void derlBaseTaskProcessor::StoreCachedFileHashes(const derlFile &file, const DirectoryEntry &entry){
+	if(!pHashCache || entry.modificationTime == 0 || file.GetSize() != entry.fileSize
+	|| fileTimeNow() - entry.modificationTime < vHashCacheRacyTime){
+		return;
+	}
+	
+	derlHashCache::Entry cached;
+	cached.size = file.GetSize();
+	cached.modificationTime = entry.modificationTime;
+	cached.inode = entry.inode;
+	cached.algorithm = pHashAlgorithm;
+	cached.hashTree = pHashTree;
+	cached.blockSize = file.GetBlockSize();
+	cached.hash = file.GetHash();
+	
+	derlFileBlock::List::const_iterator iter;
+	for(iter=file.GetBlocksBegin(); iter!=file.GetBlocksEnd(); iter++){
+		cached.blockHashes.push_back((*iter)->GetHash());
+	}
+	
+	pHashCache->Set(entry.path, cached);
+}
+
 bool derlBaseTaskProcessor::IsPathDirectory(const std::string &pathDir){
+#ifdef OS_UNIX
+	if(pBaseDirFd != -1){
+		struct stat st;
+		return fstatat(pBaseDirFd, pathDir.empty() ? "." : pathDir.c_str(), &st, 0) == 0
+			&& S_ISDIR(st.st_mode);
+	}
+#endif
 	return std::filesystem::is_directory(pBaseDir / pathDir);
 }
 
 void derlBaseTaskProcessor::ListDirectoryFiles(ListDirEntries &entries, const std::string &pathDir){
 	//LogDebug("ListDirectoryFiles", pathDir);
+#ifdef OS_UNIX
+	if(pDirectoryFd != -1){
+		close(pDirectoryFd);
+		pDirectoryFd = -1;
+		pDirectoryFdPath.clear();
+	}
+	
+	const char * const relPath = pathDir.empty() ? "." : pathDir.c_str();
+	const int fd = pBaseDirFd != -1
+		? openat(pBaseDirFd, relPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+		: open((pBaseDir / pathDir).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if(fd == -1){
+		throw std::runtime_error(std::strerror(errno));
+	}
+	
+	const std::string prefix(pathDir.empty() ? std::string() : pathDir + "/");
+	std::unique_ptr<char[]> buffer(new char[vDirentBufferSize]);
+	
+	while(true){
+		const long readBytes = syscall(SYS_getdents64, fd, buffer.get(), vDirentBufferSize);
+		if(readBytes == -1){
+			const int error = errno;
+			close(fd);
+			throw std::runtime_error(std::strerror(error));
+		}
+		if(readBytes == 0){
+			break;
+		}
+		
+		long position = 0;
+		while(position < readBytes){
+			const sLinuxDirent64 &dirent = *(const sLinuxDirent64*)(buffer.get() + position);
+			position += dirent.recordLength;
+			
+			const char * const name = dirent.name;
+			if(name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))){
+				continue;
+			}
+			
+			if(dirent.type == DT_DIR){
+				entries.push_back({name, prefix + name, 0, true, 0, 0});
+				continue;
+			}
+			
+			if(dirent.type != DT_REG && dirent.type != DT_LNK && dirent.type != DT_UNKNOWN){
+				continue;
+			}
+			
+			struct stat st;
+			if(fstatat(fd, name, &st, 0) != 0){
+				continue;
+			}
+			
+			if(S_ISDIR(st.st_mode)){
+				entries.push_back({name, prefix + name, 0, true, 0, 0});
+				
+			}else if(S_ISREG(st.st_mode)){
+				entries.push_back({name, prefix + name, (uint64_t)st.st_size, false,
+					(int64_t)st.st_mtim.tv_sec * 1000000000LL + (int64_t)st.st_mtim.tv_nsec,
+					(uint64_t)st.st_ino});
+			}
+		}
+	}
+	
+	// keep directory open while calculating file layout to open the listed files
+	if(pBaseDirFd != -1){
+		pDirectoryFd = fd;
+		pDirectoryFdPath = pathDir;
+		
+	}else{
+		close(fd);
+	}
+	
+#else
 	const std::filesystem::path fspathDir(pathDir);
 	
 	std::filesystem::directory_iterator iter{pBaseDir / pathDir};
@@ -103,33 +436,33 @@ void derlBaseTaskProcessor::ListDirectoryFiles(ListDirEntries &entries, const st
 		const std::string filename(entry.path().filename().generic_string());
 		
 		if(entry.is_directory()){
-			entries.push_back({filename, (fspathDir / filename).generic_string(), 0, true});
+			entries.push_back({filename, (fspathDir / filename).generic_string(), 0, true, 0, 0});
 			
 		}else if(entry.is_regular_file()){
-			entries.push_back({filename, (fspathDir / filename).generic_string(), entry.file_size(), false});
+			entries.push_back({filename, (fspathDir / filename).generic_string(), entry.file_size(), false,
+				std::chrono::duration_cast<std::chrono::nanoseconds>(
+					entry.last_write_time().time_since_epoch()).count(), 0});
 		}
 	}
+#endif
 }
 
 void derlBaseTaskProcessor::CalcFileHash(derlFile &file){
 	//LogDebug("CalcFileHash", file.GetPath());
+	if(pHashTree && file.GetSize() > derlProtocol::treeHashLeafSize){
+		CalcFileHashes(file, file.GetBlockSize());
+		return;
+	}
+	
 	const uint64_t fileSize = file.GetSize();
-	SHA256 hash;
+	derlHasher hasher(pHashAlgorithm);
 	
 	if(fileSize > 0L){
-		const uint64_t blockCount = ((fileSize - 1L) / pFileHashReadSize) + 1L;
-		std::string blockData;
-		uint64_t i;
+		std::string readData;
 		
 		try{
 			OpenFile(file.GetPath(), false);
-			for(i=0L; i<blockCount; i++){
-				const uint64_t blockOffset = pFileHashReadSize * i;
-				const uint64_t blockSize = std::min(pFileHashReadSize, fileSize - blockOffset);
-				blockData.assign(blockSize, 0);
-				ReadFile((void*)blockData.c_str(), blockOffset, blockSize);
-				hash.add(blockData.c_str(), blockSize);
-			}
+			HashFileData(hasher, nullptr, 0, fileSize, readData);
 			CloseFile();
 			
 		}catch(const std::exception &e){
@@ -144,7 +477,7 @@ void derlBaseTaskProcessor::CalcFileHash(derlFile &file){
 		}
 	}
 	
-	file.SetHash(hash.getHash());
+	file.SetHash(hasher.GetDigest());
 }
 
 void derlBaseTaskProcessor::CalcFileBlockHashes(derlFileBlock::List &blocks,
@@ -157,18 +490,18 @@ const std::string &path, uint64_t blockSize){
 		const uint64_t fileSize = GetFileSize();
 		if(fileSize > 0L){
 			const uint64_t blockCount = ((fileSize - 1L) / blockSize) + 1L;
+			std::string readData;
 			uint64_t i;
 			
 			for(i=0L; i<blockCount; i++){
 				const uint64_t nextOffset = blockSize * i;
 				const uint64_t nextSize = std::min(blockSize, fileSize - nextOffset);
 				
-				std::string blockData;
-				blockData.assign(nextSize, 0);
-				ReadFile((void*)blockData.c_str(), nextOffset, nextSize);
+				derlHasher hasher(pHashAlgorithm);
+				HashFileData(hasher, nullptr, nextOffset, nextSize, readData);
 				
 				const derlFileBlock::Ref block(std::make_shared<derlFileBlock>(nextOffset, nextSize));
-				block->SetHash(SHA256()(blockData));
+				block->SetHash(hasher.GetDigest());
 				blocks.push_back(block);
 			}
 		}
@@ -187,6 +520,356 @@ const std::string &path, uint64_t blockSize){
 	}
 }
 
+void derlBaseTaskProcessor::CalcFileHashes(derlFile &file, uint64_t blockSize){
+	//LogDebug("CalcFileHashes", file.GetPath());
+	const uint64_t leafSize = derlProtocol::treeHashLeafSize;
+	derlFileBlock::List blocks;
+	std::vector<derlDigest> leaves;
+	derlHasher hasherFile(pHashAlgorithm);
+	uint64_t fileSize = 0L;
+	bool hashTree = false;
+	
+	try{
+		OpenFile(file.GetPath(), false);
+		fileSize = GetFileSize();
+		
+		// leaves are hashed together with the blocks if block boundaries are leaf boundaries.
+		// if the block size is the leaf size the block hashes are the leaf hashes
+		const bool multipleBlocks = blockSize > 0L && fileSize > blockSize;
+		hashTree = pHashTree && fileSize > leafSize;
+		
+		const bool blockLeaves = hashTree && blockSize != leafSize
+			&& (!multipleBlocks || blockSize % leafSize == 0L);
+		if(hashTree){
+			leaves.resize(((fileSize - 1L) / leafSize) + 1L);
+		}
+		
+		if(multipleBlocks && pHashThreadCount > 1){
+			CalcBlockHashesParallel(blocks, hasherFile, blockLeaves ? &leaves : nullptr,
+				fileSize, blockSize);
+			
+		}else if(multipleBlocks){
+			const uint64_t blockCount = ((fileSize - 1L) / blockSize) + 1L;
+			std::string readData;
+			uint64_t i;
+			
+			for(i=0L; i<blockCount; i++){
+				const uint64_t blockOffset = blockSize * i;
+				const uint64_t blockEnd = std::min(blockOffset + blockSize, fileSize);
+				derlHasher hasherBlock(pHashAlgorithm);
+				
+				if(blockLeaves){
+					HashFileLeaves(leaves, &hasherBlock, blockOffset, blockEnd - blockOffset, readData);
+					
+				}else{
+					HashFileData(hasherBlock, hashTree ? nullptr : &hasherFile,
+						blockOffset, blockEnd - blockOffset, readData);
+				}
+				
+				const derlFileBlock::Ref block(std::make_shared<derlFileBlock>(blockOffset, blockEnd - blockOffset));
+				block->SetHash(hasherBlock.GetDigest());
+				blocks.push_back(block);
+			}
+			
+		}else if(blockLeaves){
+			std::string readData;
+			HashFileLeaves(leaves, &hasherFile, 0, fileSize, readData);
+			
+		}else if(fileSize > 0L){
+			std::string readData;
+			HashFileData(hasherFile, nullptr, 0, fileSize, readData);
+		}
+		
+		if(hashTree && blockSize == leafSize){
+			std::transform(blocks.cbegin(), blocks.cend(), leaves.begin(),
+				[](const derlFileBlock::Ref &block){ return block->GetHash(); });
+			
+		}else if(hashTree && !blockLeaves){
+			// block boundaries are not leaf boundaries. hash leaves in a second pass
+			std::string readData;
+			HashFileLeaves(leaves, nullptr, 0, fileSize, readData);
+		}
+		
+		CloseFile();
+		
+	}catch(const std::exception &e){
+		LogException("CalcFileHashes", e, file.GetPath());
+		CloseFile();
+		throw;
+		
+	}catch(...){
+		Log(denLogger::LogSeverity::error, "CalcFileHashes", file.GetPath());
+		CloseFile();
+		throw;
+	}
+	
+	const derlDigest digestFile(hasherFile.GetDigest());
+	
+	if(blocks.empty()){
+		const derlFileBlock::Ref block(std::make_shared<derlFileBlock>(0, fileSize));
+		block->SetHash(digestFile);
+		blocks.push_back(block);
+	}
+	
+	file.SetSize(fileSize);
+	file.SetHash(hashTree ? CalcTreeHash(leaves) : digestFile);
+	file.SetBlockSize((uint32_t)blockSize);
+	file.SetBlocks(blocks);
+	file.SetHasBlocks(true);
+}
+
+void derlBaseTaskProcessor::CalcFileWeakHashes(derlFile &file){
+	try{
+		OpenFile(file.GetPath(), false);
+		
+		std::string readData;
+		derlFileBlock::List::const_iterator iter;
+		for(iter=file.GetBlocksBegin(); iter!=file.GetBlocksEnd(); iter++){
+			derlFileBlock &block = **iter;
+			
+			const void *data = GetFileData(block.GetOffset(), block.GetSize());
+			if(!data){
+				readData.assign(block.GetSize(), 0);
+				ReadFile((void*)readData.c_str(), block.GetOffset(), block.GetSize());
+				data = readData.c_str();
+			}
+			
+			block.SetWeakHash(derlRollingChecksum::Calc(data, block.GetSize()));
+		}
+		
+		CloseFile();
+		file.SetHasWeakHashes(true);
+		
+	}catch(const std::exception &e){
+		LogException("CalcFileWeakHashes", e, file.GetPath());
+		CloseFile();
+		throw;
+		
+	}catch(...){
+		Log(denLogger::LogSeverity::error, "CalcFileWeakHashes", file.GetPath());
+		CloseFile();
+		throw;
+	}
+}
+
+void derlBaseTaskProcessor::CalcFileChunks(derlFile &file, uint32_t averageSize){
+	const derlFastCdc chunker(averageSize);
+	derlFileBlock::List blocks;
+	derlHasher hasher(pHashAlgorithm);
+	uint64_t fileSize = 0L;
+	
+	try{
+		OpenFile(file.GetPath(), false);
+		fileSize = GetFileSize();
+		
+		// memory mapped files are chunked directly, otherwise through a sliding buffer
+		const uint8_t *data = (const uint8_t*)GetFileData(0, fileSize);
+		const uint64_t readSize = std::max((uint64_t)4 * 1024 * 1024, chunker.GetMaxSize() * 2);
+		std::string buffer;
+		uint64_t bufferOffset = 0L;
+		uint64_t bufferSize = data ? fileSize : 0L;
+		uint64_t offset = 0L;
+		
+		while(offset < fileSize){
+			const uint64_t available = std::min(fileSize - offset, chunker.GetMaxSize());
+			if(offset + available > bufferOffset + bufferSize){
+				bufferOffset = offset;
+				bufferSize = std::min(readSize, fileSize - offset);
+				buffer.assign(bufferSize, 0);
+				ReadFile((void*)buffer.c_str(), bufferOffset, bufferSize);
+				data = (const uint8_t*)buffer.c_str();
+			}
+			
+			const uint8_t * const chunk = data + (offset - bufferOffset);
+			const uint64_t size = chunker.NextChunk(chunk, available);
+			
+			hasher.Reset();
+			hasher.Add(chunk, size);
+			const derlFileBlock::Ref block(std::make_shared<derlFileBlock>(offset, size));
+			block->SetHash(hasher.GetDigest());
+			blocks.push_back(block);
+			
+			offset += size;
+		}
+		
+		CloseFile();
+		
+	}catch(const std::exception &e){
+		LogException("CalcFileChunks", e, file.GetPath());
+		CloseFile();
+		throw;
+		
+	}catch(...){
+		Log(denLogger::LogSeverity::error, "CalcFileChunks", file.GetPath());
+		CloseFile();
+		throw;
+	}
+	
+	file.SetSize(fileSize);
+	file.SetBlockSize(averageSize);
+	file.SetBlocks(blocks);
+	file.SetHasBlocks(true);
+	file.SetContentChunks(true);
+}
+
+void derlBaseTaskProcessor::CalcBlockHashesParallel(derlFileBlock::List &blocks,
+derlHasher &hasherFile, std::vector<derlDigest> *leaves, uint64_t fileSize, uint64_t blockSize){
+	derlWorkerPool &pool = GetHashWorkerPool();
+	const int maxPending = pool.GetThreadCount() * 2;
+	const derlHasher::Algorithm algorithm = pHashAlgorithm;
+	const uint64_t blockCount = ((fileSize - 1L) / blockSize) + 1L;
+	uint64_t i;
+	
+	try{
+		if(pFileDescriptor != -1){
+			// reads stay in flight while the worker pool hashes
+			IoUringReadAhead(0, fileSize, blockSize, [&](const std::shared_ptr<std::string> &data){
+				const derlFileBlock::Ref block(std::make_shared<derlFileBlock>(
+					blockSize * blocks.size(), data->size()));
+				blocks.push_back(block);
+				
+				if(!pHashTree){
+					hasherFile.Add(data->c_str(), data->size());
+				}
+				
+				pool.WaitPendingBelow(maxPending);
+				pool.Add([algorithm, block, data, leaves](){
+					HashBlockData(algorithm, *block, data->c_str(), leaves);
+				});
+			});
+		}else{
+			for(i=0L; i<blockCount; i++){
+				const uint64_t blockOffset = blockSize * i;
+				const uint64_t size = std::min(blockSize, fileSize - blockOffset);
+				
+				const derlFileBlock::Ref block(std::make_shared<derlFileBlock>(blockOffset, size));
+				blocks.push_back(block);
+				
+				// mapped file data stays valid until the file is closed after all jobs finished
+				const void * const mapped = GetFileData(blockOffset, size);
+				if(mapped){
+					if(!pHashTree){
+						hasherFile.Add(mapped, size);
+					}
+					
+					pool.WaitPendingBelow(maxPending);
+					pool.Add([algorithm, block, mapped, leaves](){
+						HashBlockData(algorithm, *block, mapped, leaves);
+					});
+					continue;
+				}
+				
+				// reading stays on this thread since file access is not thread safe
+				const std::shared_ptr<std::string> data(std::make_shared<std::string>(size, 0));
+				ReadFile((void*)data->c_str(), blockOffset, size);
+				if(!pHashTree){
+					hasherFile.Add(data->c_str(), size);
+				}
+				
+				pool.WaitPendingBelow(maxPending);
+				pool.Add([algorithm, block, data, leaves](){
+					HashBlockData(algorithm, *block, data->c_str(), leaves);
+				});
+			}
+		}
+		
+	}catch(...){
+		try{
+			pool.WaitAll();
+		}catch(...){
+		}
+		throw;
+	}
+	
+	pool.WaitAll();
+}
+
+void derlBaseTaskProcessor::HashBlockData(derlHasher::Algorithm algorithm,
+derlFileBlock &block, const void *data, std::vector<derlDigest> *leaves){
+	const uint64_t size = block.GetSize();
+	derlHasher hasher(algorithm);
+	hasher.Add(data, size);
+	block.SetHash(hasher.GetDigest());
+	
+	if(!leaves){
+		return;
+	}
+	
+	const uint64_t leafSize = derlProtocol::treeHashLeafSize;
+	uint64_t offset;
+	for(offset=0L; offset<size; offset+=leafSize){
+		hasher.Reset();
+		hasher.Add((const uint8_t*)data + offset, std::min(leafSize, size - offset));
+		leaves->at((block.GetOffset() + offset) / leafSize) = hasher.GetDigest();
+	}
+}
+
+void derlBaseTaskProcessor::HashFileLeaves(std::vector<derlDigest> &leaves, derlHasher *hasherFile,
+uint64_t offset, uint64_t size, std::string &buffer){
+	const uint64_t leafSize = derlProtocol::treeHashLeafSize;
+	const uint64_t end = offset + size;
+	
+	while(offset < end){
+		derlHasher hasher(pHashAlgorithm);
+		const uint64_t leafEnd = std::min(offset + leafSize, end);
+		HashFileData(hasher, hasherFile, offset, leafEnd - offset, buffer);
+		leaves.at(offset / leafSize) = hasher.GetDigest();
+		offset = leafEnd;
+	}
+}
+
+void derlBaseTaskProcessor::HashFileData(derlHasher &hasher, derlHasher *hasherFile,
+uint64_t offset, uint64_t size, std::string &buffer){
+	const void * const mapped = GetFileData(offset, size);
+	if(mapped){
+		hasher.Add(mapped, size);
+		if(hasherFile){
+			hasherFile->Add(mapped, size);
+		}
+		return;
+	}
+	
+	if(pFileDescriptor != -1){
+		IoUringReadAhead(offset, size, pIoReadSize, [&](const std::shared_ptr<std::string> &data){
+			hasher.Add(data->c_str(), data->size());
+			if(hasherFile){
+				hasherFile->Add(data->c_str(), data->size());
+			}
+		});
+		return;
+	}
+	
+	const uint64_t end = offset + size;
+	while(offset < end){
+		buffer.resize(std::min(pFileHashReadSize, end - offset));
+		ReadFile((void*)buffer.c_str(), offset, buffer.size());
+		hasher.Add(buffer.c_str(), buffer.size());
+		if(hasherFile){
+			hasherFile->Add(buffer.c_str(), buffer.size());
+		}
+		offset += buffer.size();
+	}
+}
+
+derlDigest derlBaseTaskProcessor::CalcTreeHash(const std::vector<derlDigest> &leaves) const{
+	const int digestSize = derlHasher::DigestSize(pHashAlgorithm);
+	derlHasher hasher(pHashAlgorithm);
+	
+	for(const derlDigest &leaf : leaves){
+		hasher.Add(leaf.GetBytes(), digestSize);
+	}
+	
+	return hasher.GetDigest();
+}
+
+derlWorkerPool &derlBaseTaskProcessor::GetHashWorkerPool(){
+	if(!pHashWorkerPool || pHashWorkerPool->GetThreadCount() != pHashThreadCount){
+		pHashWorkerPool.reset();
+		pHashWorkerPool = std::make_unique<derlWorkerPool>(pHashThreadCount);
+	}
+	return *pHashWorkerPool;
+}
+
 void derlBaseTaskProcessor::TruncateFile(const std::string &path){
 	CloseFile();
 	pFilePath = pBaseDir / path;
@@ -221,11 +904,140 @@ void derlBaseTaskProcessor::TruncateFile(const std::string &path){
 	CloseFile();
 }
 
+void derlBaseTaskProcessor::ResizeFile(const std::string &path, uint64_t size){
+	CloseFile();
+	
+	try{
+		std::filesystem::resize_file(pBaseDir / path, size);
+		
+	}catch(const std::exception &e){
+		LogException("ResizeFile", e, path);
+		throw;
+		
+	}catch(...){
+		Log(denLogger::LogSeverity::error, "ResizeFile", path);
+		throw;
+	}
+}
+
+void derlBaseTaskProcessor::PreallocateFile(const std::string &path, uint64_t size){
+	CloseFile();
+	const std::filesystem::path filePath(pBaseDir / path);
+	
+	try{
+		if(filePath.has_parent_path()){
+			std::filesystem::create_directories(filePath.parent_path());
+		}
+		
+#ifdef OS_UNIX
+		if(size > 0){
+			const int fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+			if(fd == -1){
+				throw std::runtime_error(std::strerror(errno));
+			}
+			
+			// mode 0 allocates and grows the file. file systems not supporting allocation
+			// fail with EOPNOTSUPP in which case the file is resized below
+			const int result = fallocate(fd, 0, 0, (off_t)size);
+			const int error = errno;
+			close(fd);
+			
+			if(result == 0){
+				return;
+			}
+			if(error != EOPNOTSUPP && error != ENOSYS){
+				throw std::runtime_error(std::strerror(error));
+			}
+		}
+#endif
+		
+		if(!std::filesystem::exists(filePath)){
+			std::ofstream stream(filePath, std::ios_base::binary | std::ios_base::out);
+			if(stream.fail()){
+				throw std::runtime_error("Failed creating file");
+			}
+		}
+		
+		if(std::filesystem::file_size(filePath) < size){
+			std::filesystem::resize_file(filePath, size);
+		}
+		
+	}catch(const std::exception &e){
+		LogException("PreallocateFile", e, path);
+		throw;
+		
+	}catch(...){
+		Log(denLogger::LogSeverity::error, "PreallocateFile", path);
+		throw;
+	}
+}
+
+void derlBaseTaskProcessor::ZeroFileRange(const std::string &path, uint64_t offset, uint64_t size){
+	CloseFile();
+	const std::filesystem::path filePath(pBaseDir / path);
+	
+	try{
+#ifdef OS_UNIX
+		const int fd = open(filePath.c_str(), O_WRONLY | O_CLOEXEC);
+		if(fd == -1){
+			throw std::runtime_error(std::strerror(errno));
+		}
+		
+		const int result = fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+			(off_t)offset, (off_t)size);
+		const int error = errno;
+		close(fd);
+		
+		if(result == 0){
+			return;
+		}
+		if(error != EOPNOTSUPP && error != ENOSYS){
+			throw std::runtime_error(std::strerror(error));
+		}
+#endif
+		
+		std::fstream stream(filePath, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+		stream.seekp(offset, std::ios_base::beg);
+		
+		const std::string zeros((size_t)std::min(size, (uint64_t)65536), 0);
+		uint64_t remaining = size;
+		while(remaining > 0 && !stream.fail()){
+			const uint64_t count = std::min(remaining, (uint64_t)zeros.size());
+			stream.write(zeros.c_str(), count);
+			remaining -= count;
+		}
+		
+		stream.close();
+		if(stream.fail()){
+			throw std::runtime_error("Failed writing to file");
+		}
+		
+	}catch(const std::exception &e){
+		LogException("ZeroFileRange", e, path);
+		throw;
+		
+	}catch(...){
+		Log(denLogger::LogSeverity::error, "ZeroFileRange", path);
+		throw;
+	}
+}
+
 void derlBaseTaskProcessor::OpenFile(const std::string &path, bool write){
 	CloseFile();
 	pFilePath = pBaseDir / path;
 	
+	if(!write && pLayoutEntry && pLayoutEntry->path == path){
+		pFileKnownSize = (int64_t)pLayoutEntry->fileSize;
+	}
+	
 	try{
+		if(!write && pEnableMemoryMap && pMapFile(path)){
+			return;
+		}
+		if(pIoEngine == IoEngine::ioUring && pOpenFileIoUring(path, write)){
+			return;
+		}
+		
 		if(write && pFilePath.has_parent_path()){
 			std::filesystem::create_directories(pFilePath.parent_path());
 		}
@@ -279,7 +1091,24 @@ void derlBaseTaskProcessor::OpenFile(const std::string &path, bool write){
 }
 
 uint64_t derlBaseTaskProcessor::GetFileSize(){
+	if(pFileMapped){
+		return pFileMappingSize;
+	}
+	if(pFileKnownSize != -1){
+		return (uint64_t)pFileKnownSize;
+	}
+	
 	try{
+#ifdef OS_UNIX
+		if(pFileDescriptor != -1){
+			struct stat st;
+			if(fstat(pFileDescriptor, &st) != 0){
+				throw std::runtime_error("Failed getting file size");
+			}
+			return (uint64_t)st.st_size;
+		}
+#endif
+		
 		pFileStream->seekg(0, pFileStream->end);
 		const uint64_t size = pFileStream->tellg();
 		if(pFileStream->fail()){
@@ -301,6 +1130,20 @@ uint64_t derlBaseTaskProcessor::GetFileSize(){
 
 void derlBaseTaskProcessor::ReadFile(void *data, uint64_t offset, uint64_t size){
 	try{
+		if(pFileMapped){
+			const void * const mapped = GetFileData(offset, size);
+			if(!mapped){
+				throw std::runtime_error("Failed reading from file");
+			}
+			memcpy(data, mapped, size);
+			return;
+		}
+		
+		if(pFileDescriptor != -1){
+			IoUringRead(data, offset, size);
+			return;
+		}
+		
 		pFileStream->seekg(offset, std::ios_base::beg);
 		if(pFileStream->fail()){
 			pFileStream->clear();
@@ -323,7 +1166,31 @@ void derlBaseTaskProcessor::ReadFile(void *data, uint64_t offset, uint64_t size)
 	}
 }
 
+const void *derlBaseTaskProcessor::GetFileData(uint64_t offset, uint64_t size){
+	if(!pFileMapped || offset > pFileMappingSize || size > pFileMappingSize - offset){
+		return nullptr;
+	}
+	return pFileMapping + offset;
+}
+
 void derlBaseTaskProcessor::CloseFile(){
+#ifdef OS_UNIX
+	if(pFileMapping){
+		munmap((void*)pFileMapping, pFileMappingSize);
+	}
+#endif
+	pFileMapped = false;
+	pFileMapping = nullptr;
+	pFileMappingSize = 0;
+	
+#ifdef OS_UNIX
+	if(pFileDescriptor != -1){
+		close(pFileDescriptor);
+		pFileDescriptor = -1;
+	}
+#endif
+	
+	pFileKnownSize = -1;
 	pFilePath.clear();
 	pFileStream.reset();
 }
@@ -359,3 +1226,415 @@ void derlBaseTaskProcessor::LogDebug(const std::string &functionName, const std:
 		Log(denLogger::LogSeverity::debug, functionName, message);
 	}
 }
+
+
+// Protected Functions
+////////////////////////
+
+void derlBaseTaskProcessor::IoUringRead(void *data, uint64_t offset, uint64_t size){
+	uint8_t *next = (uint8_t*)data;
+	
+	while(size > 0L){
+		uint64_t userData;
+		int result;
+		
+		pIoUring->QueueRead(pFileDescriptor, next, (uint32_t)std::min(size, pIoReadSize), offset, 0);
+		pIoUring->WaitCompletion(userData, result);
+		if(result < 0){
+			throw std::runtime_error(std::strerror(-result));
+		}
+		if(result == 0){
+			throw std::runtime_error("Failed reading from file");
+		}
+		
+		next += result;
+		offset += (uint64_t)result;
+		size -= (uint64_t)result;
+	}
+}
+
+void derlBaseTaskProcessor::IoUringWrite(const void *data, uint64_t offset, uint64_t size){
+	const uint8_t *next = (const uint8_t*)data;
+	
+	while(size > 0L){
+		uint64_t userData;
+		int result;
+		
+		pIoUring->QueueWrite(pFileDescriptor, next, (uint32_t)std::min(size, (uint64_t)1 << 30), offset, 0);
+		pIoUring->WaitCompletion(userData, result);
+		if(result < 0){
+			throw std::runtime_error(std::strerror(-result));
+		}
+		if(result == 0){
+			throw std::runtime_error("Failed writing to file");
+		}
+		
+		next += result;
+		offset += (uint64_t)result;
+		size -= (uint64_t)result;
+	}
+}
+
+void derlBaseTaskProcessor::IoUringReadAhead(uint64_t offset, uint64_t size, uint64_t chunkSize,
+const std::function<void(const std::shared_ptr<std::string>&)> &consumer){
+	struct sChunk{
+		std::shared_ptr<std::string> data;
+		uint64_t offset;
+		uint64_t done;
+	};
+	
+	const uint64_t chunkCount = size > 0L ? ((size - 1L) / chunkSize) + 1L : 0L;
+	std::deque<sChunk> chunks;
+	std::vector<std::shared_ptr<std::string>> unused;
+	uint64_t nextChunk = 0L, firstChunk = 0L;
+	
+	try{
+		while(firstChunk < chunkCount){
+			while(nextChunk < chunkCount && chunks.size() < (size_t)pIoQueueDepth){
+				sChunk chunk;
+				chunk.offset = chunkSize * nextChunk;
+				chunk.done = 0L;
+				
+				if(!unused.empty()){
+					chunk.data = unused.back();
+					unused.pop_back();
+					
+				}else{
+					chunk.data = std::make_shared<std::string>();
+				}
+				chunk.data->resize(std::min(chunkSize, size - chunk.offset));
+				
+				pIoUring->QueueRead(pFileDescriptor, (void*)chunk.data->c_str(),
+					(uint32_t)chunk.data->size(), offset + chunk.offset, nextChunk);
+				chunks.push_back(chunk);
+				nextChunk++;
+			}
+			
+			// wait until the first chunk is complete. later chunks continue reading meanwhile
+			while(chunks.front().done < chunks.front().data->size()){
+				uint64_t userData;
+				int result;
+				pIoUring->WaitCompletion(userData, result);
+				
+				if(result < 0){
+					throw std::runtime_error(std::strerror(-result));
+				}
+				if(result == 0){
+					throw std::runtime_error("Failed reading from file");
+				}
+				
+				sChunk &chunk = chunks.at((size_t)(userData - firstChunk));
+				chunk.done += (uint64_t)result;
+				if(chunk.done < chunk.data->size()){
+					pIoUring->QueueRead(pFileDescriptor, (void*)(chunk.data->c_str() + chunk.done),
+						(uint32_t)(chunk.data->size() - chunk.done),
+						offset + chunk.offset + chunk.done, userData);
+				}
+			}
+			
+			// reuse buffers the consumer did not keep. buffers still referenced by the
+			// consumer, for example by pending hash jobs, are released by the consumer
+			consumer(chunks.front().data);
+			if(chunks.front().data.use_count() == 1 && unused.size() < (size_t)pIoQueueDepth){
+				unused.push_back(chunks.front().data);
+			}
+			chunks.pop_front();
+			firstChunk++;
+		}
+		
+	}catch(...){
+		// buffers have to stay alive until the kernel is done with them
+		pIoUring->WaitAll();
+		throw;
+	}
+}
+
+
+// Private Functions
+//////////////////////
+
+void derlBaseTaskProcessor::pCalcFileLayoutSerial(derlFileLayout &layout, const std::string &pathDir){
+	ListDirEntries entries;
+	ListDirectoryFiles(entries, pathDir);
+	
+	// files first while the directory file descriptor of the listing is still open
+	for(const DirectoryEntry &each : entries){
+		if(!each.isDirectory && !IsHashCacheFile(each.path)){
+			const derlFile::Ref file(CalcLayoutFile(each));
+			layout.AddFile(file);
+			OnLayoutFileAdded(file);
+		}
+	}
+	
+	for(const DirectoryEntry &each : entries){
+		if(each.isDirectory){
+			pCalcFileLayoutSerial(layout, each.path);
+			if(pExit){
+				return;
+			}
+		}
+	}
+}
+
+void derlBaseTaskProcessor::pCalcFileLayoutParallel(derlFileLayout &layout, const std::string &pathDir){
+	derlWorkerPool &pool = GetLayoutWorkerPool();
+	
+	// file access of task processors is not thread safe. each job uses a worker of its own
+	std::vector<std::unique_ptr<derlBaseTaskProcessor>> workers;
+	std::mutex mutexWorkers;
+	
+	const auto acquireWorker = [&](){
+		{
+		const std::lock_guard guard(mutexWorkers);
+		if(!workers.empty()){
+			std::unique_ptr<derlBaseTaskProcessor> worker(std::move(workers.back()));
+			workers.pop_back();
+			return worker;
+		}
+		}
+		
+		std::unique_ptr<derlBaseTaskProcessor> worker(CreateLayoutWorker());
+		pInitLayoutWorker(*worker);
+		return worker;
+	};
+	
+	const auto releaseWorker = [&](std::unique_ptr<derlBaseTaskProcessor> &worker){
+		const std::lock_guard guard(mutexWorkers);
+		workers.push_back(std::move(worker));
+	};
+	
+	// large files are hashed afterwards on this thread using parallel block hashing
+	ListDirEntries largeFiles;
+	std::mutex mutexLargeFiles;
+	
+	std::function<void(const std::string&)> addDirectoryJob;
+	
+	const auto addFileJob = [&](const DirectoryEntry &entry){
+		pool.Add([&, entry](){
+			if(pExit){
+				return;
+			}
+			
+			std::unique_ptr<derlBaseTaskProcessor> worker(acquireWorker());
+			derlFile::Ref file;
+			try{
+				file = worker->CalcLayoutFile(entry);
+				
+			}catch(const std::exception &e){
+				LogException("CalcFileLayout", e, entry.path);
+				releaseWorker(worker);
+				throw;
+			}
+			releaseWorker(worker);
+			
+			layout.AddFileSync(file);
+			OnLayoutFileAdded(file);
+		});
+	};
+	
+	addDirectoryJob = [&](const std::string &path){
+		pool.Add([&, path](){
+			if(pExit){
+				return;
+			}
+			
+			ListDirEntries entries;
+			std::unique_ptr<derlBaseTaskProcessor> worker(acquireWorker());
+			try{
+				worker->ListDirectoryFiles(entries, path);
+				
+			}catch(const std::exception &e){
+				LogException("CalcFileLayout", e, path);
+				releaseWorker(worker);
+				throw;
+			}
+			releaseWorker(worker);
+			
+			for(const DirectoryEntry &each : entries){
+				if(each.isDirectory){
+					addDirectoryJob(each.path);
+					
+				}else if(IsHashCacheFile(each.path)){
+					continue;
+					
+				}else if(pHashThreadCount > 1
+				&& each.fileSize > pBlockSizePolicy->GetBlockSize(each.path, each.fileSize)){
+					const std::lock_guard guard(mutexLargeFiles);
+					largeFiles.push_back(each);
+					
+				}else{
+					addFileJob(each);
+				}
+			}
+		});
+	};
+	
+	addDirectoryJob(pathDir);
+	pool.WaitAll();
+	
+	for(const DirectoryEntry &each : largeFiles){
+		if(pExit){
+			return;
+		}
+		const derlFile::Ref file(CalcLayoutFile(each));
+		layout.AddFileSync(file);
+		OnLayoutFileAdded(file);
+	}
+}
+
+void derlBaseTaskProcessor::pInitLayoutWorker(derlBaseTaskProcessor &worker) const{
+	worker.pBaseDir = pBaseDir;
+	worker.pBaseDirFd = pBaseDirFd; // shared. closed by this processor
+	worker.pFileHashReadSize = pFileHashReadSize;
+	worker.pBlockSizePolicy = pBlockSizePolicy;
+	worker.pHashAlgorithm = pHashAlgorithm;
+	worker.pHashTree = pHashTree;
+	worker.pHashThreadCount = 1;
+	worker.pLayoutThreadCount = 1;
+	worker.pHashCache = pHashCache;
+	worker.pEnableMemoryMap = pEnableMemoryMap;
+	worker.pIoEngine = pIoEngine;
+	worker.pIoQueueDepth = pIoQueueDepth;
+	worker.pIoReadSize = pIoReadSize;
+	worker.pLogClassName = pLogClassName;
+	worker.pLogger = pLogger;
+	worker.pEnableDebugLog = pEnableDebugLog;
+}
+
+bool derlBaseTaskProcessor::pMapFile(const std::string &path){
+#ifdef OS_UNIX
+	const int fd = pOpenFileDescriptor(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1){
+		throw std::runtime_error(std::strerror(errno));
+	}
+	
+	struct stat st;
+	if(fstat(fd, &st) != 0){
+		close(fd);
+		return false;
+	}
+	
+	// mapping beyond the end of the file raises SIGBUS on access. a file shrunk since
+	// being listed fails like reading it using streams. grown files are read up to the
+	// listed size like streams do. this does not protect against truncating the file
+	// after this check while the mapping is read. see SetEnableMemoryMap()
+	uint64_t size = (uint64_t)st.st_size;
+	if(pFileKnownSize != -1){
+		if((uint64_t)pFileKnownSize > size){
+			close(fd);
+			throw std::runtime_error("File changed while reading");
+		}
+		size = (uint64_t)pFileKnownSize;
+	}
+	
+	if(size > 0L){
+		void * const mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(mapping == MAP_FAILED){
+			close(fd);
+			return false; // not mappable. use stream instead
+		}
+		
+		// data is read once front to back
+		madvise(mapping, size, MADV_SEQUENTIAL);
+		pFileMapping = (const uint8_t*)mapping;
+	}
+	
+	// mapping stays valid after closing the file descriptor
+	close(fd);
+	pFileMappingSize = size;
+	pFileMapped = true;
+	return true;
+	
+#else
+	(void)path;
+	return false;
+#endif
+}
+
+bool derlBaseTaskProcessor::pOpenFileIoUring(const std::string &path, bool write){
+#ifdef OS_UNIX
+	if(!pIoUring){
+		if(!derlIoUring::IsSupported()){
+			pIoEngine = IoEngine::stream;
+			return false;
+		}
+		
+		try{
+			pIoUring = std::make_unique<derlIoUring>(pIoQueueDepth);
+			
+		}catch(const std::exception &e){
+			LogException("OpenFile", e, "io_uring not available, using stream");
+			pIoEngine = IoEngine::stream;
+			return false;
+		}
+	}
+	
+	if(write && pFilePath.has_parent_path()){
+		std::filesystem::create_directories(pFilePath.parent_path());
+	}
+	
+	pFileDescriptor = pOpenFileDescriptor(path, write
+		? O_RDWR | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC);
+	if(pFileDescriptor == -1){
+		throw std::runtime_error(std::strerror(errno));
+	}
+	return true;
+	
+#else
+	(void)path;
+	(void)write;
+	pIoEngine = IoEngine::stream;
+	return false;
+#endif
+}
+
+int derlBaseTaskProcessor::pOpenFileDescriptor(const std::string &path, int flags){
+#ifdef OS_UNIX
+	// files of the last listed directory are opened relative to the directory
+	if(pDirectoryFd != -1){
+		const std::string::size_type length = pDirectoryFdPath.size();
+		if(length == 0){
+			if(path.find('/') == std::string::npos){
+				return openat(pDirectoryFd, path.c_str(), flags, 0644);
+			}
+			
+		}else if(path.size() > length + 1 && path[length] == '/'
+		&& path.compare(0, length, pDirectoryFdPath) == 0
+		&& path.find('/', length + 1) == std::string::npos){
+			return openat(pDirectoryFd, path.c_str() + length + 1, flags, 0644);
+		}
+	}
+	
+	if(pBaseDirFd != -1){
+		return openat(pBaseDirFd, path.c_str(), flags, 0644);
+	}
+	
+	return open(pFilePath.c_str(), flags, 0644);
+	
+#else
+	(void)path;
+	(void)flags;
+	return -1;
+#endif
+}
+
+void derlBaseTaskProcessor::pOpenBaseDirFd(){
+#ifdef OS_UNIX
+	// failing is fine. paths are then resolved from the base directory
+	pBaseDirFd = open(pBaseDir.empty() ? "." : pBaseDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#endif
+}
+
+void derlBaseTaskProcessor::pCloseLayoutFds(){
+#ifdef OS_UNIX
+	if(pDirectoryFd != -1){
+		close(pDirectoryFd);
+	}
+	if(pBaseDirFd != -1){
+		close(pBaseDirFd);
+	}
+#endif
+	pDirectoryFd = -1;
+	pDirectoryFdPath.clear();
+	pBaseDirFd = -1;
+}
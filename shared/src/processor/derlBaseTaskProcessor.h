@@ -29,9 +29,15 @@
 #include <fstream>
 #include <filesystem>
 #include <atomic>
+#include <functional>
 
+#include "../derlBlockSizePolicy.h"
 #include "../derlFile.h"
 #include "../derlFileLayout.h"
+#include "../derlHasher.h"
+#include "../derlHashCache.h"
+#include "../derlIoUring.h"
+#include "../derlWorkerPool.h"
 
 #include <denetwork/denLogger.h>
 
@@ -45,11 +51,26 @@ public:
 		std::string path;
 		uint64_t fileSize;
 		bool isDirectory;
+		
+		/** \brief Modification time in nanoseconds or 0 if unknown. */
+		int64_t modificationTime;
+		
+		/** \brief Inode or 0 if not supported. */
+		uint64_t inode;
 	};
 	
 	/** \brief List directory entries. */
 	typedef std::vector<DirectoryEntry> ListDirEntries;
 	
+	/** \brief I/O engine used by the default file access implementation. */
+	enum class IoEngine{
+		/** \brief Standard library file streams. */
+		stream,
+		
+		/** \brief Linux io_uring. Falls back to stream if not supported. */
+		ioUring
+	};
+	
 	
 protected:
 	std::atomic<bool> pExit;
@@ -59,7 +80,32 @@ protected:
 	// is buggy causing strange bugs if the same fstream instance is correctly reused
 	std::unique_ptr<std::fstream> pFileStream;
 	
+	bool pEnableMemoryMap;
+	bool pFileMapped;
+	const uint8_t *pFileMapping;
+	uint64_t pFileMappingSize;
+	
+	IoEngine pIoEngine;
+	derlIoUring::Ref pIoUring;
+	int pIoQueueDepth;
+	uint64_t pIoReadSize;
+	int pFileDescriptor;
+	int64_t pFileKnownSize;
+	
+	int pBaseDirFd;
+	int pDirectoryFd;
+	std::string pDirectoryFdPath;
+	const DirectoryEntry *pLayoutEntry;
+	
 	uint64_t pFileHashReadSize;
+	derlBlockSizePolicy::Ref pBlockSizePolicy;
+	derlHasher::Algorithm pHashAlgorithm;
+	bool pHashTree;
+	int pHashThreadCount;
+	derlWorkerPool::Ref pHashWorkerPool;
+	int pLayoutThreadCount;
+	derlWorkerPool::Ref pLayoutWorkerPool;
+	derlHashCache::Ref pHashCache;
 	std::string pLogClassName;
 	denLogger::Ref pLogger;
 	bool pEnableDebugLog;
@@ -72,7 +118,7 @@ public:
 	derlBaseTaskProcessor();
 	
 	/** \brief Clean up base task processor. */
-	virtual ~derlBaseTaskProcessor() noexcept = default;
+	virtual ~derlBaseTaskProcessor() noexcept;
 	/*@}*/
 	
 	
@@ -99,27 +145,158 @@ public:
 	
 	
 	
+	/** \brief Policy selecting block size of files while calculating file layout. */
+	inline const derlBlockSizePolicy::Ref &GetBlockSizePolicy() const{ return pBlockSizePolicy; }
+	
+	/**
+	 * \brief Set policy selecting block size of files while calculating file layout.
+	 * 
+	 * If nullptr is set a default policy is used.
+	 */
+	void SetBlockSizePolicy(const derlBlockSizePolicy::Ref &policy);
+	
+	/** \brief Hash algorithm used for file and block hashes. */
+	inline derlHasher::Algorithm GetHashAlgorithm() const{ return pHashAlgorithm; }
+	
+	/** \brief Set hash algorithm used for file and block hashes. */
+	void SetHashAlgorithm(derlHasher::Algorithm algorithm);
+	
+	/** \brief File hash of files with multiple blocks is calculated from block hashes. */
+	inline bool GetHashTree() const{ return pHashTree; }
+	
+	/** \brief Set if file hash of files with multiple blocks is calculated from block hashes. */
+	void SetHashTree(bool hashTree);
+	
+	/** \brief Count of threads used to hash blocks of large files. */
+	inline int GetHashThreadCount() const{ return pHashThreadCount; }
+	
+	/**
+	 * \brief Set count of threads used to hash blocks of large files.
+	 * 
+	 * Defaults to the number of hardware threads. Use 1 to hash on the task processor thread.
+	 */
+	void SetHashThreadCount(int count);
+	
+	/** \brief Count of threads used to calculate file layout. */
+	inline int GetLayoutThreadCount() const{ return pLayoutThreadCount; }
+	
+	/**
+	 * \brief Set count of threads used to calculate file layout.
+	 * 
+	 * With more than one thread listing directories and hashing files run as jobs on a
+	 * worker pool. Each job uses a processor created by CreateLayoutWorker() for file
+	 * access. Files larger than the layout block size are hashed after all other jobs
+	 * finished using the hash worker pool. Defaults to 1 which calculates the file layout
+	 * on the task processor thread.
+	 */
+	void SetLayoutThreadCount(int count);
+	
+	/** \brief Files opened for reading are memory mapped if supported. */
+	inline bool GetEnableMemoryMap() const{ return pEnableMemoryMap; }
+	
+	/**
+	 * \brief Set if files opened for reading are memory mapped if supported.
+	 * 
+	 * Hashing and reading blocks then works directly on the mapped pages instead of copying
+	 * data through a file stream. Supported on unix systems. Disabled by default.
+	 * 
+	 * \warning Mapped reads are not guarded. Truncating a file while its mapping is read
+	 *          raises SIGBUS crashing the process. Files shrunk before being mapped fail
+	 *          like reading them using streams but no check can catch truncation after
+	 *          mapping. Enable only if files are not truncated while synchronizing.
+	 */
+	void SetEnableMemoryMap(bool enable);
+	
+	/** \brief I/O engine. */
+	inline IoEngine GetIoEngine() const{ return pIoEngine; }
+	
+	/**
+	 * \brief Set I/O engine.
+	 * 
+	 * With io_uring files are read and written using a per processor io_uring instance.
+	 * Hashing keeps up to the queue depth reads in flight while hashing data already read.
+	 * If io_uring is not supported by the platform or kernel the stream engine is used.
+	 * Memory mapping takes precedence for reading if enabled. Defaults to stream.
+	 * Takes effect the next time a file is opened.
+	 */
+	void SetIoEngine(IoEngine engine);
+	
+	/** \brief Count of reads in flight while hashing using io_uring. */
+	inline int GetIoQueueDepth() const{ return pIoQueueDepth; }
+	
+	/** \brief Set count of reads in flight while hashing using io_uring. */
+	void SetIoQueueDepth(int depth);
+	
+	/** \brief Hash cache or nullptr. */
+	inline const derlHashCache::Ref &GetHashCache() const{ return pHashCache; }
+	
+	/** \brief Set hash cache or nullptr. */
+	void SetHashCache(const derlHashCache::Ref &cache);
+	
 	/**
 	 * \brief Calculate file layout.
+	 * 
+	 * File hash and block hashes using layout block size are calculated in one pass.
+	 * If a hash cache is set the digests of files with unchanged size, modification time
+	 * and inode are taken from the cache. The cache file is excluded from the layout.
 	 */
 	void CalcFileLayout(derlFileLayout &layout, const std::string &pathDir);
 	
+	/**
+	 * \brief File has been added to file layout by CalcFileLayout().
+	 * 
+	 * Called from layout worker threads if layout thread count is larger than 1.
+	 * Default implementation does nothing.
+	 */
+	virtual void OnLayoutFileAdded(const derlFile::Ref &file);
+	
+	/** \brief Create file with size and hashes for directory entry using hash cache if set. */
+	derlFile::Ref CalcLayoutFile(const DirectoryEntry &entry);
+	
+	/** \brief Path refers to the hash cache file. */
+	bool IsHashCacheFile(const std::string &path) const;
+	
+	/**
+	 * \brief Drop hash cache entries of files not in layout and save hash cache.
+	 * 
+	 * Call after calculating the file layout of the entire base directory. Failing
+	 * to save the hash cache is logged but not treated as an error.
+	 */
+	void SaveHashCache(const derlFileLayout &layout);
+	
+	/**
+	 * \brief Update file hashes from hash cache.
+	 * \returns true if hash cache has a matching entry.
+	 */
+	bool LoadCachedFileHashes(derlFile &file, const DirectoryEntry &entry, uint64_t blockSize);
+	
+	/** \brief Store file hashes in hash cache. */
+	void StoreCachedFileHashes(const derlFile &file, const DirectoryEntry &entry);
+	
 	/**
 	 * \brief Path exists and refers to an existing directory.
 	 * 
-	 * Default implementation uses std::filesystem::is_directory.
+	 * Default implementation uses std::filesystem::is_directory. On unix systems fstatat()
+	 * relative to the base directory file descriptor is used while calculating a file layout.
 	 */
 	virtual bool IsPathDirectory(const std::string &pathDir);
 	
 	/**
 	 * \brief List all files in directory.
 	 * 
-	 * Default implementation uses std::filesystem::directory_iterator.
+	 * Default implementation uses std::filesystem::directory_iterator. On unix systems the
+	 * directory is opened relative to the base directory file descriptor and read using
+	 * getdents64(). Entries are stat-ed using fstatat() relative to the directory file
+	 * descriptor unless the entry type tells them to be a directory. The directory file
+	 * descriptor is kept open so hashing the listed files can open them using openat().
 	 */
 	virtual void ListDirectoryFiles(ListDirEntries &entries, const std::string &pathDir);
 	
 	/**
 	 * \brief Calculate file hash.
+	 * 
+	 * If hash tree is enabled and the file is larger than the tree hash leaf size
+	 * CalcFileHashes() is used with the file block size.
 	 */
 	void CalcFileHash(derlFile &file);
 	
@@ -128,6 +305,87 @@ public:
 	 */
 	void CalcFileBlockHashes(derlFileBlock::List &blocks, const std::string &path, uint64_t blockSize);
 	
+	/**
+	 * \brief Calculate file hash and file block hashes reading file only once.
+	 * 
+	 * Updates file size, hash, block size and blocks. Files not larger than block size
+	 * use a single block with the file hash. If hash thread count is larger than 1 the
+	 * blocks are hashed in parallel. If hash tree is enabled the file hash is calculated
+	 * from the leaf hashes. Leaves are hashed together with the blocks if the block size
+	 * is a multiple of the leaf size. Otherwise a second pass is used.
+	 */
+	void CalcFileHashes(derlFile &file, uint64_t blockSize);
+	
+	/**
+	 * \brief Calculate weak rolling checksums of file blocks.
+	 * 
+	 * File blocks have to be present. Sets file has weak hashes. See derlRollingChecksum.
+	 */
+	void CalcFileWeakHashes(derlFile &file);
+	
+	/**
+	 * \brief Calculate file size and content defined chunks of file.
+	 * 
+	 * Replaces file blocks with the chunks using average chunk size as block size.
+	 * File hash is not changed. See derlFastCdc.
+	 */
+	void CalcFileChunks(derlFile &file, uint32_t averageSize);
+	
+	/**
+	 * \brief Read blocks of open file and hash them using the hash worker pool.
+	 * 
+	 * Adds data to hasherFile if hash tree is disabled. If leaves is not nullptr the
+	 * tree hash leaves are hashed too. Block size has to be a multiple of the leaf size.
+	 */
+	void CalcBlockHashesParallel(derlFileBlock::List &blocks, derlHasher &hasherFile,
+		std::vector<derlDigest> *leaves, uint64_t fileSize, uint64_t blockSize);
+	
+	/**
+	 * \brief Hash block data storing block hash and tree hash leaves if not nullptr.
+	 * 
+	 * Thread safe. Block offset has to be a multiple of the leaf size.
+	 */
+	static void HashBlockData(derlHasher::Algorithm algorithm, derlFileBlock &block,
+		const void *data, std::vector<derlDigest> *leaves);
+	
+	/**
+	 * \brief Add data of open file to hashers.
+	 * 
+	 * Uses GetFileData() if possible otherwise reads data into buffer in chunks.
+	 * 
+	 * \param[in] hasherFile Second hasher to add data to or nullptr.
+	 */
+	void HashFileData(derlHasher &hasher, derlHasher *hasherFile, uint64_t offset,
+		uint64_t size, std::string &buffer);
+	
+	/**
+	 * \brief Hash tree hash leaves of range of open file.
+	 * 
+	 * Range offset has to be a multiple of the leaf size.
+	 * 
+	 * \param[in] hasherFile Second hasher to add data to or nullptr.
+	 */
+	void HashFileLeaves(std::vector<derlDigest> &leaves, derlHasher *hasherFile,
+		uint64_t offset, uint64_t size, std::string &buffer);
+	
+	/** \brief Tree hash calculated from leaf hashes. */
+	derlDigest CalcTreeHash(const std::vector<derlDigest> &leaves) const;
+	
+	/** \brief Hash worker pool matching hash thread count. Created if required. */
+	derlWorkerPool &GetHashWorkerPool();
+	
+	/** \brief Layout worker pool matching layout thread count. Created if required. */
+	derlWorkerPool &GetLayoutWorkerPool();
+	
+	/**
+	 * \brief Create processor used by layout jobs for file access.
+	 * 
+	 * Settings relevant for calculating file layouts are copied to the created processor.
+	 * Default implementation creates a processor using the default file access functions.
+	 * Subclasses overriding file access functions have to override this too.
+	 */
+	virtual std::unique_ptr<derlBaseTaskProcessor> CreateLayoutWorker();
+	
 	/**
 	 * \brief Truncate file.
 	 * 
@@ -135,33 +393,69 @@ public:
 	 */
 	virtual void TruncateFile(const std::string &path);
 	
+	/**
+	 * \brief Resize file keeping existing content up to the new size.
+	 * 
+	 * Default implementation resizes file using standard library functionality.
+	 */
+	virtual void ResizeFile(const std::string &path, uint64_t size);
+	
+	/**
+	 * \brief Allocate disk space for file growing it to size if smaller.
+	 * 
+	 * Creates the file if absent. Allocating the final size up front avoids fragmenting
+	 * files written block by block. Default implementation uses fallocate if supported
+	 * otherwise resizes file using standard library functionality.
+	 */
+	virtual void PreallocateFile(const std::string &path, uint64_t size);
+	
+	/**
+	 * \brief Set range of file to zero bytes.
+	 * 
+	 * Default implementation punches a hole into the file using fallocate if supported
+	 * leaving the range sparse. Otherwise zero bytes are written.
+	 */
+	virtual void ZeroFileRange(const std::string &path, uint64_t offset, uint64_t size);
+	
 	/**
 	 * \brief Open file for reading or writing.
 	 * 
 	 * Default implementation opens an std::filestream for reading/writing binary data.
 	 * If parent directories do not exist they are created first.
-	 * If file is open CloseFile() is called first.
+	 * If file is open CloseFile() is called first. If memory mapping is enabled files opened
+	 * for reading are memory mapped if possible. Otherwise the I/O engine is used.
 	 */
 	virtual void OpenFile(const std::string &path, bool write);
 	
 	/**
 	 * \brief Get size of open file.
 	 * 
-	 * Default implementation gets file size from std::filestream using seek/tell.
+	 * Default implementation gets file size from std::filestream using seek/tell or uses
+	 * the size of the memory mapping. While hashing files of a file layout the size
+	 * of the directory entry is used.
 	 */
 	virtual uint64_t GetFileSize();
 	
 	/**
 	 * \brief Read data from open file.
 	 * 
-	 * Default implementation reads from open std::filestream.
+	 * Default implementation reads from open std::filestream or copies memory mapped data.
 	 */
 	virtual void ReadFile(void *data, uint64_t offset, uint64_t size);
 	
+	/**
+	 * \brief Pointer to data of open file or nullptr if not available.
+	 * 
+	 * Allows hashing and reading without copying data. Pointer stays valid until the file
+	 * is closed. Default implementation returns memory mapped data if the file is mapped.
+	 */
+	virtual const void *GetFileData(uint64_t offset, uint64_t size);
+	
 	/**
 	 * \brief Close open file.
 	 * 
-	 * Default implementation closes open std::filestream. Has no effect if file is not open.
+	 * Default implementation closes open std::filestream or memory mapping. Has no effect
+	 * if file is not open.
 	 */
 	virtual void CloseFile();
 	
@@ -189,6 +483,35 @@ public:
 	
 	/** \brief Debug log message only printed if debugging is enabled. */
 	void LogDebug(const std::string &functionName, const std::string &message);
+	
+	
+	
+protected:
+	/** \brief Read from file opened using io_uring. */
+	void IoUringRead(void *data, uint64_t offset, uint64_t size);
+	
+	/** \brief Write to file opened using io_uring. */
+	void IoUringWrite(const void *data, uint64_t offset, uint64_t size);
+	
+	/**
+	 * \brief Read range of file opened using io_uring in chunks keeping multiple reads in flight.
+	 * 
+	 * Consumer is called with the chunks in file order. Consumers can keep the chunk data.
+	 */
+	void IoUringReadAhead(uint64_t offset, uint64_t size, uint64_t chunkSize,
+		const std::function<void(const std::shared_ptr<std::string>&)> &consumer);
+	
+	
+	
+private:
+	void pCalcFileLayoutSerial(derlFileLayout &layout, const std::string &pathDir);
+	void pCalcFileLayoutParallel(derlFileLayout &layout, const std::string &pathDir);
+	void pInitLayoutWorker(derlBaseTaskProcessor &worker) const;
+	bool pMapFile(const std::string &path);
+	bool pOpenFileIoUring(const std::string &path, bool write);
+	int pOpenFileDescriptor(const std::string &path, int flags);
+	void pOpenBaseDirFd();
+	void pCloseLayoutFds();
 };
 
 #endif
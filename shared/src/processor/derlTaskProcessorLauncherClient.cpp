@@ -22,6 +22,8 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <mutex>
 
@@ -30,6 +32,8 @@
 #include "../derlFile.h"
 #include "../derlFileBlock.h"
 #include "../derlFileLayout.h"
+#include "../derlProtocol.h"
+#include "../derlLz4.h"
 #include "../internal/derlLauncherClientConnection.h"
 
 
@@ -37,7 +41,8 @@
 //////////////////////////////////////////
 
 derlTaskProcessorLauncherClient::derlTaskProcessorLauncherClient(derlLauncherClient &client) :
-pClient(client)
+pClient(client),
+pSendLayoutPages(false)
 {
 	pLogClassName = "derlTaskProcessorLauncherClient";
 }
@@ -55,6 +60,12 @@ void derlTaskProcessorLauncherClient::RunTask(){
 	const std::lock_guard guard(pClient.GetMutex());
 	pBaseDir = pClient.GetPathDataDir();
 	pEnableDebugLog = pClient.GetEnableDebugLog();
+	pHashAlgorithm = pClient.GetConnection().GetHashAlgorithm();
+	pHashTree = (pClient.GetConnection().GetEnabledFeatures()
+		& (uint32_t)derlProtocol::Features::treeHash) != 0;
+	pHashCache = pClient.GetHashCache();
+	pBlockSizePolicy = pClient.GetBlockSizePolicy();
+	pWriteJournal = pClient.GetWriteJournal();
 	}
 	
 	switch(task->GetType()){
@@ -84,6 +95,14 @@ void derlTaskProcessorLauncherClient::RunTask(){
 		ProcessWriteFileBlock(*std::static_pointer_cast<derlTaskFileWriteBlock>(task));
 		break;
 		
+	case derlBaseTask::Type::fileLayoutUpdate:
+		ProcessFileLayoutUpdate(*std::static_pointer_cast<derlTaskFileLayoutUpdate>(task));
+		break;
+		
+	case derlBaseTask::Type::fileBundle:
+		ProcessFileBundle(*std::static_pointer_cast<derlTaskFileBundle>(task));
+		break;
+		
 	default:
 		break;
 	}
@@ -118,6 +137,8 @@ bool derlTaskProcessorLauncherClient::NextPendingTask(derlBaseTask::Ref &task){
 		case derlBaseTask::Type::fileBlockHashes:
 		case derlBaseTask::Type::fileDelete:
 		case derlBaseTask::Type::fileWriteBlock:
+		case derlBaseTask::Type::fileLayoutUpdate:
+		case derlBaseTask::Type::fileBundle:
 			found = layout != nullptr;
 			break;
 			
@@ -166,59 +187,107 @@ void derlTaskProcessorLauncherClient::ProcessFileBlockHashes(derlTaskFileBlockHa
 			throw std::runtime_error("Layout missing, internal error");
 		}
 		
-		derlFileBlock::List blocks;
-		CalcFileBlockHashes(blocks, path, blockSize);
+		derlFile::Ref file(std::make_shared<derlFile>(path));
+		
+		if(task.GetContentChunks()){
+			CalcFileChunks(*file, (uint32_t)blockSize);
+			task.SetStatus(derlTaskFileBlockHashes::Status::success);
+			pClient.GetConnection().SendResponseFileBlockHashes(*file, false);
+			return;
+		}
+		
+		// reuse blocks of the layout file only missing weak hashes. blocks are copied
+		// since they are shared with the layout file
+		const derlFile::Ref layoutFile(layout->GetFileAtSync(path));
+		if(layoutFile && layoutFile->GetHasBlocks() && layoutFile->GetBlockCount() > 0
+		&& layoutFile->GetBlockSize() == blockSize && !layoutFile->GetContentChunks()){
+			file = std::make_shared<derlFile>(*layoutFile);
+			derlFileBlock::List blocks;
+			derlFileBlock::List::const_iterator iterBlock;
+			for(iterBlock=layoutFile->GetBlocksBegin(); iterBlock!=layoutFile->GetBlocksEnd(); iterBlock++){
+				blocks.push_back(std::make_shared<derlFileBlock>(**iterBlock));
+			}
+			file->SetBlocks(blocks);
+			
+		}else{
+			CalcFileHashes(*file, blockSize);
+		}
+		
+		if(task.GetWeakHashes()){
+			CalcFileWeakHashes(*file);
+		}
 		
-		derlFile::Ref file;
 		{
 		const std::lock_guard guard(layout->GetMutex());
-		file = layout->GetFileAt(path);
-		if(!file){
+		if(!layout->GetFileAt(path)){
 			throw std::runtime_error("File not found in layout");
 		}
-		
-		file = std::make_shared<derlFile>(*file);
-		file->SetBlockSize((uint32_t)blockSize);
-		file->SetBlocks(blocks);
 		layout->SetFileAt(path, file);
 		}
 		
 		task.SetStatus(derlTaskFileBlockHashes::Status::success);
-		pClient.GetConnection().SendResponseFileBlockHashes(*file);
+		pClient.GetConnection().SendResponseFileBlockHashes(*file, task.GetWeakHashes());
 		
 	}catch(const std::exception &e){
 		std::stringstream ss;
 		ss << "Failed size " << blockSize << " for " << path;
 		LogException("ProcessFileBlockHashes", e, ss.str());
 		task.SetStatus(derlTaskFileBlockHashes::Status::failure);
-		pClient.GetConnection().SendResponseFileBlockHashes(path);
+		pClient.GetConnection().SendResponseFileBlockHashes(path, (uint32_t)blockSize);
 		
 	}catch(...){
 		std::stringstream ss;
 		ss << "Failed size " << blockSize << " for " << path;
 		Log(denLogger::LogSeverity::error, "ProcessFileBlockHashes", ss.str());
 		task.SetStatus(derlTaskFileBlockHashes::Status::failure);
-		pClient.GetConnection().SendResponseFileBlockHashes(path);
+		pClient.GetConnection().SendResponseFileBlockHashes(path, (uint32_t)blockSize);
 	}
 }
 
 void derlTaskProcessorLauncherClient::ProcessFileLayout(derlTaskFileLayout &task){
 	LogDebug("ProcessFileLayout", "Build file layout");
 	
+	derlLauncherClientConnection &connection = pClient.GetConnection();
+	pSendLayoutPages = connection.BeginLayoutPages();
+	pLayoutPage.clear();
+	
 	try{
 		const derlFileLayout::Ref layout(std::make_shared<derlFileLayout>());
 		CalcFileLayout(*layout, "");
+		layout->StartTrackChanges();
+		SaveHashCache(*layout);
+		
+		if(pSendLayoutPages){
+			if(!pLayoutPage.empty()){
+				connection.SendResponseFileLayoutPage(pLayoutPage);
+				pLayoutPage.clear();
+			}
+			pSendLayoutPages = false;
+			connection.EndLayoutPages(true, layout->GetFileCount(),
+				layout->GetIdentifier(), layout->GetGeneration());
+		}
+		
 		task.SetLayout(layout);
 		task.SetStatus(derlTaskFileLayout::Status::success);
 		pClient.SetFileLayoutSync(layout);
 		
 	}catch(const std::exception &e){
 		LogException("ProcessFileLayout", e, "Failed");
+		if(pSendLayoutPages){
+			pSendLayoutPages = false;
+			pLayoutPage.clear();
+			connection.EndLayoutPages(false, 0, 0, 0);
+		}
 		task.SetStatus(derlTaskFileLayout::Status::failure);
 		pClient.SetFileLayoutSync(nullptr);
 		
 	}catch(...){
 		Log(denLogger::LogSeverity::error, "ProcessFileLayout", "Failed");
+		if(pSendLayoutPages){
+			pSendLayoutPages = false;
+			pLayoutPage.clear();
+			connection.EndLayoutPages(false, 0, 0, 0);
+		}
 		task.SetStatus(derlTaskFileLayout::Status::failure);
 		pClient.SetFileLayoutSync(nullptr);
 	}
@@ -244,6 +313,11 @@ void derlTaskProcessorLauncherClient::ProcessDeleteFile(derlTaskFileDelete &task
 		task.SetStatus(derlTaskFileDelete::Status::success);
 		layout->RemoveFileIfPresentSync(path);
 		
+		if(pWriteJournal){
+			pWriteJournal->Remove(path);
+			SaveWriteJournal(false);
+		}
+		
 	}catch(const std::exception &e){
 		std::stringstream ss;
 		ss << "Failed " << task.GetPath();
@@ -276,8 +350,37 @@ void derlTaskProcessorLauncherClient::ProcessWriteFile(derlTaskFileWrite &task){
 	}
 	
 	try{
-		if(task.GetTruncate()){
-			TruncateFile(task.GetPath());
+		task.SetJournaled(pWriteJournal && !task.GetDelta() && task.GetBlockCount() > 1
+			&& (pClient.GetConnection().GetEnabledFeatures()
+				& (uint32_t)derlProtocol::Features::resumeWrite) != 0);
+		
+		if(task.GetDelta()){
+			// delta is reconstructed into a new file replacing the existing file when finished
+			TruncateFile(task.GetDeltaPath());
+			PreallocateFile(task.GetDeltaPath(), task.GetFileSize());
+			
+		}else if(task.GetJournaled() && ResumeWriteFile(task)){
+			// keep blocks written by the interrupted write
+			
+		}else{
+			if(task.GetTruncate()){
+				if((pClient.GetConnection().GetEnabledFeatures()
+				& (uint32_t)derlProtocol::Features::partialResize) != 0){
+					// server writes only changed blocks. keep the content of the other blocks
+					ResizeFile(task.GetPath(), task.GetFileSize());
+					
+				}else{
+					TruncateFile(task.GetPath());
+				}
+			}
+			
+			// blocks arrive in any order. allocating the final size avoids fragmentation.
+			// interrupted journaled writes keep the final size too
+			PreallocateFile(task.GetPath(), task.GetFileSize());
+			
+			if(task.GetJournaled()){
+				BeginWriteJournal(task);
+			}
 		}
 		task.SetStatus(derlTaskFileWrite::Status::processing);
 		
@@ -313,9 +416,46 @@ void derlTaskProcessorLauncherClient::ProcessWriteFileBlock(derlTaskFileWriteBlo
 	}
 	
 	try{
-		OpenFile(path, true);
-		WriteFile(task.GetData().c_str(), blockSize * task.GetIndex(), task.GetSize());
+		if(task.GetCompressed()){
+			DecompressBlockData(task);
+		}
+		
+		if(task.GetZero()){
+			ZeroFileRange(path, blockSize * task.GetIndex(), task.GetSize());
+			
+		}else if(task.GetParentTask().GetDelta()){
+			std::string data;
+			data.assign(task.GetSize(), 0);
+			uint64_t dataOffset = 0;
+			
+			for(const derlTaskFileWriteBlock::Instruction &instruction : task.GetInstructions()){
+				switch(instruction.type){
+				case derlTaskFileWriteBlock::InstructionType::copy:
+					OpenFile(path, false);
+					ReadFile((void*)(data.c_str() + dataOffset), instruction.offset, instruction.size);
+					break;
+					
+				case derlTaskFileWriteBlock::InstructionType::literal:
+					memcpy((void*)(data.c_str() + dataOffset),
+						task.GetData().c_str() + instruction.offset, instruction.size);
+					break;
+				}
+				dataOffset += instruction.size;
+			}
+			
+			OpenFile(task.GetParentTask().GetDeltaPath(), true);
+			WriteFile(data.c_str(), blockSize * task.GetIndex(), task.GetSize());
+			
+		}else{
+			OpenFile(path, true);
+			WriteFile(task.GetData().c_str(), blockSize * task.GetIndex(), task.GetSize());
+		}
 		CloseFile();
+		
+		if(task.GetParentTask().GetJournaled() && pWriteJournal){
+			pWriteJournal->SetBlockWritten(path, task.GetIndex(), pBaseDir / path);
+			SaveWriteJournal(true);
+		}
 		task.SetStatus(derlTaskFileWriteBlock::Status::success);
 		
 	}catch(const std::exception &e){
@@ -341,48 +481,109 @@ void derlTaskProcessorLauncherClient::ProcessWriteFileBlock(derlTaskFileWriteBlo
 }
 
 void derlTaskProcessorLauncherClient::ProcessFinishWriteFile(derlTaskFileWrite &task){
-	try{
-		const derlFile::Ref file(std::make_shared<derlFile>(task.GetPath()));
-		file->SetSize(task.GetFileSize());
-		file->SetBlockSize((uint32_t)task.GetBlockSize());
-		CalcFileHash(*file);
-		CloseFile();
+	FinishWriteFile(task);
+	pClient.GetConnection().SendResponseFinishWriteFile(task);
+}
+
+void derlTaskProcessorLauncherClient::ProcessFileBundle(derlTaskFileBundle &task){
+	if(pEnableDebugLog){
+		std::stringstream ss;
+		ss << "Write file bundle with " << task.GetFiles().size() << " file(s)";
+		LogDebug("ProcessFileBundle", ss.str());
+	}
+	
+	for(const derlTaskFileWrite::Ref &file : task.GetFiles()){
+		if(file->GetStatus() != derlTaskFileWrite::Status::pending){
+			continue;
+		}
 		
-		if(file->GetHash() == task.GetHash()){
-			task.SetStatus(derlTaskFileWrite::Status::success);
+		try{
+			TruncateFile(file->GetPath());
 			
-			const derlFileLayout::Ref layout(pClient.GetFileLayout());
-			if(!layout){
-				throw std::runtime_error("Layout missing, internal error");
+			if(!file->GetBlocks().empty()){
+				derlTaskFileWriteBlock &block = *file->GetBlocks().front();
+				if(block.GetCompressed()){
+					DecompressBlockData(block);
+				}
+				
+				OpenFile(file->GetPath(), true);
+				WriteFile(block.GetData().c_str(), 0, block.GetSize());
 			}
-			layout->AddFileSync(file);
+			CloseFile();
 			
-		}else{
+		}catch(const std::exception &e){
 			std::stringstream ss;
-			ss << "Finish write failed (hash mismatch) " << task.GetPath();
-			Log(denLogger::LogSeverity::error, "ProcessFinishWriteFile", ss.str());
-			task.SetStatus(derlTaskFileWrite::Status::validationFailed);
+			ss << "Failed " << file->GetPath();
+			LogException("ProcessFileBundle", e, ss.str());
+			CloseFile();
+			file->SetStatus(derlTaskFileWrite::Status::failure);
 			pClient.SetDirtyFileLayoutSync(true);
+			pClient.EndWriteFileSync(file->GetPath());
+			continue;
+			
+		}catch(...){
+			std::stringstream ss;
+			ss << "Failed " << file->GetPath();
+			Log(denLogger::LogSeverity::error, "ProcessFileBundle", ss.str());
+			CloseFile();
+			file->SetStatus(derlTaskFileWrite::Status::failure);
+			pClient.SetDirtyFileLayoutSync(true);
+			pClient.EndWriteFileSync(file->GetPath());
+			continue;
 		}
 		
-	}catch(const std::exception &e){
+		FinishWriteFile(*file);
+	}
+	
+	pClient.GetConnection().SendResponseFileBundle(task);
+}
+
+void derlTaskProcessorLauncherClient::ProcessFileLayoutUpdate(derlTaskFileLayoutUpdate &task){
+	if(pEnableDebugLog){
 		std::stringstream ss;
-		ss << "Finish write failed " << task.GetPath();
-		LogException("ProcessFinishWriteFile", e, ss.str());
-		CloseFile();
-		task.SetStatus(derlTaskFileWrite::Status::failure);
+		ss << "Update file layout for " << task.GetPaths().size() << " changed path(s)";
+		LogDebug("ProcessFileLayoutUpdate", ss.str());
+	}
+	
+	const derlFileLayout::Ref layout(pClient.GetFileLayout());
+	
+	try{
+		if(!layout){
+			throw std::runtime_error("Layout missing, internal error");
+		}
+		
+		for(const std::string &path : task.GetPaths()){
+			if(pExit){
+				break;
+			}
+			UpdateFileLayoutPath(*layout, path);
+		}
+		
+		task.SetStatus(derlTaskFileLayoutUpdate::Status::success);
+		
+	}catch(const std::exception &e){
+		LogException("ProcessFileLayoutUpdate", e, "Failed");
+		task.SetStatus(derlTaskFileLayoutUpdate::Status::failure);
 		pClient.SetDirtyFileLayoutSync(true);
 		
 	}catch(...){
-		std::stringstream ss;
-		ss << "Finish write failed " << task.GetPath();
-		Log(denLogger::LogSeverity::error, "ProcessFinishWriteFile", ss.str());
-		CloseFile();
-		task.SetStatus(derlTaskFileWrite::Status::failure);
+		Log(denLogger::LogSeverity::error, "ProcessFileLayoutUpdate", "Failed");
+		task.SetStatus(derlTaskFileLayoutUpdate::Status::failure);
 		pClient.SetDirtyFileLayoutSync(true);
 	}
+}
+
+void derlTaskProcessorLauncherClient::OnLayoutFileAdded(const derlFile::Ref &file){
+	if(!pSendLayoutPages){
+		return;
+	}
 	
-	pClient.GetConnection().SendResponseFinishWriteFile(task);
+	const std::lock_guard guard(pMutexLayoutPage);
+	pLayoutPage.push_back(file);
+	if((int)pLayoutPage.size() >= derlLauncherClientConnection::LayoutPageSize){
+		pClient.GetConnection().SendResponseFileLayoutPage(pLayoutPage);
+		pLayoutPage.clear();
+	}
 }
 
 void derlTaskProcessorLauncherClient::DeleteFile(const derlTaskFileDelete &task){
@@ -402,8 +603,27 @@ void derlTaskProcessorLauncherClient::DeleteFile(const derlTaskFileDelete &task)
 	}
 }
 
+void derlTaskProcessorLauncherClient::RenameFile(const std::string &pathFrom, const std::string &pathTo){
+	try{
+		std::filesystem::rename(pBaseDir / pathFrom, pBaseDir / pathTo);
+		
+	}catch(const std::exception &e){
+		LogException("RenameFile", e, pathFrom);
+		throw;
+		
+	}catch(...){
+		Log(denLogger::LogSeverity::error, "RenameFile", pathFrom);
+		throw;
+	}
+}
+
 void derlTaskProcessorLauncherClient::WriteFile(const void *data, uint64_t offset, uint64_t size){
 	try{
+		if(pFileDescriptor != -1){
+			IoUringWrite(data, offset, size);
+			return;
+		}
+		
 		pFileStream->seekp(offset, std::ios_base::beg);
 		if(pFileStream->fail()){
 			pFileStream->clear();
@@ -425,3 +645,186 @@ void derlTaskProcessorLauncherClient::WriteFile(const void *data, uint64_t offse
 		throw;
 	}
 }
+
+void derlTaskProcessorLauncherClient::FinishWriteFile(derlTaskFileWrite &task){
+	if(task.GetJournaled() && pWriteJournal){
+		pWriteJournal->Remove(task.GetPath());
+		SaveWriteJournal(false);
+	}
+	
+	try{
+		derlFile::Ref file(std::make_shared<derlFile>(
+			task.GetDelta() ? task.GetDeltaPath() : task.GetPath()));
+		file->SetSize(task.GetFileSize());
+		CalcFileHashes(*file, task.GetBlockSize());
+		CloseFile();
+		
+		if(file->GetHash() == task.GetHash()){
+			if(task.GetDelta()){
+				RenameFile(task.GetDeltaPath(), task.GetPath());
+				
+				const derlFile::Ref renamed(std::make_shared<derlFile>(task.GetPath()));
+				renamed->SetSize(file->GetSize());
+				renamed->SetHash(file->GetHash());
+				renamed->SetBlockSize(file->GetBlockSize());
+				derlFileBlock::List::const_iterator iterBlock;
+				for(iterBlock=file->GetBlocksBegin(); iterBlock!=file->GetBlocksEnd(); iterBlock++){
+					renamed->AddBlock(*iterBlock);
+				}
+				renamed->SetHasBlocks(true);
+				file = renamed;
+			}
+			
+			task.SetStatus(derlTaskFileWrite::Status::success);
+			
+			const derlFileLayout::Ref layout(pClient.GetFileLayout());
+			if(!layout){
+				throw std::runtime_error("Layout missing, internal error");
+			}
+			layout->AddFileSync(file);
+			
+		}else{
+			std::stringstream ss;
+			ss << "Finish write failed (hash mismatch) " << task.GetPath();
+			Log(denLogger::LogSeverity::error, "FinishWriteFile", ss.str());
+			if(task.GetDelta()){
+				DeleteFile(derlTaskFileDelete(task.GetDeltaPath()));
+			}
+			task.SetStatus(derlTaskFileWrite::Status::validationFailed);
+			pClient.SetDirtyFileLayoutSync(true);
+		}
+		
+	}catch(const std::exception &e){
+		std::stringstream ss;
+		ss << "Finish write failed " << task.GetPath();
+		LogException("FinishWriteFile", e, ss.str());
+		CloseFile();
+		task.SetStatus(derlTaskFileWrite::Status::failure);
+		pClient.SetDirtyFileLayoutSync(true);
+		
+	}catch(...){
+		std::stringstream ss;
+		ss << "Finish write failed " << task.GetPath();
+		Log(denLogger::LogSeverity::error, "FinishWriteFile", ss.str());
+		CloseFile();
+		task.SetStatus(derlTaskFileWrite::Status::failure);
+		pClient.SetDirtyFileLayoutSync(true);
+	}
+	
+	pClient.EndWriteFileSync(task.GetPath());
+}
+
+bool derlTaskProcessorLauncherClient::ResumeWriteFile(derlTaskFileWrite &task){
+	derlWriteJournal::Entry entry;
+	if(!pWriteJournal->Get(task.GetPath(), entry)){
+		return false;
+	}
+	
+	const std::filesystem::path path(pBaseDir / task.GetPath());
+	std::error_code error;
+	const uint64_t fileSize = (uint64_t)std::filesystem::file_size(path, error);
+	
+	if(error || fileSize != task.GetFileSize() || entry.fileSize != task.GetFileSize()
+	|| entry.blockSize != task.GetBlockSize() || entry.algorithm != pHashAlgorithm
+	|| entry.hash != task.GetHash() || (int)entry.blocks.size() != task.GetBlockCount()
+	|| entry.modificationTime != derlWriteJournal::GetModificationTime(path)){
+		return false;
+	}
+	
+	task.SetResumeBlocks(entry.blocks);
+	
+	std::stringstream ss;
+	ss << "Resume write file " << task.GetPath() << ": "
+		<< std::count(entry.blocks.cbegin(), entry.blocks.cend(), true)
+		<< " of " << entry.blocks.size() << " block(s) present";
+	Log(denLogger::LogSeverity::info, "ResumeWriteFile", ss.str());
+	return true;
+}
+
+void derlTaskProcessorLauncherClient::BeginWriteJournal(derlTaskFileWrite &task){
+	derlWriteJournal::Entry entry;
+	entry.fileSize = task.GetFileSize();
+	entry.blockSize = task.GetBlockSize();
+	entry.algorithm = pHashAlgorithm;
+	entry.hash = task.GetHash();
+	entry.modificationTime = derlWriteJournal::GetModificationTime(pBaseDir / task.GetPath());
+	entry.blocks.assign(task.GetBlockCount(), false);
+	
+	pWriteJournal->Set(task.GetPath(), entry);
+	SaveWriteJournal(false);
+}
+
+void derlTaskProcessorLauncherClient::SaveWriteJournal(bool throttled){
+	try{
+		if(throttled){
+			pWriteJournal->SaveThrottled();
+			
+		}else{
+			pWriteJournal->Save();
+		}
+		
+	}catch(const std::exception &e){
+		LogException("SaveWriteJournal", e, pWriteJournal->GetPath().string());
+	}
+}
+
+void derlTaskProcessorLauncherClient::UpdateFileLayoutPath(derlFileLayout &layout, const std::string &path){
+	// files written by synchronization update the layout when finished
+	if(IsHashCacheFile(path) || derlTaskFileWrite::IsDeltaPath(path) || pClient.IsWritingFileSync(path)){
+		return;
+	}
+	
+	if(IsPathDirectory(path)){
+		derlFileLayout layoutDir;
+		CalcFileLayout(layoutDir, path);
+		
+		const std::lock_guard guard(layout.GetMutex());
+		layout.RemoveFileIfPresent(path);
+		layout.RemoveAllFilesIn(path);
+		
+		derlFile::Map::const_iterator iter;
+		for(iter=layoutDir.GetFilesBegin(); iter!=layoutDir.GetFilesEnd(); iter++){
+			layout.AddFile(iter->second);
+		}
+		return;
+	}
+	
+	layout.RemoveAllFilesInSync(path);
+	
+	if(!std::filesystem::is_regular_file(pBaseDir / path)){
+		layout.RemoveFileIfPresentSync(path);
+		return;
+	}
+	
+	const derlFile::Ref file(std::make_shared<derlFile>(path));
+	try{
+		CalcFileHashes(*file, pBlockSizePolicy->GetBlockSize(path,
+			std::filesystem::file_size(pBaseDir / path)));
+		
+	}catch(const std::exception &){
+		// file removed or replaced while hashing. the watcher reports the change
+		layout.RemoveFileIfPresentSync(path);
+		return;
+	}
+	
+	layout.AddFileSync(file);
+}
+
+void derlTaskProcessorLauncherClient::DecompressBlockData(derlTaskFileWriteBlock &task){
+	uint64_t size = task.GetSize();
+	if(task.GetParentTask().GetDelta()){
+		size = 0;
+		for(const derlTaskFileWriteBlock::Instruction &instruction : task.GetInstructions()){
+			if(instruction.type == derlTaskFileWriteBlock::InstructionType::literal){
+				size += instruction.size;
+			}
+		}
+	}
+	
+	std::string data;
+	data.assign(size, 0);
+	derlLz4::Decompress(task.GetData().c_str(), task.GetData().size(), (void*)data.c_str(), size);
+	
+	task.GetData().swap(data);
+	task.SetCompressed(false);
+}
@@ -30,7 +30,10 @@
 #include "../task/derlTaskFileDelete.h"
 #include "../task/derlTaskFileWrite.h"
 #include "../task/derlTaskFileWriteBlock.h"
+#include "../task/derlTaskFileBundle.h"
 #include "../task/derlTaskFileLayout.h"
+#include "../task/derlTaskFileLayoutUpdate.h"
+#include "../derlWriteJournal.h"
 
 class derlLauncherClient;
 
@@ -47,6 +50,11 @@ public:
 	
 protected:
 	derlLauncherClient &pClient;
+	derlWriteJournal::Ref pWriteJournal;
+	
+	bool pSendLayoutPages;
+	derlFile::List pLayoutPage;
+	std::mutex pMutexLayoutPage;
 	
 	
 public:
@@ -81,7 +89,12 @@ public:
 	
 	
 	
-	/** \brief Process task file layout. */
+	/**
+	 * \brief Process task file layout.
+	 * 
+	 * If a file layout request is waiting for the layout the files are send as pages
+	 * while building the file layout if supported by the connection.
+	 */
 	virtual void ProcessFileLayout(derlTaskFileLayout &task);
 	
 	/** \brief Process task file block hashes. */
@@ -99,6 +112,17 @@ public:
 	/** \brief Process task finish write file. */
 	virtual void ProcessFinishWriteFile(derlTaskFileWrite &task);
 	
+	/** \brief Process task file layout update. */
+	virtual void ProcessFileLayoutUpdate(derlTaskFileLayoutUpdate &task);
+	
+	/** \brief Process task file bundle writing and verifying all files. */
+	virtual void ProcessFileBundle(derlTaskFileBundle &task);
+	
+	
+	
+	/** \brief File has been added to file layout. Sends file layout page if full. */
+	void OnLayoutFileAdded(const derlFile::Ref &file) override;
+	
 	
 	
 	/**
@@ -108,12 +132,61 @@ public:
 	 */
 	virtual void DeleteFile(const derlTaskFileDelete &task);
 	
+	/**
+	 * \brief Rename file replacing existing file.
+	 * 
+	 * Default implementation renames file using standard library functionality.
+	 */
+	virtual void RenameFile(const std::string &pathFrom, const std::string &pathTo);
+	
 	/**
 	 * \brief Write data to open file.
 	 * 
-	 * Default implementation writes to open std::filestream.
+	 * Default implementation writes to open std::filestream or uses io_uring.
 	 */
 	virtual void WriteFile(const void *data, uint64_t offset, uint64_t size);
+	
+	/**
+	 * \brief Update file layout for changed path.
+	 * 
+	 * Files are hashed again or removed if absent. Directories are scanned again.
+	 */
+	void UpdateFileLayoutPath(derlFileLayout &layout, const std::string &path);
+	
+	/**
+	 * \brief Verify written file and add it to the file layout.
+	 * 
+	 * Sets task status to success, validationFailed or failure.
+	 */
+	void FinishWriteFile(derlTaskFileWrite &task);
+	
+	/**
+	 * \brief Resume interrupted write using the write journal.
+	 * 
+	 * Resumes if the journal entry matches the target hash, size and block size and the
+	 * file has not been modified since the last written block. Sets the blocks already
+	 * written in the task.
+	 * 
+	 * \returns true if resumed or false otherwise.
+	 */
+	bool ResumeWriteFile(derlTaskFileWrite &task);
+	
+	/** \brief Add write journal entry without written blocks replacing existing entry. */
+	void BeginWriteJournal(derlTaskFileWrite &task);
+	
+	/**
+	 * \brief Save write journal logging errors.
+	 * \param[in] throttled Save only if due. See derlWriteJournal::SaveThrottled().
+	 */
+	void SaveWriteJournal(bool throttled);
+	
+	/**
+	 * \brief Decompress block data.
+	 * 
+	 * Data decompresses to the block size or for delta writes to the size of all literal
+	 * instructions. Throws exception if data is malformed.
+	 */
+	void DecompressBlockData(derlTaskFileWriteBlock &task);
 };
 
 #endif
@@ -22,8 +22,12 @@
  * SOFTWARE.
  */
 
+#include <cstring>
 #include <stdexcept>
 #include <mutex>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "derlTaskProcessorRemoteClient.h"
 #include "../derlRemoteClient.h"
@@ -31,13 +35,37 @@
 #include "../derlFile.h"
 #include "../derlFileBlock.h"
 #include "../derlFileLayout.h"
+#include "../derlProtocol.h"
+#include "../derlHasher.h"
+#include "../derlRollingChecksum.h"
+#include "../derlBlockSizePolicy.h"
+#include "../derlLz4.h"
+
+
+namespace{
+
+// blocks smaller than this are not worth compressing
+const uint64_t vMinCompressSize = 512;
+
+// file extensions of already compressed file formats
+const std::unordered_set<std::string> vCompressedExtensions{
+	".7z", ".bz2", ".gz", ".xz", ".zip", ".zst", ".lz4", ".rar", ".delga",
+	".png", ".jpg", ".jpeg", ".webp", ".ktx2", ".basis",
+	".ogg", ".oga", ".mp3", ".opus", ".flac",
+	".ogv", ".mp4", ".webm", ".mkv", ".avi"
+};
+
+}
 
 
 // Class derlTaskProcessorRemoteClient
 ////////////////////////////////////////
 
 derlTaskProcessorRemoteClient::derlTaskProcessorRemoteClient(derlRemoteClient &client) :
-pClient(client){
+pClient(client),
+pCompression(false),
+pZeroBlocks(false),
+pTransferOrderPolicy(std::make_shared<derlTransferOrderPolicy>()){
 	pLogClassName = "derlTaskProcessorRemoteClient";
 }
 
@@ -54,6 +82,16 @@ void derlTaskProcessorRemoteClient::RunTask(){
 	const std::lock_guard guard(pClient.GetMutex());
 	pBaseDir = pClient.GetPathDataDir();
 	pEnableDebugLog = pClient.GetEnableDebugLog();
+	pHashAlgorithm = pClient.GetConnection().GetHashAlgorithm();
+	pHashTree = (pClient.GetConnection().GetEnabledFeatures()
+		& (uint32_t)derlProtocol::Features::treeHash) != 0;
+	pHashCache = pClient.GetServer().GetHashCache();
+	pBlockSizePolicy = pClient.GetServer().GetBlockSizePolicy();
+	pCompression = (pClient.GetConnection().GetEnabledFeatures()
+		& (uint32_t)derlProtocol::Features::compression) != 0;
+	pZeroBlocks = (pClient.GetConnection().GetEnabledFeatures()
+		& (uint32_t)derlProtocol::Features::zeroBlocks) != 0;
+	pTransferOrderPolicy = pClient.GetTransferOrderPolicy();
 	PrepareRunTask();
 	}
 	
@@ -142,33 +180,30 @@ void derlTaskProcessorRemoteClient::ProcessFileLayoutServer(derlTaskFileLayout &
 		return;
 	}
 	
-	const uint64_t blockSize = 1024000L;
+	derlServer &server = pClient.GetServer();
+	bool building = false;
 	
 	try{
-		const derlFileLayout::Ref layout(std::make_shared<derlFileLayout>());
-		CalcFileLayout(*layout, "");
-		
-		derlFile::Map::const_iterator iterFile;
-		for(iterFile=layout->GetFilesBegin(); iterFile!=layout->GetFilesEnd(); iterFile++){
-			derlFile &file = *iterFile->second;
-			file.SetBlockSize(blockSize);
+		derlFileLayout::Ref layout(server.AcquireFileLayout(pHashAlgorithm, pHashTree));
+		if(layout){
+			std::stringstream ss;
+			ss << "Shared file layout used. " << layout->GetFileCount() << " file(s)";
+			Log(denLogger::LogSeverity::info, "ProcessFileLayoutServer", ss.str());
 			
-			if(file.GetSize() <= blockSize){
-				const derlFileBlock::Ref block(std::make_shared<derlFileBlock>(0, file.GetSize()));
-				block->SetHash(file.GetHash());
-				file.AddBlock(block);
-				
-			}else{
-				derlFileBlock::List blocks;
-				CalcFileBlockHashes(blocks, file.GetPath(), file.GetBlockSize());
-				file.SetBlocks(blocks);
+		}else{
+			building = true;
+			layout = std::make_shared<derlFileLayout>();
+			CalcFileLayout(*layout, "");
+			SaveHashCache(*layout);
+			
+			{
+			std::stringstream ss;
+			ss << "File layout build. " << layout->GetFileCount() << " file(s)";
+			Log(denLogger::LogSeverity::info, "ProcessFileLayoutServer", ss.str());
 			}
-		}
-		
-		{
-		std::stringstream ss;
-		ss << "File layout build. " << layout->GetFileCount() << " file(s)";
-		Log(denLogger::LogSeverity::info, "ProcessFileLayoutServer", ss.str());
+			
+			building = false;
+			server.FinishFileLayout(pHashAlgorithm, pHashTree, layout);
 		}
 		
 		task.SetStatus(derlTaskFileLayout::Status::success);
@@ -181,12 +216,18 @@ void derlTaskProcessorRemoteClient::ProcessFileLayoutServer(derlTaskFileLayout &
 		}
 		
 	}catch(const std::exception &e){
+		if(building){
+			server.FinishFileLayout(pHashAlgorithm, pHashTree, nullptr);
+		}
 		LogException("ProcessFileLayoutServer", e, "Failed");
 		std::stringstream ss;
 		ss << "Build server file layout failed: " << e.what();
 		pClient.FailSynchronization(ss.str());
 		
 	}catch(...){
+		if(building){
+			server.FinishFileLayout(pHashAlgorithm, pHashTree, nullptr);
+		}
 		Log(denLogger::LogSeverity::error, "ProcessFileLayoutServer", "Failed");
 		pClient.FailSynchronization("Build server file layout failed: unknown error");
 	}
@@ -238,12 +279,47 @@ void derlTaskProcessorRemoteClient::ProcessPrepareWriting(derlTaskSyncClient &ta
 			throw std::runtime_error("Missing layouts");
 		}
 		
+		// delta tasks read the server files. create them before locking the task
+		derlTaskFileWrite::Map tasksDelta;
+		if(task.GetRollingDelta() || task.GetContentChunkSize() > 0){
+			derlFile::Map::const_iterator iter;
+			for(iter=layoutServer->GetFilesBegin(); iter!=layoutServer->GetFilesEnd(); iter++){
+				const derlFile &fileServer = *iter->second;
+				const derlFile::Ref fileClient(layoutClient->GetFileAt(fileServer.GetPath()));
+				if(!fileClient || !fileClient->GetHasBlocks()
+				|| fileClient->GetSize() == fileServer.GetSize()){
+					continue;
+				}
+				
+				const derlTaskFileWrite::Ref taskDelta(fileClient->GetContentChunks()
+					? CreateFileWriteTaskChunks(fileServer, *fileClient)
+					: CreateFileWriteTaskDelta(fileServer, *fileClient));
+				if(taskDelta){
+					tasksDelta[fileServer.GetPath()] = taskDelta;
+				}
+			}
+		}
+		
 		bool finished;
 		{
 		const std::lock_guard guard(task.GetMutex());
 		AddFileDeleteTasks(task, *layoutServer, *layoutClient);
 		AddFileWriteTasks(task, *layoutServer, *layoutClient);
 		
+		derlTaskFileWrite::Map::const_iterator iterDelta;
+		for(iterDelta=tasksDelta.cbegin(); iterDelta!=tasksDelta.cend(); iterDelta++){
+			task.GetTasksWriteFile()[iterDelta->first] = iterDelta->second;
+		}
+		
+		derlTaskFileWrite::List tasksOrdered;
+		tasksOrdered.reserve(task.GetTasksWriteFile().size());
+		derlTaskFileWrite::Map::const_iterator iterWrite;
+		for(iterWrite=task.GetTasksWriteFile().cbegin(); iterWrite!=task.GetTasksWriteFile().cend(); iterWrite++){
+			tasksOrdered.push_back(iterWrite->second);
+		}
+		pTransferOrderPolicy->Order(tasksOrdered);
+		pClient.GetConnection().QueueWriteFiles(task, tasksOrdered);
+		
 		task.SetStatus(derlTaskSyncClient::Status::processWriting);
 		finished = task.GetTasksDeleteFile().empty() && task.GetTasksWriteFile().empty();
 		}
@@ -282,8 +358,46 @@ void derlTaskProcessorRemoteClient::ProcessReadFileBlock(derlTaskFileWriteBlock
 		OpenFile(task.GetParentTask().GetPath(), false);
 		
 		std::string &data = task.GetData();
-		data.assign(task.GetSize(), 0);
-		ReadFile((void*)data.c_str(), task.GetParentTask().GetBlockSize() * task.GetIndex(), task.GetSize());
+		
+		if(task.GetParentTask().GetDelta()){
+			// data is the concatenation of all literal ranges
+			uint64_t dataSize = 0;
+			for(const derlTaskFileWriteBlock::Instruction &instruction : task.GetInstructions()){
+				if(instruction.type == derlTaskFileWriteBlock::InstructionType::literal){
+					dataSize += instruction.size;
+				}
+			}
+			
+			data.assign(dataSize, 0);
+			uint64_t dataOffset = 0;
+			for(const derlTaskFileWriteBlock::Instruction &instruction : task.GetInstructions()){
+				if(instruction.type == derlTaskFileWriteBlock::InstructionType::literal){
+					ReadFile((void*)(data.c_str() + dataOffset), instruction.offset, instruction.size);
+					dataOffset += instruction.size;
+				}
+			}
+			
+		}else{
+			const uint64_t offset = task.GetParentTask().GetBlockSize() * task.GetIndex();
+			const void * const mapped = GetFileData(offset, task.GetSize());
+			if(mapped){
+				data.assign((const char*)mapped, task.GetSize());
+				
+			}else{
+				data.assign(task.GetSize(), 0);
+				ReadFile((void*)data.c_str(), offset, task.GetSize());
+			}
+		}
+		
+		// bundled files carry data for all blocks
+		if(pZeroBlocks && !task.GetParentTask().GetDelta() && !task.GetParentTask().GetBundled()
+		&& data.find_first_not_of('\0') == std::string::npos){
+			task.SetZero(true);
+			data.clear();
+			
+		}else if(pCompression && CanCompressFile(task.GetParentTask().GetPath())){
+			CompressBlockData(task);
+		}
 		task.SetStatus(derlTaskFileWriteBlock::Status::dataReady);
 		
 		const derlTaskSyncClient::Ref taskSync(pClient.GetTaskSyncClient());
@@ -362,30 +476,13 @@ const derlFileLayout &layoutServer, const derlFileLayout &layoutClient){
 			continue;
 		}
 		
-		derlFile &fileClient = *fileClientRef;
-		
-		if(fileClient.GetSize() != fileServer.GetSize()){
-			continue;
-		}
-		if(fileClient.GetHash() == fileServer.GetHash()){
+		// files requested while receiving client file layout pages are skipped
+		const derlTaskFileBlockHashes::Ref taskHashes(task.AddFileBlockHashesTask(fileServer, *fileClientRef));
+		if(!taskHashes){
 			continue;
 		}
 		
-		fileClient.SetBlockSize(fileServer.GetBlockSize());
-		fileClient.RemoveAllBlocks();
-		derlFileBlock::List::const_iterator iterBlock;
-		for(iterBlock=fileServer.GetBlocksBegin(); iterBlock!=fileServer.GetBlocksEnd(); iterBlock++){
-			const derlFileBlock &blockServer = **iterBlock;
-			fileClient.AddBlock(std::make_shared<derlFileBlock>(
-				blockServer.GetOffset(), blockServer.GetSize()));
-		}
-		
-		const derlTaskFileBlockHashes::Ref taskHashes(std::make_shared<derlTaskFileBlockHashes>(
-			fileServer.GetPath(), fileServer.GetBlockSize()));
-		task.GetTasksFileBlockHashes()[fileServer.GetPath()] = taskHashes;
-		
 		try{
-			taskHashes->SetStatus(derlTaskFileBlockHashes::Status::processing);
 			pClient.GetConnection().SendRequestFileBlockHashes(*taskHashes);
 			
 		}catch(const std::exception &e){
@@ -418,10 +515,17 @@ const derlFileLayout &layoutServer, const derlFileLayout &layoutClient){
 				continue;
 			}
 			
-			if(fileClient.GetBlockSize() == fileServer.GetBlockSize()
+			if(fileClient.GetSize() == fileServer.GetSize()
+			&& fileClient.GetBlockSize() == fileServer.GetBlockSize()
 			&& fileClient.GetBlockCount() == fileServer.GetBlockCount()){
 				AddFileWriteTaskPartial(task, fileServer, fileClient);
 				
+			}else if(task.GetPartialResize() && fileClient.GetHasBlocks()
+			&& !fileClient.GetContentChunks()
+			&& fileClient.GetBlockSize() == fileServer.GetBlockSize()){
+				// client resizes the file. blocks present at the same index are kept
+				AddFileWriteTaskPartial(task, fileServer, fileClient);
+				
 			}else{
 				AddFileWriteTaskFull(task, fileServer);
 			}
@@ -459,14 +563,20 @@ const derlFile &fileServer, const derlFile &fileClient){
 	taskWrite->SetBlockSize(fileServer.GetBlockSize());
 	taskWrite->SetBlockCount(fileServer.GetBlockCount());
 	
-	derlFileBlock::List::const_iterator iterServer, iterClient;
+	const int countClient = fileClient.GetBlockCount();
+	derlFileBlock::List::const_iterator iterServer;
 	int index;
 	
-	for(iterClient=fileClient.GetBlocksBegin(), index=0, iterServer=fileServer.GetBlocksBegin();
-	iterServer!=fileServer.GetBlocksEnd(); iterClient++, iterServer++, index++){
+	for(index=0, iterServer=fileServer.GetBlocksBegin();
+	iterServer!=fileServer.GetBlocksEnd(); iterServer++, index++){
 		const derlFileBlock &blockServer = **iterServer;
-		const derlFileBlock &blockClient = **iterClient;
+		if(index >= countClient){
+			taskBlocks.push_back(std::make_shared<derlTaskFileWriteBlock>(
+				*taskWrite, index, blockServer.GetSize()));
+			continue;
+		}
 		
+		const derlFileBlock &blockClient = *fileClient.GetBlockAt(index);
 		if(blockClient.GetHash() == blockServer.GetHash()
 		&& blockClient.GetOffset() == blockServer.GetOffset()
 		&& blockClient.GetSize() == blockServer.GetSize()){
@@ -479,3 +589,290 @@ const derlFile &fileServer, const derlFile &fileClient){
 	
 	task.GetTasksWriteFile()[fileServer.GetPath()] = taskWrite;
 }
+
+derlTaskFileWrite::Ref derlTaskProcessorRemoteClient::CreateFileWriteTaskDelta(
+const derlFile &fileServer, const derlFile &fileClient){
+	const uint64_t blockSize = fileServer.GetBlockSize();
+	const uint64_t fileSize = fileServer.GetSize();
+	if(blockSize == 0 || fileSize <= blockSize){
+		return nullptr;
+	}
+	
+	// only full size client blocks can match a window of the server file
+	std::unordered_multimap<uint32_t, const derlFileBlock*> weakBlocks;
+	std::vector<bool> weakTags(0x10000, false);
+	derlFileBlock::List::const_iterator iterBlock;
+	for(iterBlock=fileClient.GetBlocksBegin(); iterBlock!=fileClient.GetBlocksEnd(); iterBlock++){
+		const derlFileBlock &block = **iterBlock;
+		if(block.GetSize() == blockSize){
+			weakBlocks.insert({block.GetWeakHash(), &block});
+			weakTags[block.GetWeakHash() & 0xffff] = true;
+		}
+	}
+	if(weakBlocks.empty()){
+		return nullptr;
+	}
+	
+	derlTaskFileWriteBlock::Instructions instructions;
+	bool matched = false;
+	
+	try{
+		OpenFile(fileServer.GetPath(), false);
+		
+		// memory mapped files are scanned directly, otherwise through a sliding buffer
+		const uint8_t *data = (const uint8_t*)GetFileData(0, fileSize);
+		const uint64_t chunkSize = std::max((uint64_t)4 * 1024 * 1024, blockSize * 4);
+		std::string buffer;
+		uint64_t bufferOffset = 0;
+		uint64_t bufferSize = data ? fileSize : 0;
+		
+		derlRollingChecksum checksum;
+		bool checksumValid = false;
+		derlHasher hasher(pHashAlgorithm);
+		uint64_t literalStart = 0, position = 0;
+		
+		while(position + blockSize <= fileSize){
+			const uint64_t windowEnd = std::min(position + blockSize + 1, fileSize);
+			if(windowEnd > bufferOffset + bufferSize){
+				bufferOffset = position;
+				bufferSize = std::min(chunkSize, fileSize - position);
+				buffer.assign(bufferSize, 0);
+				ReadFile((void*)buffer.c_str(), bufferOffset, bufferSize);
+				data = (const uint8_t*)buffer.c_str();
+			}
+			
+			const uint8_t * const window = data + (position - bufferOffset);
+			if(!checksumValid){
+				checksum.Init(window, blockSize);
+				checksumValid = true;
+			}
+			
+			const uint32_t weakHash = checksum.GetChecksum();
+			const derlFileBlock *found = nullptr;
+			
+			if(weakTags[weakHash & 0xffff]){
+				const auto range(weakBlocks.equal_range(weakHash));
+				if(range.first != range.second){
+					hasher.Reset();
+					hasher.Add(window, blockSize);
+					const derlDigest digest(hasher.GetDigest());
+					
+					auto iter = range.first;
+					for(; iter!=range.second; iter++){
+						if(iter->second->GetHash() == digest){
+							found = iter->second;
+							break;
+						}
+					}
+				}
+			}
+			
+			if(found){
+				if(position > literalStart){
+					instructions.push_back({derlTaskFileWriteBlock::InstructionType::literal,
+						literalStart, position - literalStart});
+				}
+				
+				if(!instructions.empty()
+				&& instructions.back().type == derlTaskFileWriteBlock::InstructionType::copy
+				&& instructions.back().offset + instructions.back().size == found->GetOffset()){
+					instructions.back().size += blockSize;
+					
+				}else{
+					instructions.push_back({derlTaskFileWriteBlock::InstructionType::copy,
+						found->GetOffset(), blockSize});
+				}
+				
+				position += blockSize;
+				literalStart = position;
+				checksumValid = false;
+				matched = true;
+				continue;
+			}
+			
+			if(position + blockSize < fileSize){
+				checksum.Roll(window[0], window[blockSize]);
+			}
+			position++;
+		}
+		
+		if(literalStart < fileSize){
+			instructions.push_back({derlTaskFileWriteBlock::InstructionType::literal,
+				literalStart, fileSize - literalStart});
+		}
+		
+		CloseFile();
+		
+	}catch(const std::exception &e){
+		LogException("CreateFileWriteTaskDelta", e, fileServer.GetPath());
+		CloseFile();
+		throw;
+		
+	}catch(...){
+		Log(denLogger::LogSeverity::error, "CreateFileWriteTaskDelta", fileServer.GetPath());
+		CloseFile();
+		throw;
+	}
+	
+	if(!matched){
+		return nullptr;
+	}
+	
+	return CreateFileWriteTaskInstructions(fileServer, instructions);
+}
+
+derlTaskFileWrite::Ref derlTaskProcessorRemoteClient::CreateFileWriteTaskChunks(
+const derlFile &fileServer, const derlFile &fileClient){
+	if(fileClient.GetBlockCount() == 0){
+		return nullptr;
+	}
+	
+	// chunks are looked up by the leading digest bytes and verified using the full digest
+	std::unordered_multimap<uint64_t, const derlFileBlock*> clientChunks;
+	derlFileBlock::List::const_iterator iterBlock;
+	for(iterBlock=fileClient.GetBlocksBegin(); iterBlock!=fileClient.GetBlocksEnd(); iterBlock++){
+		const derlFileBlock &block = **iterBlock;
+		uint64_t key;
+		memcpy(&key, block.GetHash().GetBytes(), sizeof(key));
+		clientChunks.insert({key, &block});
+	}
+	
+	derlFile chunksServer(fileServer.GetPath());
+	CalcFileChunks(chunksServer, fileClient.GetBlockSize());
+	if(chunksServer.GetSize() != fileServer.GetSize()){
+		// file changed since calculating the layout. write the entire file instead
+		return nullptr;
+	}
+	
+	derlTaskFileWriteBlock::Instructions instructions;
+	bool matched = false;
+	
+	for(iterBlock=chunksServer.GetBlocksBegin(); iterBlock!=chunksServer.GetBlocksEnd(); iterBlock++){
+		const derlFileBlock &chunk = **iterBlock;
+		uint64_t key;
+		memcpy(&key, chunk.GetHash().GetBytes(), sizeof(key));
+		
+		const derlFileBlock *found = nullptr;
+		const auto range(clientChunks.equal_range(key));
+		auto iter = range.first;
+		for(; iter!=range.second; iter++){
+			if(iter->second->GetHash() == chunk.GetHash() && iter->second->GetSize() == chunk.GetSize()){
+				found = iter->second;
+				break;
+			}
+		}
+		
+		if(found){
+			if(!instructions.empty()
+			&& instructions.back().type == derlTaskFileWriteBlock::InstructionType::copy
+			&& instructions.back().offset + instructions.back().size == found->GetOffset()){
+				instructions.back().size += chunk.GetSize();
+				
+			}else{
+				instructions.push_back({derlTaskFileWriteBlock::InstructionType::copy,
+					found->GetOffset(), chunk.GetSize()});
+			}
+			matched = true;
+			
+		}else if(!instructions.empty()
+		&& instructions.back().type == derlTaskFileWriteBlock::InstructionType::literal){
+			instructions.back().size += chunk.GetSize();
+			
+		}else{
+			instructions.push_back({derlTaskFileWriteBlock::InstructionType::literal,
+				chunk.GetOffset(), chunk.GetSize()});
+		}
+	}
+	
+	if(!matched){
+		return nullptr;
+	}
+	
+	return CreateFileWriteTaskInstructions(fileServer, instructions);
+}
+
+derlTaskFileWrite::Ref derlTaskProcessorRemoteClient::CreateFileWriteTaskInstructions(
+const derlFile &fileServer, const derlTaskFileWriteBlock::Instructions &instructions){
+	const uint64_t blockSize = fileServer.GetBlockSize();
+	const uint64_t fileSize = fileServer.GetSize();
+	if(blockSize == 0 || fileSize == 0){
+		return nullptr;
+	}
+	
+	const derlTaskFileWrite::Ref taskWrite(std::make_shared<derlTaskFileWrite>(fileServer.GetPath()));
+	derlTaskFileWriteBlock::List &taskBlocks = taskWrite->GetBlocks();
+	const int blockCount = (int)(((fileSize - 1) / blockSize) + 1);
+	taskWrite->SetFileSize(fileSize);
+	taskWrite->SetBlockSize(blockSize);
+	taskWrite->SetBlockCount(blockCount);
+	taskWrite->SetDelta(true);
+	
+	// split instructions into target blocks
+	derlTaskFileWriteBlock::Instructions::const_iterator iterInstruction(instructions.cbegin());
+	uint64_t instructionUsed = 0, copySize = 0;
+	int index;
+	
+	for(index=0; index<blockCount; index++){
+		const uint64_t targetSize = std::min(blockSize, fileSize - blockSize * index);
+		const derlTaskFileWriteBlock::Ref taskBlock(std::make_shared<derlTaskFileWriteBlock>(
+			*taskWrite, index, targetSize));
+		derlTaskFileWriteBlock::Instructions &blockInstructions = taskBlock->GetInstructions();
+		uint64_t remaining = targetSize;
+		
+		while(remaining > 0){
+			const derlTaskFileWriteBlock::Instruction &instruction = *iterInstruction;
+			const uint64_t size = std::min(remaining, instruction.size - instructionUsed);
+			
+			blockInstructions.push_back({instruction.type, instruction.offset + instructionUsed, size});
+			if(instruction.type == derlTaskFileWriteBlock::InstructionType::copy){
+				copySize += size;
+			}
+			
+			remaining -= size;
+			instructionUsed += size;
+			if(instructionUsed == instruction.size){
+				iterInstruction++;
+				instructionUsed = 0;
+			}
+		}
+		
+		taskBlocks.push_back(taskBlock);
+	}
+	
+	if(pEnableDebugLog){
+		std::stringstream ss;
+		ss << "Delta " << fileServer.GetPath() << " size " << fileSize
+			<< " copy " << copySize << " literal " << (fileSize - copySize);
+		LogDebug("CreateFileWriteTaskInstructions", ss.str());
+	}
+	
+	return taskWrite;
+}
+
+bool derlTaskProcessorRemoteClient::CanCompressFile(const std::string &path){
+	return vCompressedExtensions.find(derlBlockSizePolicy::GetExtension(path))
+		== vCompressedExtensions.cend();
+}
+
+void derlTaskProcessorRemoteClient::CompressBlockData(derlTaskFileWriteBlock &task){
+	std::string &data = task.GetData();
+	if(data.size() < vMinCompressSize){
+		return;
+	}
+	
+	// compressing has to save at least 1/8 of the data to be worth decompressing
+	std::string compressed;
+	if(!derlLz4::Compress(data.c_str(), data.size(), compressed, data.size() - data.size() / 8)){
+		return;
+	}
+	
+	if(pEnableDebugLog){
+		std::stringstream ss;
+		ss << "Compressed block " << task.GetIndex() << " from " << data.size()
+			<< " to " << compressed.size() << " path " << task.GetParentTask().GetPath();
+		LogDebug("CompressBlockData", ss.str());
+	}
+	
+	data.swap(compressed);
+	task.SetCompressed(true);
+}
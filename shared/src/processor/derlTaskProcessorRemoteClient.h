@@ -29,6 +29,7 @@
 
 #include "../task/derlTaskSyncClient.h"
 #include "../task/derlTaskFileLayout.h"
+#include "../derlTransferOrderPolicy.h"
 
 class derlRemoteClient;
 
@@ -45,6 +46,9 @@ public:
 	
 protected:
 	derlRemoteClient &pClient;
+	bool pCompression;
+	bool pZeroBlocks;
+	derlTransferOrderPolicy::Ref pTransferOrderPolicy;
 	
 	
 public:
@@ -118,9 +122,50 @@ protected:
 	/** \brief Create write file task writing the entire file. */
 	void AddFileWriteTaskFull(derlTaskSyncClient &task, const derlFile &file);
 	
-	/** \brief Create write file task writing only changed blocks. */
+	/**
+	 * \brief Create write file task writing only changed blocks.
+	 * 
+	 * Client file can have a different size. Server blocks beyond the client blocks
+	 * are always written.
+	 */
 	void AddFileWriteTaskPartial(derlTaskSyncClient &task, const derlFile &fileServer,
 		const derlFile &fileClient);
+	
+	/**
+	 * \brief Create write file task transfering delta to existing client file or nullptr.
+	 * 
+	 * Scans the server file with a rolling checksum for blocks present anywhere in the
+	 * client file. Matching blocks are copied by the client from the existing file, all
+	 * other data is send as literal data. Returns nullptr if no block matches.
+	 */
+	derlTaskFileWrite::Ref CreateFileWriteTaskDelta(const derlFile &fileServer,
+		const derlFile &fileClient);
+	
+	/**
+	 * \brief Create write file task transfering chunks missing in client file or nullptr.
+	 * 
+	 * Client file blocks are content defined chunks. Calculates the chunks of the server
+	 * file using the same average size. Chunks present anywhere in the client file are
+	 * copied by the client from the existing file, all other chunks are send as literal
+	 * data. Returns nullptr if no chunk matches or the server file size changed.
+	 */
+	derlTaskFileWrite::Ref CreateFileWriteTaskChunks(const derlFile &fileServer,
+		const derlFile &fileClient);
+	
+	/** \brief Create write file task splitting delta instructions into blocks. */
+	derlTaskFileWrite::Ref CreateFileWriteTaskInstructions(const derlFile &fileServer,
+		const derlTaskFileWriteBlock::Instructions &instructions);
+	
+	/**
+	 * \brief File data is worth compressing.
+	 * 
+	 * Default implementation returns false for file extensions of already compressed
+	 * file formats like archives, images, audio and video.
+	 */
+	virtual bool CanCompressFile(const std::string &path);
+	
+	/** \brief Compress block data if compression reduces the size enough. */
+	void CompressBlockData(derlTaskFileWriteBlock &task);
 };
 
 #endif
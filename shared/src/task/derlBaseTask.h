@@ -67,7 +67,13 @@ public:
 		fileWrite,
 		
 		/** \brief derlTaskFileWriteBlock. */
-		fileWriteBlock
+		fileWriteBlock,
+		
+		/** \brief derlTaskFileLayoutUpdate. */
+		fileLayoutUpdate,
+		
+		/** \brief derlTaskFileBundle. */
+		fileBundle
 	};
 	
 	
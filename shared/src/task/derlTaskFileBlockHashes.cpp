@@ -32,7 +32,9 @@ derlTaskFileBlockHashes::derlTaskFileBlockHashes(const std::string &path, uint64
 derlBaseTask(Type::fileBlockHashes),
 pPath(path),
 pStatus(Status::pending),
-pBlockSize(blockSize){
+pBlockSize(blockSize),
+pContentChunks(false),
+pWeakHashes(false){
 }
 
 
@@ -42,3 +44,11 @@ pBlockSize(blockSize){
 void derlTaskFileBlockHashes::SetStatus(Status status){
 	pStatus = status;
 }
+
+void derlTaskFileBlockHashes::SetContentChunks(bool contentChunks){
+	pContentChunks = contentChunks;
+}
+
+void derlTaskFileBlockHashes::SetWeakHashes(bool weakHashes){
+	pWeakHashes = weakHashes;
+}
@@ -58,6 +58,8 @@ private:
 	const std::string pPath;
 	Status pStatus;
 	uint64_t pBlockSize;
+	bool pContentChunks;
+	bool pWeakHashes;
 	
 	
 public:
@@ -80,6 +82,14 @@ public:
 	
 	/** \brief Block size. */
 	inline uint64_t GetBlockSize() const{ return pBlockSize; }
+	
+	/** \brief Calculate content defined chunks with block size as average chunk size. */
+	inline bool GetContentChunks() const{ return pContentChunks; }
+	void SetContentChunks(bool contentChunks);
+	
+	/** \brief Calculate weak rolling checksums of blocks too. */
+	inline bool GetWeakHashes() const{ return pWeakHashes; }
+	void SetWeakHashes(bool weakHashes);
 	/*@}*/
 };
 
@@ -0,0 +1,67 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _DERLTASKFILEBUNDLE_H_
+#define _DERLTASKFILEBUNDLE_H_
+
+#include "derlTaskFileWrite.h"
+
+
+/**
+ * \brief File bundle task.
+ * 
+ * Writes multiple small files received in one message. Each file is a file write task
+ * with at most one block holding the entire file data. The status of the file write
+ * tasks is the result send back for each file.
+ */
+class derlTaskFileBundle : public derlBaseTask{
+public:
+	/** \brief Reference type. */
+	typedef std::shared_ptr<derlTaskFileBundle> Ref;
+	
+	/** \brief Reference list. */
+	typedef std::vector<Ref> List;
+	
+	
+private:
+	derlTaskFileWrite::List pFiles;
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create task. */
+	derlTaskFileBundle();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Files. */
+	inline derlTaskFileWrite::List &GetFiles(){ return pFiles; }
+	inline const derlTaskFileWrite::List &GetFiles() const{ return pFiles; }
+	/*@}*/
+};
+
+#endif
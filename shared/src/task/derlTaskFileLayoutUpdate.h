@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024, DragonDreams GmbH (info@dragondreams.ch)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _DERLTASKFILELAYOUTUPDATE_H_
+#define _DERLTASKFILELAYOUTUPDATE_H_
+
+#include <set>
+#include <string>
+
+#include "derlBaseTask.h"
+
+
+/**
+ * \brief Update file layout for changed paths.
+ * 
+ * Paths can refer to files or directories. Changed files are hashed again. Files no longer
+ * existing are removed from the layout. Directories are rescanned entirely.
+ */
+class derlTaskFileLayoutUpdate : public derlBaseTask{
+public:
+	/** \brief Reference type. */
+	typedef std::shared_ptr<derlTaskFileLayoutUpdate> Ref;
+	
+	/** \brief Path set. */
+	typedef std::set<std::string> SetPath;
+	
+	/** \brief Status. */
+	enum class Status{
+		pending,
+		processing,
+		success,
+		failure
+	};
+	
+	
+private:
+	const SetPath pPaths;
+	Status pStatus;
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create task. */
+	derlTaskFileLayoutUpdate(const SetPath &paths);
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Changed paths. */
+	inline const SetPath &GetPaths() const{ return pPaths; }
+	
+	/** \brief Status. */
+	inline Status GetStatus() const{ return pStatus; }
+	void SetStatus(Status status);
+	/*@}*/
+};
+
+#endif
@@ -22,9 +22,18 @@
  * SOFTWARE.
  */
 
+#include <cstring>
+
 #include "derlTaskFileWrite.h"
 
 
+namespace{
+
+const char * const vDeltaPathSuffix = ".derldelta";
+
+}
+
+
 // Class derlTaskFileWrite
 ////////////////////////////
 
@@ -35,7 +44,10 @@ pStatus(Status::pending),
 pFileSize(0L),
 pBlockSize(0L),
 pBlockCount(0),
-pTruncate(false){
+pTruncate(false),
+pDelta(false),
+pBundled(false),
+pJournaled(false){
 }
 
 
@@ -62,6 +74,31 @@ void derlTaskFileWrite::SetTruncate(bool truncate){
 	pTruncate = truncate;
 }
 
-void derlTaskFileWrite::SetHash(const std::string &hash){
+void derlTaskFileWrite::SetDelta(bool delta){
+	pDelta = delta;
+}
+
+std::string derlTaskFileWrite::GetDeltaPath() const{
+	return pPath + vDeltaPathSuffix;
+}
+
+bool derlTaskFileWrite::IsDeltaPath(const std::string &path){
+	const size_t length = strlen(vDeltaPathSuffix);
+	return path.size() > length && path.compare(path.size() - length, length, vDeltaPathSuffix) == 0;
+}
+
+void derlTaskFileWrite::SetBundled(bool bundled){
+	pBundled = bundled;
+}
+
+void derlTaskFileWrite::SetHash(const derlDigest &hash){
 	pHash = hash;
 }
+
+void derlTaskFileWrite::SetJournaled(bool journaled){
+	pJournaled = journaled;
+}
+
+void derlTaskFileWrite::SetResumeBlocks(const std::vector<bool> &blocks){
+	pResumeBlocks = blocks;
+}
@@ -25,10 +25,12 @@
 #ifndef _DERLTASKFILEWRITE_H_
 #define _DERLTASKFILEWRITE_H_
 
+#include <deque>
 #include <mutex>
 #include <atomic>
 
 #include "derlTaskFileWriteBlock.h"
+#include "../derlDigest.h"
 
 
 /**
@@ -42,6 +44,9 @@ public:
 	/** \brief Reference list. */
 	typedef std::vector<Ref> List;
 	
+	/** \brief Reference queue. */
+	typedef std::deque<Ref> Queue;
+	
 	/** \brief Reference map keyed by path. */
 	typedef std::unordered_map<std::string, Ref> Map;
 	
@@ -65,7 +70,11 @@ private:
 	int pBlockCount;
 	derlTaskFileWriteBlock::List pBlocks;
 	bool pTruncate;
-	std::string pHash;
+	bool pDelta;
+	bool pBundled;
+	derlDigest pHash;
+	bool pJournaled;
+	std::vector<bool> pResumeBlocks;
 	std::mutex pMutex;
 	
 	
@@ -99,13 +108,48 @@ public:
 	inline int GetBlockCount() const{ return pBlockCount; }
 	void SetBlockCount(int blockCount);
 	
-	/** \brief Truncate file. */
+	/**
+	 * \brief File size changed.
+	 * 
+	 * Existing file is resized if partial resize is enabled otherwise truncated.
+	 */
 	inline bool GetTruncate() const{ return pTruncate; }
 	void SetTruncate(bool truncate);
 	
+	/**
+	 * \brief Write blocks using delta instructions.
+	 * 
+	 * Blocks are reconstructed from the existing file and literal data and written to
+	 * a temporary file replacing the existing file while finishing.
+	 */
+	inline bool GetDelta() const{ return pDelta; }
+	void SetDelta(bool delta);
+	
+	/** \brief Path of temporary file written by delta writes. */
+	std::string GetDeltaPath() const;
+	
+	/** \brief Path is a temporary file written by delta writes. */
+	static bool IsDeltaPath(const std::string &path);
+	
+	/** \brief File is written using a file bundle. */
+	inline bool GetBundled() const{ return pBundled; }
+	void SetBundled(bool bundled);
+	
 	/** \brief File hash. */
-	inline const std::string &GetHash() const{ return pHash; }
-	void SetHash(const std::string &hash);
+	inline const derlDigest &GetHash() const{ return pHash; }
+	void SetHash(const derlDigest &hash);
+	
+	/** \brief Written blocks are stored in the write journal. */
+	inline bool GetJournaled() const{ return pJournaled; }
+	void SetJournaled(bool journaled);
+	
+	/**
+	 * \brief Blocks already written by an interrupted previous write.
+	 * 
+	 * Empty if the write is not resumed.
+	 */
+	inline const std::vector<bool> &GetResumeBlocks() const{ return pResumeBlocks; }
+	void SetResumeBlocks(const std::vector<bool> &blocks);
 	
 	/**
 	 * \brief Blocks.
@@ -35,7 +35,9 @@ derlBaseTask(Type::fileWriteBlock),
 pParentTask(parentTask),
 pStatus(Status::pending),
 pIndex(index),
-pSize(size){
+pSize(size),
+pCompressed(false),
+pZero(false){
 }
 
 derlTaskFileWriteBlock::derlTaskFileWriteBlock(derlTaskFileWrite &parentTask,
@@ -45,7 +47,9 @@ pParentTask(parentTask),
 pStatus(Status::pending),
 pIndex(index),
 pSize(size),
-pData(data){
+pData(data),
+pCompressed(false),
+pZero(false){
 }
 
 
@@ -55,3 +59,15 @@ pData(data){
 void derlTaskFileWriteBlock::SetStatus(Status status){
 	pStatus = status;
 }
+
+void derlTaskFileWriteBlock::SetCompressed(bool compressed){
+	pCompressed = compressed;
+}
+
+void derlTaskFileWriteBlock::SetZero(bool zero){
+	pZero = zero;
+}
+
+void derlTaskFileWriteBlock::SetSendState(const derlTransferWindow::SendState &state){
+	pSendState = state;
+}
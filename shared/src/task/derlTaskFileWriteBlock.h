@@ -29,6 +29,7 @@
 #include <atomic>
 
 #include "derlBaseTask.h"
+#include "../derlTransferWindow.h"
 
 class derlFileBlock;
 class derlTaskFileWrite;
@@ -45,6 +46,31 @@ public:
 	/** \brief Reference list. */
 	typedef std::vector<Ref> List;
 	
+	/** \brief Delta instruction type. */
+	enum class InstructionType{
+		/** \brief Copy data from existing client file. */
+		copy,
+		
+		/** \brief Literal data. */
+		literal
+	};
+	
+	/**
+	 * \brief Delta instruction.
+	 * 
+	 * For copy instructions offset is the offset in the existing client file. For literal
+	 * instructions offset is the offset in the server file on the server side and the
+	 * offset in the block data on the client side.
+	 */
+	struct Instruction{
+		InstructionType type;
+		uint64_t offset;
+		uint64_t size;
+	};
+	
+	/** \brief Delta instruction list. */
+	typedef std::vector<Instruction> Instructions;
+	
 	/** \brief Status. */
 	enum class Status{
 		pending,
@@ -62,6 +88,10 @@ private:
 	int pIndex;
 	uint64_t pSize;
 	std::string pData;
+	bool pCompressed;
+	bool pZero;
+	Instructions pInstructions;
+	derlTransferWindow::SendState pSendState;
 	
 	
 public:
@@ -95,6 +125,22 @@ public:
 	/** \brief Data. */
 	inline std::string &GetData(){ return pData; }
 	inline const std::string &GetData() const{ return pData; }
+	
+	/** \brief Data is compressed using derlLz4. */
+	inline bool GetCompressed() const{ return pCompressed; }
+	void SetCompressed(bool compressed);
+	
+	/** \brief Block contains only zero bytes and data is empty. */
+	inline bool GetZero() const{ return pZero; }
+	void SetZero(bool zero);
+	
+	/** \brief Delta instructions if parent task writes delta. */
+	inline Instructions &GetInstructions(){ return pInstructions; }
+	inline const Instructions &GetInstructions() const{ return pInstructions; }
+	
+	/** \brief Transfer window state when the block has been sent. */
+	inline const derlTransferWindow::SendState &GetSendState() const{ return pSendState; }
+	void SetSendState(const derlTransferWindow::SendState &state);
 	/*@}*/
 };
 
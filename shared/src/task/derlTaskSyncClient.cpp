@@ -22,7 +22,10 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+
 #include "derlTaskSyncClient.h"
+#include "../derlFileBlock.h"
 
 
 // Class derlTaskSyncClient
@@ -32,7 +35,11 @@ derlTaskSyncClient::derlTaskSyncClient() :
 derlBaseTask(Type::syncClient),
 pStatus(Status::pending),
 pTaskFileLayoutServer(std::make_shared<derlTaskFileLayout>()),
-pTaskFileLayoutClient(std::make_shared<derlTaskFileLayout>())
+pTaskFileLayoutClient(std::make_shared<derlTaskFileLayout>()),
+pEarlyFileBlockHashes(false),
+pRollingDelta(false),
+pContentChunkSize(0),
+pPartialResize(false)
 {
 	pTaskFileLayoutClient->SetLayout(std::make_shared<derlFileLayout>());
 }
@@ -56,3 +63,90 @@ void derlTaskSyncClient::SetTaskFileLayoutServer(const derlTaskFileLayout::Ref &
 void derlTaskSyncClient::SetTaskFileLayoutClient(const derlTaskFileLayout::Ref &task){
 	pTaskFileLayoutClient = task;
 }
+
+void derlTaskSyncClient::SetFileLayoutClientBase(const derlFileLayout::Ref &layout){
+	pFileLayoutClientBase = layout;
+}
+
+derlTaskFileBlockHashes::Ref derlTaskSyncClient::AddFileBlockHashesTask(
+const derlFile &fileServer, derlFile &fileClient){
+	if(fileClient.GetHasBlocks()){
+		return nullptr;
+	}
+	
+	const uint64_t blockSize = fileServer.GetBlockSize();
+	
+	if(fileClient.GetSize() != fileServer.GetSize() && pContentChunkSize > 0){
+		if(fileServer.GetSize() <= pContentChunkSize || fileClient.GetSize() < pContentChunkSize){
+			return nullptr;
+		}
+		
+		// client calculates the chunks. blocks are added once the response arrives
+		fileClient.SetBlockSize(pContentChunkSize);
+		fileClient.RemoveAllBlocks();
+		fileClient.SetContentChunks(true);
+		fileClient.SetHasBlocks(true);
+		
+		const derlTaskFileBlockHashes::Ref task(std::make_shared<derlTaskFileBlockHashes>(
+			fileServer.GetPath(), pContentChunkSize));
+		task->SetContentChunks(true);
+		task->SetStatus(derlTaskFileBlockHashes::Status::processing);
+		pTasksFileBlockHashes[fileServer.GetPath()] = task;
+		return task;
+		
+	}else if(fileClient.GetSize() != fileServer.GetSize()){
+		if((!pRollingDelta && !pPartialResize) || blockSize == 0
+		|| fileServer.GetSize() < blockSize || fileClient.GetSize() < blockSize){
+			return nullptr;
+		}
+		
+		// client file is hashed in blocks of the server block size
+		fileClient.SetBlockSize(fileServer.GetBlockSize());
+		fileClient.RemoveAllBlocks();
+		uint64_t offset;
+		for(offset=0; offset<fileClient.GetSize(); offset+=blockSize){
+			fileClient.AddBlock(std::make_shared<derlFileBlock>(offset,
+				std::min(blockSize, fileClient.GetSize() - offset)));
+		}
+		fileClient.SetHasBlocks(true);
+		
+	}else{
+		if(fileClient.GetHash() == fileServer.GetHash()){
+			return nullptr;
+		}
+		
+		fileClient.SetBlockSize(fileServer.GetBlockSize());
+		fileClient.RemoveAllBlocks();
+		derlFileBlock::List::const_iterator iterBlock;
+		for(iterBlock=fileServer.GetBlocksBegin(); iterBlock!=fileServer.GetBlocksEnd(); iterBlock++){
+			const derlFileBlock &blockServer = **iterBlock;
+			fileClient.AddBlock(std::make_shared<derlFileBlock>(
+				blockServer.GetOffset(), blockServer.GetSize()));
+		}
+		fileClient.SetHasBlocks(true);
+	}
+	
+	// weak hashes are only used to find moved blocks in files with changed size
+	const derlTaskFileBlockHashes::Ref task(std::make_shared<derlTaskFileBlockHashes>(
+		fileServer.GetPath(), fileServer.GetBlockSize()));
+	task->SetWeakHashes(pRollingDelta && fileClient.GetSize() != fileServer.GetSize());
+	task->SetStatus(derlTaskFileBlockHashes::Status::processing);
+	pTasksFileBlockHashes[fileServer.GetPath()] = task;
+	return task;
+}
+
+void derlTaskSyncClient::SetEarlyFileBlockHashes(bool early){
+	pEarlyFileBlockHashes = early;
+}
+
+void derlTaskSyncClient::SetRollingDelta(bool rollingDelta){
+	pRollingDelta = rollingDelta;
+}
+
+void derlTaskSyncClient::SetContentChunkSize(uint32_t size){
+	pContentChunkSize = size;
+}
+
+void derlTaskSyncClient::SetPartialResize(bool partialResize){
+	pPartialResize = partialResize;
+}
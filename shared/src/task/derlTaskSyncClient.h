@@ -62,10 +62,17 @@ private:
 	std::atomic<Status> pStatus;
 	std::string pError;
 	derlTaskFileLayout::Ref pTaskFileLayoutServer, pTaskFileLayoutClient;
+	derlFileLayout::Ref pFileLayoutClientBase;
 	
 	derlTaskFileWrite::Map pTasksWriteFile;
+	derlTaskFileWrite::Queue pQueueWriteFile, pQueueWriteFileBundle;
+	derlTaskFileWrite::List pTasksWriteFileActive, pTasksWriteFileBundle;
 	derlTaskFileDelete::Map pTaskDeleteFiles;
 	derlTaskFileBlockHashes::Map pTasksFileBlockHashes;
+	bool pEarlyFileBlockHashes;
+	bool pRollingDelta;
+	uint32_t pContentChunkSize;
+	bool pPartialResize;
 	std::mutex pMutex;
 	
 	
@@ -96,6 +103,14 @@ public:
 	inline const derlTaskFileLayout::Ref &GetTaskFileLayoutClient() const{ return pTaskFileLayoutClient; }
 	void SetTaskFileLayoutClient(const derlTaskFileLayout::Ref &task);
 	
+	/**
+	 * \brief Client file layout of previous synchronization or nullptr.
+	 * 
+	 * Used as base if the client answers with file layout changes.
+	 */
+	inline const derlFileLayout::Ref &GetFileLayoutClientBase() const{ return pFileLayoutClientBase; }
+	void SetFileLayoutClientBase(const derlFileLayout::Ref &layout);
+	
 	/** \brief Delete file tasks. */
 	inline const derlTaskFileDelete::Map &GetTasksDeleteFile() const{ return pTaskDeleteFiles; }
 	inline derlTaskFileDelete::Map &GetTasksDeleteFile(){ return pTaskDeleteFiles; }
@@ -104,10 +119,70 @@ public:
 	inline const derlTaskFileWrite::Map &GetTasksWriteFile() const{ return pTasksWriteFile; }
 	inline derlTaskFileWrite::Map &GetTasksWriteFile(){ return pTasksWriteFile; }
 	
+	/**
+	 * \brief Ready queue of pending write file tasks written using write requests.
+	 * 
+	 * Ordered using the transfer order policy. Files are started from the front.
+	 */
+	inline derlTaskFileWrite::Queue &GetQueueWriteFile(){ return pQueueWriteFile; }
+	
+	/**
+	 * \brief Ready queue of pending write file tasks written using file bundles.
+	 * 
+	 * Ordered using the transfer order policy. Files are bundled from the front.
+	 */
+	inline derlTaskFileWrite::Queue &GetQueueWriteFileBundle(){ return pQueueWriteFileBundle; }
+	
+	/** \brief Started write file tasks written using write requests in transfer order. */
+	inline derlTaskFileWrite::List &GetTasksWriteFileActive(){ return pTasksWriteFileActive; }
+	
+	/** \brief Write file tasks of the file bundle being prepared. */
+	inline derlTaskFileWrite::List &GetTasksWriteFileBundle(){ return pTasksWriteFileBundle; }
+	
 	/** \brief File block hashes tasks. */
 	inline const derlTaskFileBlockHashes::Map &GetTasksFileBlockHashes() const{ return pTasksFileBlockHashes; }
 	inline derlTaskFileBlockHashes::Map &GetTasksFileBlockHashes(){ return pTasksFileBlockHashes; }
 	
+	/**
+	 * \brief Add file block hashes task if client file has to be hashed using server blocks.
+	 * 
+	 * Hashing is required if the client file has the same size as the server file but a
+	 * different hash. Prepares the client file blocks to match the server file blocks.
+	 * If rolling delta or partial resize is enabled hashing is also required for files
+	 * with changed size not smaller than the block size. In this case the client file
+	 * blocks are prepared using the client file size. If content chunks are enabled files
+	 * with changed size request content defined chunks instead. In this case the client
+	 * file blocks are added once the chunks are received. Caller has to lock mutex.
+	 * 
+	 * \returns Added task or nullptr if not required or client file is already prepared.
+	 */
+	derlTaskFileBlockHashes::Ref AddFileBlockHashesTask(const derlFile &fileServer, derlFile &fileClient);
+	
+	/**
+	 * \brief File block hashes are requested while receiving client file layout pages.
+	 * 
+	 * Set once all already received client files have been checked.
+	 */
+	inline bool GetEarlyFileBlockHashes() const{ return pEarlyFileBlockHashes; }
+	void SetEarlyFileBlockHashes(bool early);
+	
+	/** \brief Files with changed size are written using rolling checksum deltas. */
+	inline bool GetRollingDelta() const{ return pRollingDelta; }
+	void SetRollingDelta(bool rollingDelta);
+	
+	/**
+	 * \brief Average content defined chunk size or 0 if disabled.
+	 * 
+	 * If not 0 files with changed size are written using content defined chunks.
+	 * Takes precedence over rolling checksum deltas.
+	 */
+	inline uint32_t GetContentChunkSize() const{ return pContentChunkSize; }
+	void SetContentChunkSize(uint32_t size);
+	
+	/** \brief Files with changed size are written partially resizing the client file. */
+	inline bool GetPartialResize() const{ return pPartialResize; }
+	void SetPartialResize(bool partialResize);
+	
 	/** \brief Mutex. */
 	inline std::mutex &GetMutex(){ return pMutex; }
 	/*@}*/